@@ -302,6 +302,7 @@ int main(int argc, char *argv[])
 
     StopWatch dmd_training_timer, dmd_preprocess_timer, dmd_prediction_timer;
     double* sample = new double[dim];
+    double* snapshot_batch = new double[num_procs * dim];
 
     if (train)
     {
@@ -349,7 +350,6 @@ int main(int argc, char *argv[])
         int overlap_count = 0;
         for (int idx_snap = snap_bound[0]; idx_snap <= snap_bound[1]; ++idx_snap)
         {
-            string snap = snap_list[idx_snap]; // STATE
             double tval = tvec[idx_snap];
 
             if (idx_snap == snap_bound[0])
@@ -357,13 +357,23 @@ int main(int argc, char *argv[])
                 indicator_val.push_back(tval);
             }
 
-            string data_filename = string(data_dir) + "/" + par_dir + "/" + snap + "/" +
-                                   variable + ".csv"; // path to VAR_NAME.csv
-            csv_db.getDoubleArray(data_filename, sample, nelements, idx_state);
-            dmd[curr_window]->takeSample(sample, tval);
+            const int batch_idx = (idx_snap - snap_bound[0]) % num_procs;
+            if (batch_idx == 0)
+            {
+                // Read the next batch of snapshots, one file per process.
+                vector<string> batch_filenames;
+                for (int i = idx_snap; i <= min(idx_snap + num_procs - 1, snap_bound[1]); ++i)
+                {
+                    batch_filenames.push_back(string(data_dir) + "/" + par_dir + "/" +
+                                              snap_list[i] + "/" + variable + ".csv");
+                }
+                csv_db.getDoubleArrays(batch_filenames, snapshot_batch, nelements, idx_state);
+            }
+            double* snapshot = snapshot_batch + batch_idx * dim;
+            dmd[curr_window]->takeSample(snapshot, tval);
             if (overlap_count > 0)
             {
-                dmd[curr_window-1]->takeSample(sample, tval);
+                dmd[curr_window-1]->takeSample(snapshot, tval);
                 overlap_count -= 1;
             }
             if (curr_window+1 < numWindows && idx_snap+1 <= snap_bound[1])
@@ -385,7 +395,7 @@ int main(int argc, char *argv[])
                     {
                         indicator_val.push_back(tval);
                     }
-                    dmd[curr_window]->takeSample(sample, tval);
+                    dmd[curr_window]->takeSample(snapshot, tval);
                 }
             }
         }
@@ -677,6 +687,7 @@ int main(int argc, char *argv[])
     }
 
     delete[] sample;
+    delete[] snapshot_batch;
     for (int window = 0; window < numWindows; ++window)
     {
         delete dmd[window];
@@ -376,6 +376,7 @@ int main(int argc, char *argv[])
     vector<vector<CAROM::DMD*>> dmd;
     vector<CAROM::DMD*> dmd_w;
     double* sample = new double[dim];
+    double* snapshot_batch = new double[num_procs * dim];
 
     if (offline)
     {
@@ -440,16 +441,25 @@ int main(int argc, char *argv[])
             int overlap_count = 0;
             for (int idx_snap = snap_bound[0]; idx_snap <= snap_bound[1]; ++idx_snap)
             {
-                string snap = snap_list[idx_snap]; // STATE
                 double tval = tvec[idx_snap];
-                string data_filename = string(data_dir) + "/" + par_dir + "/" + snap + "/" +
-                                       variable + ".csv"; // path to VAR_NAME.csv
-                csv_db.getDoubleArray(data_filename, sample, nelements, idx_state);
-                dmd[curr_window][idx_dataset]->takeSample(sample,
+                const int batch_idx = (idx_snap - snap_bound[0]) % num_procs;
+                if (batch_idx == 0)
+                {
+                    // Read the next batch of snapshots, one file per process.
+                    vector<string> batch_filenames;
+                    for (int i = idx_snap; i <= min(idx_snap + num_procs - 1, snap_bound[1]); ++i)
+                    {
+                        batch_filenames.push_back(string(data_dir) + "/" + par_dir + "/" +
+                                                  snap_list[i] + "/" + variable + ".csv");
+                    }
+                    csv_db.getDoubleArrays(batch_filenames, snapshot_batch, nelements, idx_state);
+                }
+                double* snapshot = snapshot_batch + batch_idx * dim;
+                dmd[curr_window][idx_dataset]->takeSample(snapshot,
                         tval - offset_indicator * tvec[snap_bound[0]]);
                 if (overlap_count > 0)
                 {
-                    dmd[curr_window-1][idx_dataset]->takeSample(sample,
+                    dmd[curr_window-1][idx_dataset]->takeSample(snapshot,
                             tval - offset_indicator * tvec[snap_bound[0]]);
                     overlap_count -= 1;
                 }
@@ -461,7 +471,7 @@ int main(int argc, char *argv[])
                 {
                     overlap_count = windowOverlapSamples;
                     curr_window += 1;
-                    dmd[curr_window][idx_dataset]->takeSample(sample,
+                    dmd[curr_window][idx_dataset]->takeSample(snapshot,
                             tval - offset_indicator * tvec[snap_bound[0]]);
                 }
             }
@@ -795,6 +805,7 @@ int main(int argc, char *argv[])
     }
 
     delete[] sample;
+    delete[] snapshot_batch;
     delete curr_par;
     for (int window = 0; window < numWindows; ++window)
     {
@@ -11,6 +11,7 @@
 // Description: Implementation of the AdaptiveDMD algorithm.
 
 #include "AdaptiveDMD.h"
+#include "manifold_interp/KDTree.h"
 #include "manifold_interp/VectorInterpolator.h"
 
 #include "linalg/Matrix.h"
@@ -24,7 +25,7 @@ AdaptiveDMD::AdaptiveDMD(int dim, double desired_dt, std::string rbf,
                          double closest_rbf_val,
                          Vector* state_offset) : DMD(dim, state_offset)
 {
-    CAROM_VERIFY(rbf == "G" || rbf == "IQ" || rbf == "IMQ");
+    CAROM_VERIFY(rbf == "G" || rbf == "IQ" || rbf == "IMQ" || rbf == "W");
     CAROM_VERIFY(interp_method == "LS" || interp_method == "IDW"
                  || interp_method == "LP");
     CAROM_VERIFY(closest_rbf_val >= 0.0 && closest_rbf_val <= 1.0);
@@ -37,8 +38,11 @@ AdaptiveDMD::AdaptiveDMD(int dim, double desired_dt, std::string rbf,
 void AdaptiveDMD::train(double energy_fraction, const Matrix* W0,
                         double linearity_tol)
 {
-    const Matrix* f_snapshots = getInterpolatedSnapshots();
-    CAROM_VERIFY(f_snapshots->numColumns() > 1);
+    if (d_interp_snapshots.size() == 0) interpolateSnapshots();
+    const Matrix* f_snapshots = new Matrix(d_interp_snapshots.data(),
+                                           d_interp_snapshots.size() / d_dim,
+                                           d_dim, false, false);
+    CAROM_VERIFY(f_snapshots->numRows() > 1);
     CAROM_VERIFY(energy_fraction > 0 && energy_fraction <= 1);
     d_energy_fraction = energy_fraction;
     constructDMD(f_snapshots, d_rank, d_num_procs, W0, linearity_tol);
@@ -48,9 +52,12 @@ void AdaptiveDMD::train(double energy_fraction, const Matrix* W0,
 
 void AdaptiveDMD::train(int k, const Matrix* W0, double linearity_tol)
 {
-    const Matrix* f_snapshots = getInterpolatedSnapshots();
-    CAROM_VERIFY(f_snapshots->numColumns() > 1);
-    CAROM_VERIFY(k > 0 && k <= f_snapshots->numColumns() - 1);
+    if (d_interp_snapshots.size() == 0) interpolateSnapshots();
+    const Matrix* f_snapshots = new Matrix(d_interp_snapshots.data(),
+                                           d_interp_snapshots.size() / d_dim,
+                                           d_dim, false, false);
+    CAROM_VERIFY(f_snapshots->numRows() > 1);
+    CAROM_VERIFY(k > 0 && k <= f_snapshots->numRows() - 1);
     d_energy_fraction = -1.0;
     d_k = k;
     constructDMD(f_snapshots, d_rank, d_num_procs, W0, linearity_tol);
@@ -61,10 +68,9 @@ void AdaptiveDMD::train(int k, const Matrix* W0, double linearity_tol)
 void AdaptiveDMD::interpolateSnapshots()
 {
     CAROM_VERIFY(d_interp_snapshots.size() == 0);
-    CAROM_VERIFY(d_snapshots.size() == d_sampled_times.size());
     CAROM_VERIFY(d_sampled_times.size() > 1);
 
-    if (d_rank == 0) std::cout << "Number of snapshots is: " << d_snapshots.size()
+    if (d_rank == 0) std::cout << "Number of snapshots is: " << getNumSamples()
                                    << std::endl;
 
     bool automate_dt = false;
@@ -74,8 +80,7 @@ void AdaptiveDMD::interpolateSnapshots()
         std::vector<double> d_sampled_dts;
         for (int i = 1; i < d_sampled_times.size(); i++)
         {
-            d_sampled_dts.push_back(d_sampled_times[i]->item(0) - d_sampled_times[i -
-                                    1]->item(0));
+            d_sampled_dts.push_back(d_sampled_times[i] - d_sampled_times[i - 1]);
         }
 
         auto m = d_sampled_dts.begin() + d_sampled_dts.size() / 2;
@@ -85,10 +90,10 @@ void AdaptiveDMD::interpolateSnapshots()
                                        d_sampled_dts[d_sampled_dts.size() / 2] << std::endl;
         d_dt = d_sampled_dts[d_sampled_dts.size() / 2];
     }
-    CAROM_VERIFY(d_sampled_times.back()->item(0) > d_dt);
+    CAROM_VERIFY(d_sampled_times.back() > d_dt);
 
     // Find the nearest dt that evenly divides the snapshots.
-    int num_time_steps = std::round(d_sampled_times.back()->item(0) / d_dt);
+    int num_time_steps = std::round(d_sampled_times.back() / d_dt);
     if (automate_dt && num_time_steps < d_sampled_times.size())
     {
         num_time_steps = d_sampled_times.size();
@@ -96,7 +101,7 @@ void AdaptiveDMD::interpolateSnapshots()
                                        "There will be less interpolated snapshots than FOM snapshots. dt will be decreased."
                                        << std::endl;
     }
-    double new_dt = d_sampled_times.back()->item(0) / num_time_steps;
+    double new_dt = d_sampled_times.back() / num_time_steps;
     if (new_dt != d_dt)
     {
         d_dt = new_dt;
@@ -104,17 +109,37 @@ void AdaptiveDMD::interpolateSnapshots()
                                        " to ensure a constant dt given the final sampled time." << std::endl;
     }
 
+    // The interpolation routines take the sampled times and snapshots as
+    // vectors, so wrap the stored data without copying it.
+    std::vector<Vector*> sampled_times;
+    std::vector<Vector*> snapshots;
+    for (int i = 0; i < getNumSamples(); i++)
+    {
+        sampled_times.push_back(new Vector(&d_sampled_times[i], 1, false, false));
+        snapshots.push_back(new Vector(&d_snapshots[static_cast<size_t>(i) * d_dim],
+                                       d_dim, true, false));
+    }
+
     // Solve the linear system if required.
     Matrix* f_T = NULL;
-    double epsilon = convertClosestRBFToEpsilon(d_sampled_times, d_rbf,
+    double epsilon = convertClosestRBFToEpsilon(sampled_times, d_rbf,
                      d_closest_rbf_val);
     if (d_interp_method == "LS")
     {
-        f_T = solveLinearSystem(d_sampled_times, d_snapshots, d_interp_method, d_rbf,
+        f_T = solveLinearSystem(sampled_times, snapshots, d_interp_method, d_rbf,
                                 epsilon);
     }
 
+    // With a compactly supported RBF, only the sampled times near each new
+    // time are visited.
+    KDTree* tree = NULL;
+    if (isCompactRBF(d_rbf))
+    {
+        tree = new KDTree(sampled_times);
+    }
+
     // Create interpolated snapshots using d_dt as the desired dt.
+    d_interp_snapshots.reserve(static_cast<size_t>(num_time_steps + 1) * d_dim);
     for (int i = 0; i <= num_time_steps; i++)
     {
         double curr_time = i * d_dt;
@@ -123,19 +148,30 @@ void AdaptiveDMD::interpolateSnapshots()
         CAROM::Vector* point = new Vector(&curr_time, 1, false);
 
         // Obtain distances from database points to new point
-        std::vector<double> rbf = obtainRBFToTrainingPoints(d_sampled_times,
-                                  d_interp_method, d_rbf, epsilon, point);
+        std::vector<double> rbf = obtainRBFToTrainingPoints(sampled_times,
+                                  d_interp_method, d_rbf, epsilon, point, tree);
 
         // Obtain the interpolated snapshot.
         CAROM::Vector* curr_interpolated_snapshot = obtainInterpolatedVector(
-                    d_snapshots, f_T, d_interp_method, rbf);
-        d_interp_snapshots.push_back(curr_interpolated_snapshot);
+                    snapshots, f_T, d_interp_method, rbf);
+        d_interp_snapshots.insert(d_interp_snapshots.end(),
+                                  curr_interpolated_snapshot->getData(),
+                                  curr_interpolated_snapshot->getData() + d_dim);
 
+        delete curr_interpolated_snapshot;
         delete point;
     }
 
+    delete f_T;
+    delete tree;
+    for (int i = 0; i < getNumSamples(); i++)
+    {
+        delete sampled_times[i];
+        delete snapshots[i];
+    }
+
     if (d_rank == 0) std::cout << "Number of interpolated snapshots is: " <<
-                                   d_interp_snapshots.size() << std::endl;
+                                   d_interp_snapshots.size() / d_dim << std::endl;
 }
 
 double AdaptiveDMD::getTrueDt() const
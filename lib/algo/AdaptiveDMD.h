@@ -41,7 +41,8 @@ public:
      *                            the different dt's between the samples.
      * @param[in] rbf             The RBF type ("G" == gaussian,
      *                            "IQ" == inverse quadratic, "IMQ" == inverse
-     *                            multiquadric)
+     *                            multiquadric, "W" == compactly supported
+     *                            Wendland C2)
      * @param[in] interp_method   The interpolation method type ("LS" == linear solve,
      *                            "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
      * @param[in] closest_rbf_val The RBF parameter determines the width of influence.
@@ -113,9 +114,10 @@ private:
     std::string d_interp_method;
 
     /**
-     * @brief std::vector holding the interpolated snapshots.
+     * @brief The interpolated snapshots, stored contiguously one after the
+     *        other.
      */
-    std::vector<Vector*> d_interp_snapshots;
+    std::vector<double> d_interp_snapshots;
 
     /**
      * @brief Internal function to obtain the interpolated snapshots.
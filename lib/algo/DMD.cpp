@@ -20,7 +20,10 @@
 #include "utils/HDFDatabase.h"
 #include "mpi.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
 
 /* Use C++11 built-in shared pointers if available; else fallback to Boost. */
 #if __cplusplus >= 201103L
@@ -31,14 +34,30 @@
 
 /* Use automatically detected Fortran name-mangling scheme */
 #define zgetrf CAROM_FC_GLOBAL(zgetrf, ZGETRF)
-#define zgetri CAROM_FC_GLOBAL(zgetri, ZGETRI)
+#define zgetrs CAROM_FC_GLOBAL(zgetrs, ZGETRS)
+#define dgemv CAROM_FC_GLOBAL(dgemv, DGEMV)
+#define dgemm CAROM_FC_GLOBAL(dgemm, DGEMM)
+#define dgesdd CAROM_FC_GLOBAL(dgesdd, DGESDD)
 
 extern "C" {
     // LU decomposition of a general matrix.
     void zgetrf(int*, int*, double*, int*, int*, int*);
 
-    // Generate inverse of a matrix given its LU decomposition.
-    void zgetri(int*, double*, int*, int*, double*, int*, int*);
+    // Solve a system of linear equations given its LU decomposition.
+    void zgetrs(char*, int*, int*, double*, int*, int*, double*, int*, int*);
+
+    // Matrix-vector product.
+    void dgemv(char*, int*, int*, double*, double*, int*, double*, int*,
+               double*, double*, int*);
+
+    // Matrix-matrix product.
+    void dgemm(char*, char*, int*, int*, int*, double*, double*, int*,
+               double*, int*, double*, double*, int*);
+
+    // Serial SVD of a matrix.
+    void dgesdd(char*, int*, int*, double*, int*,
+                double*, double*, int*, double*, int*,
+                double*, int*, int*, int*);
 }
 
 namespace CAROM {
@@ -129,10 +148,9 @@ void DMD::takeSample(double* u_in, double t)
 {
     CAROM_VERIFY(u_in != 0);
     CAROM_VERIFY(t >= 0.0);
-    Vector* sample = new Vector(u_in, d_dim, true);
 
     double orig_t = t;
-    if (d_snapshots.empty())
+    if (d_sampled_times.empty())
     {
         d_t_offset = t;
         t = 0.0;
@@ -143,35 +161,39 @@ void DMD::takeSample(double* u_in, double t)
     }
 
     // Erase any snapshots taken at the same or later time
-    while (!d_sampled_times.empty() && d_sampled_times.back()->item(0) >= t)
+    while (!d_sampled_times.empty() && d_sampled_times.back() >= t)
     {
         if (d_rank == 0) std::cout << "Removing existing snapshot at time: " <<
-                                       d_t_offset + d_sampled_times.back()->item(0) << std::endl;
-        Vector* last_snapshot = d_snapshots.back();
-        delete last_snapshot;
-        d_snapshots.pop_back();
+                                       d_t_offset + d_sampled_times.back() << std::endl;
+        d_snapshots.resize(d_snapshots.size() - d_dim);
         d_sampled_times.pop_back();
     }
 
-    if (d_snapshots.empty())
+    if (d_sampled_times.empty())
     {
         d_t_offset = orig_t;
         t = 0.0;
     }
     else
     {
-        CAROM_VERIFY(d_sampled_times.back()->item(0) < t);
+        CAROM_VERIFY(d_sampled_times.back() < t);
     }
 
-    d_snapshots.push_back(sample);
-    Vector* sampled_time = new Vector(&t, 1, false);
-    d_sampled_times.push_back(sampled_time);
+    d_snapshots.insert(d_snapshots.end(), u_in, u_in + d_dim);
+    d_sampled_times.push_back(t);
+}
+
+void DMD::reserveSamples(int num_samples)
+{
+    CAROM_VERIFY(num_samples >= 0);
+    d_snapshots.reserve(static_cast<size_t>(num_samples) * d_dim);
+    d_sampled_times.reserve(num_samples);
 }
 
 void DMD::train(double energy_fraction, const Matrix* W0, double linearity_tol)
 {
-    const Matrix* f_snapshots = getSnapshotMatrix();
-    CAROM_VERIFY(f_snapshots->numColumns() > 1);
+    const Matrix* f_snapshots = getSnapshotBlock();
+    CAROM_VERIFY(f_snapshots->numRows() > 1);
     CAROM_VERIFY(energy_fraction > 0 && energy_fraction <= 1);
     d_energy_fraction = energy_fraction;
     constructDMD(f_snapshots, d_rank, d_num_procs, W0, linearity_tol);
@@ -181,9 +203,9 @@ void DMD::train(double energy_fraction, const Matrix* W0, double linearity_tol)
 
 void DMD::train(int k, const Matrix* W0, double linearity_tol)
 {
-    const Matrix* f_snapshots = getSnapshotMatrix();
-    CAROM_VERIFY(f_snapshots->numColumns() > 1);
-    CAROM_VERIFY(k > 0 && k <= f_snapshots->numColumns() - 1);
+    const Matrix* f_snapshots = getSnapshotBlock();
+    CAROM_VERIFY(f_snapshots->numRows() > 1);
+    CAROM_VERIFY(k > 0 && k <= f_snapshots->numRows() - 1);
     d_energy_fraction = -1.0;
     d_k = k;
     constructDMD(f_snapshots, d_rank, d_num_procs, W0, linearity_tol);
@@ -194,42 +216,67 @@ void DMD::train(int k, const Matrix* W0, double linearity_tol)
 std::pair<Matrix*, Matrix*>
 DMD::computeDMDSnapshotPair(const Matrix* snapshots)
 {
-    CAROM_VERIFY(snapshots->numColumns() > 1);
-
-    // TODO: Making two copies of the snapshot matrix has a lot of overhead.
-    //       We need to figure out a way to do submatrix multiplication and to
-    //       reimplement this algorithm using one snapshot matrix.
-    Matrix* f_snapshots_in = new Matrix(snapshots->numRows(),
-                                        snapshots->numColumns() - 1, snapshots->distributed());
-    Matrix* f_snapshots_out = new Matrix(snapshots->numRows(),
-                                         snapshots->numColumns() - 1, snapshots->distributed());
+    CAROM_VERIFY(snapshots->numRows() > 1);
+
+    // snapshots_in = all snapshots except last
+    // snapshots_out = all snapshots except first
+    // Without a state offset these are views of the snapshots.
+    int num_snapshots = snapshots->numRows() - 1;
+    int dim = snapshots->numColumns();
+    if (!d_state_offset)
+    {
+        Matrix* f_snapshots_in = new Matrix(snapshots->getData(), num_snapshots,
+                                            dim, false, false);
+        Matrix* f_snapshots_out = new Matrix(snapshots->getData() + dim,
+                                             num_snapshots, dim, false, false);
+        return std::pair<Matrix*,Matrix*>(f_snapshots_in, f_snapshots_out);
+    }
 
-    // Break up snapshots into snapshots_in and snapshots_out
-    // snapshots_in = all columns of snapshots except last
-    // snapshots_out = all columns of snapshots except first
-    for (int i = 0; i < snapshots->numRows(); i++)
+    Matrix* f_snapshots_in = new Matrix(num_snapshots, dim, false);
+    Matrix* f_snapshots_out = new Matrix(num_snapshots, dim, false);
+    for (int j = 0; j < num_snapshots; j++)
     {
-        for (int j = 0; j < snapshots->numColumns() - 1; j++)
+        for (int i = 0; i < dim; i++)
         {
-            f_snapshots_in->item(i, j) = snapshots->item(i, j);
-            f_snapshots_out->item(i, j) = snapshots->item(i, j + 1);
-            if (d_state_offset)
-            {
-                f_snapshots_in->item(i, j) -= d_state_offset->item(i);
-                f_snapshots_out->item(i, j) -= d_state_offset->item(i);
-            }
+            f_snapshots_in->item(j, i) = snapshots->item(j, i) -
+                                         d_state_offset->item(i);
+            f_snapshots_out->item(j, i) = snapshots->item(j + 1, i) -
+                                          d_state_offset->item(i);
         }
     }
 
     return std::pair<Matrix*,Matrix*>(f_snapshots_in, f_snapshots_out);
 }
 
+Matrix*
+DMD::multSnapshots(const Matrix* snapshots, const Matrix* B) const
+{
+    CAROM_VERIFY(!B->distributed());
+    CAROM_VERIFY(snapshots->numRows() == B->numRows());
+
+    // The row major snapshots are the column major snapshot matrix and the
+    // row major product is its column major transpose B^T * snapshots^T.
+    int num_rows = snapshots->numColumns();
+    int num_cols = B->numColumns();
+    int num_snapshots = snapshots->numRows();
+    Matrix* result = new Matrix(num_rows, num_cols, true);
+    char trans_B = 'N', trans_snapshots = 'T';
+    double one = 1.0, zero = 0.0;
+    // BLAS requires a positive leading dimension, even on a process without
+    // rows.
+    int ld_snapshots = std::max(1, num_rows);
+    dgemm(&trans_B, &trans_snapshots, &num_cols, &num_rows, &num_snapshots,
+          &one, B->getData(), &num_cols, snapshots->getData(), &ld_snapshots,
+          &zero, result->getData(), &num_cols);
+    return result;
+}
+
 void
 DMD::computePhi(struct DMDInternal dmd_internal_obj)
 {
     // Calculate phi
     Matrix* f_snapshots_out_mult_d_basis_right =
-        dmd_internal_obj.snapshots_out->mult(dmd_internal_obj.basis_right);
+        multSnapshots(dmd_internal_obj.snapshots_out, dmd_internal_obj.basis_right);
     Matrix* f_snapshots_out_mult_d_basis_right_mult_d_S_inv =
         f_snapshots_out_mult_d_basis_right->mult(dmd_internal_obj.S_inv);
     d_phi_real = f_snapshots_out_mult_d_basis_right_mult_d_S_inv->mult(
@@ -242,20 +289,68 @@ DMD::computePhi(struct DMDInternal dmd_internal_obj)
 }
 
 void
-DMD::constructDMD(const Matrix* f_snapshots,
-                  int d_rank,
-                  int d_num_procs,
-                  const Matrix* W0,
-                  double linearity_tol)
+DMD::setSVDMethod(SVDMethod svd_method, int randomized_subspace_dim)
 {
-    std::pair<Matrix*, Matrix*> f_snapshot_pair = computeDMDSnapshotPair(
-                f_snapshots);
-    Matrix* f_snapshots_in = f_snapshot_pair.first;
-    Matrix* f_snapshots_out = f_snapshot_pair.second;
+    d_svd_method = svd_method;
+    d_randomized_subspace_dim = randomized_subspace_dim;
+}
+
+void
+DMD::selectNumModes()
+{
+    if (d_energy_fraction != -1.0)
+    {
+        d_k = d_num_singular_vectors;
+        if (d_energy_fraction < 1.0)
+        {
+            double total_energy = 0.0;
+            for (int i = 0; i < d_num_singular_vectors; i++)
+            {
+                total_energy += d_sv[i];
+            }
+            double current_energy = 0.0;
+            for (int i = 0; i < d_num_singular_vectors; i++)
+            {
+                current_energy += d_sv[i];
+                if (current_energy / total_energy >= d_energy_fraction)
+                {
+                    d_k = i + 1;
+                    break;
+                }
+            }
+        }
+    }
+    CAROM_VERIFY(d_k <= d_num_singular_vectors && d_sv[d_k - 1] > 0.0);
+
+    if (d_rank == 0) std::cout << "Using " << d_k << " basis vectors out of " <<
+                                   d_num_singular_vectors << "." << std::endl;
+}
+
+Matrix*
+DMD::computeSVD(const Matrix* f_snapshots_in)
+{
+    d_sv.clear();
+    if (d_svd_method == SVDMethod::randomized)
+    {
+        return computeRandomizedSVD(f_snapshots_in);
+    }
+    else if (d_svd_method == SVDMethod::truncated)
+    {
+        return computeTruncatedSVD(f_snapshots_in);
+    }
+    return computeFullSVD(f_snapshots_in);
+}
+
+Matrix*
+DMD::computeFullSVD(const Matrix* f_snapshots_in)
+{
+    // The snapshots are stored one per row, so the local data of
+    // f_snapshots_in is the column major local block of rows of X.
+    int num_snapshots = f_snapshots_in->numRows();
+    int num_local_rows = f_snapshots_in->numColumns();
 
     int *row_offset = new int[d_num_procs + 1];
-    row_offset[d_num_procs] = f_snapshots_in->numDistributedRows();
-    row_offset[d_rank] = f_snapshots_in->numRows();
+    row_offset[d_rank] = num_local_rows;
 
     CAROM_VERIFY(MPI_Allgather(MPI_IN_PLACE,
                                1,
@@ -264,6 +359,10 @@ DMD::constructDMD(const Matrix* f_snapshots,
                                1,
                                MPI_INT,
                                MPI_COMM_WORLD) == MPI_SUCCESS);
+    row_offset[d_num_procs] = 0;
+    for (int i = 0; i < d_num_procs; i++) {
+        row_offset[d_num_procs] += row_offset[i];
+    }
     for (int i = d_num_procs - 1; i >= 0; i--) {
         row_offset[i] = row_offset[i + 1] - row_offset[i];
     }
@@ -276,16 +375,15 @@ DMD::constructDMD(const Matrix* f_snapshots,
     SLPK_Matrix svd_input;
 
     // Calculate svd of snapshots_in
-    initialize_matrix(&svd_input, f_snapshots_in->numColumns(),
-                      f_snapshots_in->numDistributedRows(),
-                      1, d_num_procs, d_blocksize, d_blocksize);
+    initialize_matrix(&svd_input, row_offset[d_num_procs], num_snapshots,
+                      d_num_procs, 1, d_blocksize, d_blocksize);
 
     for (int rank = 0; rank < d_num_procs; ++rank)
     {
-        scatter_block(&svd_input, 1, row_offset[rank] + 1,
+        scatter_block(&svd_input, row_offset[rank] + 1, 1,
                       f_snapshots_in->getData(),
-                      f_snapshots_in->numColumns(),
-                      row_offset[rank + 1] - row_offset[rank], rank);
+                      row_offset[rank + 1] - row_offset[rank],
+                      num_snapshots, rank);
     }
 
     std::unique_ptr<SVDManager> d_factorizer(new SVDManager);
@@ -297,62 +395,299 @@ DMD::constructDMD(const Matrix* f_snapshots,
     free_matrix_data(&svd_input);
 
     // Compute how many basis vectors we will actually use.
-    d_num_singular_vectors = std::min(f_snapshots_in->numColumns(),
-                                      f_snapshots_in->numDistributedRows());
+    d_num_singular_vectors = std::min(num_snapshots, row_offset[d_num_procs]);
     for (int i = 0; i < d_num_singular_vectors; i++)
     {
         d_sv.push_back(d_factorizer->S[i]);
     }
+    selectNumModes();
 
-    if (d_energy_fraction != -1.0)
+    // Allocate the appropriate matrices and gather their elements.
+    d_basis = new Matrix(num_local_rows, d_k, true);
+    Matrix* d_basis_right = new Matrix(num_snapshots, d_k, false);
+
+    for (int rank = 0; rank < d_num_procs; ++rank) {
+        // gather_transposed_block does the same as gather_block, but transposes
+        // it; here, it is used to go from column-major to row-major order.
+        gather_transposed_block(&d_basis->item(0, 0), d_factorizer->U,
+                                row_offset[static_cast<unsigned>(rank)]+1, 1,
+                                row_offset[static_cast<unsigned>(rank) + 1] -
+                                row_offset[static_cast<unsigned>(rank)],
+                                d_k, rank);
+
+        // V is computed in the transposed order so no reordering necessary.
+        gather_block(&d_basis_right->item(0, 0), d_factorizer->V, 1, 1,
+                     d_k, num_snapshots, rank);
+    }
+    delete [] row_offset;
+
+    free(d_factorizer->S);
+    free_matrix_data(d_factorizer->U);
+    free(d_factorizer->U);
+    free_matrix_data(d_factorizer->V);
+    free(d_factorizer->V);
+    release_context(&svd_input);
+
+    return d_basis_right;
+}
+
+Matrix*
+DMD::computeRandomizedSVD(const Matrix* f_snapshots_in)
+{
+    int num_snapshots = f_snapshots_in->numRows();
+    int num_local_rows = f_snapshots_in->numColumns();
+    int num_rows = num_local_rows;
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, &num_rows, 1, MPI_INT, MPI_SUM,
+                               MPI_COMM_WORLD) == MPI_SUCCESS);
+
+    int subspace_dim = d_randomized_subspace_dim;
+    if (subspace_dim < 1 || subspace_dim > std::min(num_rows, num_snapshots))
     {
-        d_k = d_num_singular_vectors;
-        if (d_energy_fraction < 1.0)
+        subspace_dim = std::min(num_rows, num_snapshots);
+    }
+
+    // Project the snapshots onto a random subspace, X Omega = Q R. The
+    // random matrix is the same on every process.
+    Matrix* rand_mat = new Matrix(num_snapshots, subspace_dim, false, true);
+    Matrix* rand_proj = multSnapshots(f_snapshots_in, rand_mat);
+    Matrix* Q = rand_proj->qr_factorize();
+    delete rand_mat;
+    delete rand_proj;
+
+    // X^T Q, which is Q^T X stored row major.
+    Matrix* svd_input = new Matrix(subspace_dim, num_snapshots, false);
+    char trans = 'T';
+    double one = 1.0, zero = 0.0;
+    int ld_snapshots = std::max(1, num_local_rows);
+    dgemm(&trans, &trans, &num_snapshots, &subspace_dim, &num_local_rows, &one,
+          const_cast<double*>(f_snapshots_in->getData()), &ld_snapshots,
+          Q->getData(), &subspace_dim, &zero, svd_input->getData(),
+          &num_snapshots);
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, svd_input->getData(),
+                               subspace_dim * num_snapshots, MPI_DOUBLE,
+                               MPI_SUM, MPI_COMM_WORLD) == MPI_SUCCESS);
+
+    // The column major data of svd_input is X^T Q = V_Q S U_Q^T, so the
+    // column major left singular vectors are V_Q and the column major
+    // transposed right singular vectors are U_Q stored row major.
+    char jobz = 'S';
+    int info;
+    std::vector<double> S(subspace_dim);
+    std::vector<double> V_Q(static_cast<size_t>(num_snapshots) * subspace_dim);
+    Matrix U_Q(subspace_dim, subspace_dim, false);
+    int lwork = -1;
+    double work_size;
+    std::vector<int> iwork(8 * subspace_dim);
+    dgesdd(&jobz, &num_snapshots, &subspace_dim, svd_input->getData(),
+           &num_snapshots, S.data(), V_Q.data(), &num_snapshots,
+           U_Q.getData(), &subspace_dim, &work_size, &lwork, iwork.data(), &info);
+    CAROM_VERIFY(info == 0);
+    lwork = static_cast<int>(work_size);
+    std::vector<double> work(lwork);
+    dgesdd(&jobz, &num_snapshots, &subspace_dim, svd_input->getData(),
+           &num_snapshots, S.data(), V_Q.data(), &num_snapshots,
+           U_Q.getData(), &subspace_dim, work.data(), &lwork, iwork.data(), &info);
+    CAROM_VERIFY(info == 0);
+    delete svd_input;
+
+    d_num_singular_vectors = subspace_dim;
+    d_sv = S;
+    selectNumModes();
+
+    // Lift the left singular vectors back to the full dimension.
+    Matrix U_Q_k(subspace_dim, d_k, false);
+    Matrix* d_basis_right = new Matrix(num_snapshots, d_k, false);
+    for (int j = 0; j < d_k; j++)
+    {
+        for (int i = 0; i < subspace_dim; i++)
         {
-            double total_energy = 0.0;
-            for (int i = 0; i < d_num_singular_vectors; i++)
-            {
-                total_energy += d_factorizer->S[i];
-            }
-            double current_energy = 0.0;
-            for (int i = 0; i < d_num_singular_vectors; i++)
-            {
-                current_energy += d_factorizer->S[i];
-                if (current_energy / total_energy >= d_energy_fraction)
-                {
-                    d_k = i + 1;
-                    break;
-                }
-            }
+            U_Q_k.item(i, j) = U_Q.item(i, j);
+        }
+        for (int i = 0; i < num_snapshots; i++)
+        {
+            d_basis_right->item(i, j) = V_Q[static_cast<size_t>(j) * num_snapshots + i];
         }
     }
+    d_basis = Q->mult(U_Q_k);
+    delete Q;
 
-    if (d_rank == 0) std::cout << "Using " << d_k << " basis vectors out of " <<
-                                   d_num_singular_vectors << "." << std::endl;
+    return d_basis_right;
+}
 
-    // Allocate the appropriate matrices and gather their elements.
-    d_basis = new Matrix(f_snapshots->numRows(), d_k, f_snapshots->distributed());
+Matrix*
+DMD::computeTruncatedSVD(const Matrix* f_snapshots_in)
+{
+    int num_snapshots = f_snapshots_in->numRows();
+    int num_local_rows = f_snapshots_in->numColumns();
+
+    // G = X^T X = V S^2 V^T.
+    Matrix* G = new Matrix(num_snapshots, num_snapshots, false);
+    char trans_X = 'T', trans = 'N';
+    double one = 1.0, zero = 0.0;
+    int ld_snapshots = std::max(1, num_local_rows);
+    dgemm(&trans_X, &trans, &num_snapshots, &num_snapshots, &num_local_rows, &one,
+          const_cast<double*>(f_snapshots_in->getData()), &ld_snapshots,
+          const_cast<double*>(f_snapshots_in->getData()), &ld_snapshots,
+          &zero, G->getData(), &num_snapshots);
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, G->getData(),
+                               num_snapshots * num_snapshots, MPI_DOUBLE,
+                               MPI_SUM, MPI_COMM_WORLD) == MPI_SUCCESS);
+    int num_total_rows = num_local_rows;
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, &num_total_rows, 1, MPI_INT,
+                               MPI_SUM, MPI_COMM_WORLD) == MPI_SUCCESS);
+    Matrix* d_basis_right = computeSVDFromGramian(f_snapshots_in, G,
+                            num_total_rows);
+    delete G;
+
+    return d_basis_right;
+}
+
+Matrix*
+DMD::computeSVDFromGramian(const Matrix* f_snapshots_in, Matrix* gramian,
+                           int num_total_rows)
+{
+    int num_snapshots = f_snapshots_in->numRows();
+    EigenPair eigenpair = SymmetricRightEigenSolve(gramian);
+
+    // The eigenvalues are in ascending order. The snapshots have at most
+    // min(num_snapshots, num_total_rows) nonzero singular values, and the
+    // eigenvalues at the rounding error of the largest one are dropped,
+    // since U = X V S^{-1} would divide by them.
+    double max_eig = eigenpair.eigs[num_snapshots - 1];
+    double eig_tol = std::numeric_limits<double>::epsilon() * num_snapshots *
+                     max_eig;
+    d_num_singular_vectors = 0;
+    for (int i = 0; i < std::min(num_snapshots, num_total_rows); i++)
+    {
+        double eig = eigenpair.eigs[num_snapshots - 1 - i];
+        if (eig <= eig_tol)
+        {
+            break;
+        }
+        d_sv.push_back(std::sqrt(eig));
+        d_num_singular_vectors++;
+    }
+    CAROM_VERIFY(d_num_singular_vectors > 0);
+    selectNumModes();
+
+    // Only the retained left singular vectors U_k = X V_k S_k^{-1} are formed.
+    Matrix* d_basis_right = new Matrix(num_snapshots, d_k, false);
+    Matrix* d_basis_right_mult_d_S_inv = new Matrix(num_snapshots, d_k, false);
+    for (int i = 0; i < num_snapshots; i++)
+    {
+        for (int j = 0; j < d_k; j++)
+        {
+            d_basis_right->item(i, j) = eigenpair.ev->item(i, num_snapshots - 1 - j);
+            d_basis_right_mult_d_S_inv->item(i, j) = d_basis_right->item(i, j) / d_sv[j];
+        }
+    }
+    d_basis = multSnapshots(f_snapshots_in, d_basis_right_mult_d_S_inv);
+    delete d_basis_right_mult_d_S_inv;
+    delete eigenpair.ev;
+
+    return d_basis_right;
+}
+
+void
+DMD::constructDMDFromGramians(Matrix* f_snapshots_in,
+                              Matrix* f_snapshots_out,
+                              Matrix* gramian,
+                              const Matrix* cross_gramian,
+                              const Matrix* out_gramian,
+                              int num_total_rows)
+{
+    d_sv.clear();
+    Matrix* d_basis_right = computeSVDFromGramian(f_snapshots_in, gramian,
+                            num_total_rows);
     Matrix* d_S_inv = new Matrix(d_k, d_k, false);
-    Matrix* d_basis_right = new Matrix(f_snapshots_in->numColumns(), d_k, false);
+    for (int i = 0; i < d_k; ++i)
+    {
+        d_S_inv->item(i, i) = 1 / d_sv[static_cast<unsigned>(i)];
+    }
 
-    for (int d_rank = 0; d_rank < d_num_procs; ++d_rank) {
-        // V is computed in the transposed order so no reordering necessary.
-        gather_block(&d_basis->item(0, 0), d_factorizer->V,
-                     1, row_offset[static_cast<unsigned>(d_rank)]+1,
-                     d_k, row_offset[static_cast<unsigned>(d_rank) + 1] -
-                     row_offset[static_cast<unsigned>(d_rank)],
-                     d_rank);
+    // With U = X V inv(S), A_tilde = U^T Y V inv(S) = W^T (X^T Y) W where
+    // W = V inv(S).
+    Matrix* W = d_basis_right->mult(d_S_inv);
+    Matrix* cross_gramian_mult_W = cross_gramian->mult(W);
+    d_A_tilde = W->transposeMult(cross_gramian_mult_W);
+    delete cross_gramian_mult_W;
 
-        // gather_transposed_block does the same as gather_block, but transposes
-        // it; here, it is used to go from column-major to row-major order.
-        gather_transposed_block(&d_basis_right->item(0, 0), d_factorizer->U, 1, 1,
-                                f_snapshots_in->numColumns(), d_k, d_rank);
+    // Calculate the right eigenvalues/eigenvectors of A_tilde
+    ComplexEigenPair eigenpair = NonSymmetricRightEigenSolve(d_A_tilde);
+    d_eigs = eigenpair.eigs;
+
+    struct DMDInternal dmd_internal = {f_snapshots_in, f_snapshots_out, d_basis, d_basis_right, d_S_inv, &eigenpair};
+    computePhi(dmd_internal);
+
+    // phi = Y W ev, so phi* x phi and phi* x init follow from Y^T Y and from
+    // Y^T init, the first row of X^T Y.
+    Matrix* W_real = W->mult(eigenpair.ev_real);
+    Matrix* W_imaginary = W->mult(eigenpair.ev_imaginary);
+    Matrix* out_gramian_mult_W_real = out_gramian->mult(W_real);
+    Matrix* out_gramian_mult_W_imaginary = out_gramian->mult(W_imaginary);
+
+    Matrix* d_phi_real_squared = W_real->transposeMult(out_gramian_mult_W_real);
+    Matrix* d_phi_real_squared_2 = W_imaginary->transposeMult(
+                                       out_gramian_mult_W_imaginary);
+    *d_phi_real_squared += *d_phi_real_squared_2;
+
+    Matrix* d_phi_imaginary_squared = W_real->transposeMult(
+                                          out_gramian_mult_W_imaginary);
+    Matrix* d_phi_imaginary_squared_2 = W_imaginary->transposeMult(
+                                            out_gramian_mult_W_real);
+    *d_phi_imaginary_squared -= *d_phi_imaginary_squared_2;
+
+    Vector out_init(cross_gramian->numColumns(), false);
+    for (int i = 0; i < out_init.dim(); i++)
+    {
+        out_init.item(i) = cross_gramian->item(0, i);
     }
+    Vector* rhs_real = W_real->transposeMult(out_init);
+    Vector* rhs_imaginary = W_imaginary->transposeMult(out_init);
+
+    // Calculate pinv(d_phi) * initial_condition.
+    projectInitialCondition(d_phi_real_squared, d_phi_imaginary_squared,
+                            rhs_real, rhs_imaginary);
+
+    d_trained = true;
+
+    delete d_basis_right;
+    delete d_S_inv;
+    delete W;
+    delete W_real;
+    delete W_imaginary;
+    delete out_gramian_mult_W_real;
+    delete out_gramian_mult_W_imaginary;
+    delete d_phi_real_squared;
+    delete d_phi_real_squared_2;
+    delete d_phi_imaginary_squared;
+    delete d_phi_imaginary_squared_2;
+    delete rhs_real;
+    delete rhs_imaginary;
+    delete eigenpair.ev_real;
+    delete eigenpair.ev_imaginary;
+}
+
+void
+DMD::constructDMD(const Matrix* f_snapshots,
+                  int d_rank,
+                  int d_num_procs,
+                  const Matrix* W0,
+                  double linearity_tol)
+{
+    std::pair<Matrix*, Matrix*> f_snapshot_pair = computeDMDSnapshotPair(
+                f_snapshots);
+    Matrix* f_snapshots_in = f_snapshot_pair.first;
+    Matrix* f_snapshots_out = f_snapshot_pair.second;
+
+    Matrix* d_basis_right = computeSVD(f_snapshots_in);
+    int num_local_rows = f_snapshots_in->numColumns();
 
     // Get inverse of singular values by multiplying by reciprocal.
+    Matrix* d_S_inv = new Matrix(d_k, d_k, false);
     for (int i = 0; i < d_k; ++i)
     {
-        d_S_inv->item(i, i) = 1 / d_factorizer->S[static_cast<unsigned>(i)];
+        d_S_inv->item(i, i) = 1 / d_sv[static_cast<unsigned>(i)];
     }
 
     Matrix* Q = NULL;
@@ -365,7 +700,7 @@ DMD::constructDMD(const Matrix* f_snapshots,
         std::vector<int> lin_independent_cols_W;
 
         // Copy W0 and orthogonalize.
-        Matrix* d_basis_init = new Matrix(f_snapshots->numRows(), W0->numColumns(),
+        Matrix* d_basis_init = new Matrix(d_basis->numRows(), W0->numColumns(),
                                           true);
         for (int i = 0; i < d_basis_init->numRows(); i++)
         {
@@ -376,14 +711,14 @@ DMD::constructDMD(const Matrix* f_snapshots,
         }
         d_basis_init->orthogonalize();
 
-        Vector W_col(f_snapshots->numRows(), f_snapshots->distributed());
+        Vector W_col(d_basis->numRows(), true);
         Vector l(W0->numColumns(), true);
-        Vector W0l(f_snapshots->numRows(), f_snapshots->distributed());
+        Vector W0l(d_basis->numRows(), true);
         // Find which columns of d_basis are linearly independent from W0
         for (int j = 0; j < d_basis->numColumns(); j++)
         {
             // l = W0' * u
-            for (int i = 0; i < f_snapshots->numRows(); i++)
+            for (int i = 0; i < d_basis->numRows(); i++)
             {
                 W_col.item(i) = d_basis->item(i, j);
             }
@@ -417,7 +752,7 @@ DMD::constructDMD(const Matrix* f_snapshots,
         delete d_basis_init;
 
         // Add the linearly independent columns of W to W0. Call this new basis W_new.
-        Matrix* d_basis_new = new Matrix(f_snapshots->numRows(),
+        Matrix* d_basis_new = new Matrix(d_basis->numRows(),
                                          W0->numColumns() + lin_independent_cols_W.size(), true);
         for (int i = 0; i < d_basis_new->numRows(); i++)
         {
@@ -447,10 +782,10 @@ DMD::constructDMD(const Matrix* f_snapshots,
     }
 
     // Calculate A_tilde = U_transpose * f_snapshots_out * V * inv(S)
-    Matrix* d_basis_mult_f_snapshots_out = d_basis->transposeMult(f_snapshots_out);
+    Matrix* f_snapshots_out_mult_d_basis_right = multSnapshots(f_snapshots_out,
+            d_basis_right);
     Matrix* d_basis_mult_f_snapshots_out_mult_d_basis_right =
-        d_basis_mult_f_snapshots_out->mult(d_basis_right);
-    d_A_tilde = d_basis_mult_f_snapshots_out_mult_d_basis_right->mult(d_S_inv);
+        d_basis->transposeMult(f_snapshots_out_mult_d_basis_right);
     if (Q == NULL)
     {
         d_A_tilde = d_basis_mult_f_snapshots_out_mult_d_basis_right->mult(d_S_inv);
@@ -472,20 +807,18 @@ DMD::constructDMD(const Matrix* f_snapshots,
     struct DMDInternal dmd_internal = {f_snapshots_in, f_snapshots_out, d_basis, d_basis_right, d_S_inv, &eigenpair};
     computePhi(dmd_internal);
 
-    Vector* init = new Vector(f_snapshots_in->numRows(), true);
-    for (int i = 0; i < init->dim(); i++)
-    {
-        init->item(i) = f_snapshots_in->item(i, 0);
-    }
+    Vector* init = new Vector(f_snapshots_in->getData(), num_local_rows, true);
 
-    // Calculate pinv(d_phi) * initial_condition.
+    // Calculate pinv(d_phi) * initial_condition. The factorization of a
+    // previous training is for another phi.
+    d_phi_squared_factor.clear();
     projectInitialCondition(init);
 
     d_trained = true;
 
     delete d_basis_right;
     delete d_S_inv;
-    delete d_basis_mult_f_snapshots_out;
+    delete f_snapshots_out_mult_d_basis_right;
     delete d_basis_mult_f_snapshots_out_mult_d_basis_right;
     delete f_snapshots_in;
     delete f_snapshots_out;
@@ -497,98 +830,189 @@ DMD::constructDMD(const Matrix* f_snapshots,
 void
 DMD::projectInitialCondition(const Vector* init)
 {
-    Matrix* d_phi_real_squared = d_phi_real->transposeMult(d_phi_real);
-    Matrix* d_phi_real_squared_2 = d_phi_imaginary->transposeMult(d_phi_imaginary);
-    *d_phi_real_squared += *d_phi_real_squared_2;
+    Matrix inits(init->getData(), init->dim(), 1, init->distributed(), false);
+    Matrix* projected_real = NULL;
+    Matrix* projected_imaginary = NULL;
+    projectInitialConditions(inits, projected_real, projected_imaginary);
+
+    delete d_projected_init_real;
+    delete d_projected_init_imaginary;
+    d_projected_init_real = new Vector(projected_real->getData(),
+                                       projected_real->numRows(), false);
+    d_projected_init_imaginary = new Vector(projected_imaginary->getData(),
+                                            projected_imaginary->numRows(), false);
+    d_init_projected = true;
 
-    Matrix* d_phi_imaginary_squared = d_phi_real->transposeMult(d_phi_imaginary);
-    Matrix* d_phi_imaginary_squared_2 = d_phi_imaginary->transposeMult(d_phi_real);
-    *d_phi_imaginary_squared -= *d_phi_imaginary_squared_2;
+    delete projected_real;
+    delete projected_imaginary;
+}
 
-    double* inverse_input = new double[d_phi_real_squared->numRows() *
-                                       d_phi_real_squared->numColumns() * 2];
-    for (int i = 0; i < d_phi_real_squared->numRows(); i++)
+void
+DMD::projectInitialConditions(const Matrix& inits, Matrix*& projected_real,
+                              Matrix*& projected_imaginary)
+{
+    loadLazily(d_phi_real, "phi_real");
+    loadLazily(d_phi_imaginary, "phi_imaginary");
+    CAROM_VERIFY(inits.numRows() == d_phi_real->numRows());
+    CAROM_VERIFY(inits.distributed() == d_phi_real->distributed());
+
+    int num_rows = d_phi_real->numRows();
+    int num_modes = d_phi_real->numColumns();
+    int num_inits = inits.numColumns();
+    int rhs_size = num_modes * num_inits;
+    int gramian_size = num_modes * num_modes;
+    bool factored = !d_phi_squared_factor.empty();
+
+    // Form phi_real^T inits and phi_imaginary^T inits and, unless phi* x phi
+    // is already factored, phi_real^T phi_real, phi_imaginary^T
+    // phi_imaginary and phi_real^T phi_imaginary locally, one after the
+    // other in one buffer, and sum them in a single reduction. The row major
+    // phi is the column major phi^T and the row major products are the
+    // transposes of the column major ones.
+    std::vector<double> products(2 * rhs_size +
+                                 (factored ? 0 : 3 * gramian_size), 0.0);
+    double* rhs_real = products.data();
+    double* rhs_imaginary = rhs_real + rhs_size;
+    if (num_rows > 0 && num_modes > 0 && num_inits > 0)
     {
-        int k = 0;
-        for (int j = 0; j < d_phi_real_squared->numColumns() * 2; j++)
+        char trans_A = 'N', trans_B = 'T';
+        double one = 1.0, zero = 0.0;
+        dgemm(&trans_A, &trans_B, &num_inits, &num_modes, &num_rows, &one,
+              inits.getData(), &num_inits, d_phi_real->getData(), &num_modes,
+              &zero, rhs_real, &num_inits);
+        dgemm(&trans_A, &trans_B, &num_inits, &num_modes, &num_rows, &one,
+              inits.getData(), &num_inits, d_phi_imaginary->getData(),
+              &num_modes, &zero, rhs_imaginary, &num_inits);
+        if (!factored)
         {
-            if (j % 2 == 0)
-            {
-                inverse_input[d_phi_real_squared->numColumns() * 2 * i + j] =
-                    d_phi_real_squared->item(i, k);
-            }
-            else
+            double* gramians = rhs_imaginary + rhs_size;
+            dgemm(&trans_A, &trans_B, &num_modes, &num_modes, &num_rows, &one,
+                  d_phi_real->getData(), &num_modes, d_phi_real->getData(),
+                  &num_modes, &zero, gramians, &num_modes);
+            dgemm(&trans_A, &trans_B, &num_modes, &num_modes, &num_rows, &one,
+                  d_phi_imaginary->getData(), &num_modes,
+                  d_phi_imaginary->getData(), &num_modes, &zero,
+                  gramians + gramian_size, &num_modes);
+            dgemm(&trans_A, &trans_B, &num_modes, &num_modes, &num_rows, &one,
+                  d_phi_imaginary->getData(), &num_modes, d_phi_real->getData(),
+                  &num_modes, &zero, gramians + 2 * gramian_size, &num_modes);
+        }
+    }
+    if (d_phi_real->distributed() && d_num_procs > 1)
+    {
+        CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, products.data(),
+                                   products.size(), MPI_DOUBLE, MPI_SUM,
+                                   MPI_COMM_WORLD) == MPI_SUCCESS);
+    }
+
+    if (!factored)
+    {
+        // phi* x phi = phi_real^T phi_real + phi_imaginary^T phi_imaginary
+        // + i (phi_real^T phi_imaginary - phi_imaginary^T phi_real).
+        double* gramians = rhs_imaginary + rhs_size;
+        Matrix phi_real_squared(gramians, num_modes, num_modes, false, false);
+        Matrix phi_real_imaginary(gramians + 2 * gramian_size, num_modes,
+                                  num_modes, false, false);
+        Matrix phi_imaginary_squared(num_modes, num_modes, false);
+        for (int i = 0; i < num_modes; i++)
+        {
+            for (int j = 0; j < num_modes; j++)
             {
-                inverse_input[d_phi_imaginary_squared->numColumns() * 2 * i + j] =
-                    d_phi_imaginary_squared->item(i, k);
-                k++;
+                phi_real_squared.item(i, j) += gramians[gramian_size +
+                                                        i * num_modes + j];
+                phi_imaginary_squared.item(i, j) = phi_real_imaginary.item(i, j) -
+                                                   phi_real_imaginary.item(j, i);
             }
         }
+        factorPhiSquared(&phi_real_squared, &phi_imaginary_squared);
     }
 
-    // Call lapack routines to do the inversion.
-    // Set up some stuff the lapack routines need.
-    int info;
-    int mtx_size = d_phi_real_squared->numColumns();
-    int lwork = mtx_size*mtx_size*std::max(10,d_num_procs);
-    int* ipiv = new int [mtx_size];
-    double* work = new double [lwork];
+    projected_real = new Matrix(num_modes, num_inits, false);
+    projected_imaginary = new Matrix(num_modes, num_inits, false);
+    solvePhiSquared(rhs_real, rhs_imaginary, num_inits,
+                    projected_real->getData(), projected_imaginary->getData());
+}
 
-    // Now call lapack to do the inversion.
-    zgetrf(&mtx_size, &mtx_size, inverse_input, &mtx_size, ipiv, &info);
-    zgetri(&mtx_size, inverse_input, &mtx_size, ipiv, work, &lwork, &info);
+void
+DMD::projectInitialCondition(const Matrix* d_phi_real_squared,
+                             const Matrix* d_phi_imaginary_squared,
+                             const Vector* rhs_real,
+                             const Vector* rhs_imaginary)
+{
+    factorPhiSquared(d_phi_real_squared, d_phi_imaginary_squared);
 
-    d_phi_real_squared_inverse = d_phi_real_squared;
-    d_phi_imaginary_squared_inverse = d_phi_imaginary_squared;
+    delete d_projected_init_real;
+    delete d_projected_init_imaginary;
+    d_projected_init_real = new Vector(rhs_real->dim(), false);
+    d_projected_init_imaginary = new Vector(rhs_real->dim(), false);
+    solvePhiSquared(rhs_real->getData(), rhs_imaginary->getData(), 1,
+                    d_projected_init_real->getData(),
+                    d_projected_init_imaginary->getData());
 
-    for (int i = 0; i < d_phi_real_squared_inverse->numRows(); i++)
+    d_init_projected = true;
+}
+
+void
+DMD::factorPhiSquared(const Matrix* d_phi_real_squared,
+                      const Matrix* d_phi_imaginary_squared)
+{
+    // Interleave the real and imaginary parts into a column major complex
+    // matrix and factor it once for all the projections.
+    int mtx_size = d_phi_real_squared->numColumns();
+    d_phi_squared_factor.resize(2 * mtx_size * mtx_size);
+    d_phi_squared_pivots.resize(mtx_size);
+    for (int j = 0; j < mtx_size; j++)
     {
-        int k = 0;
-        for (int j = 0; j < d_phi_real_squared_inverse->numColumns() * 2; j++)
+        for (int i = 0; i < mtx_size; i++)
         {
-            if (j % 2 == 0)
-            {
-                d_phi_real_squared_inverse->item(i, k) =
-                    inverse_input[d_phi_real_squared_inverse->numColumns() * 2 * i + j];
-            }
-            else
-            {
-                d_phi_imaginary_squared_inverse->item(i, k) =
-                    inverse_input[d_phi_imaginary_squared_inverse->numColumns() * 2 * i + j];
-                k++;
-            }
+            d_phi_squared_factor[2 * (i + j * mtx_size)] =
+                d_phi_real_squared->item(i, j);
+            d_phi_squared_factor[2 * (i + j * mtx_size) + 1] =
+                d_phi_imaginary_squared->item(i, j);
         }
     }
 
-    Vector* rhs_real = d_phi_real->transposeMult(init);
-    Vector* rhs_imaginary = d_phi_imaginary->transposeMult(init);
-
-    Vector* d_projected_init_real_1 = d_phi_real_squared_inverse->mult(rhs_real);
-    Vector* d_projected_init_real_2 = d_phi_imaginary_squared_inverse->mult(
-                                          rhs_imaginary);
-    d_projected_init_real = d_projected_init_real_1->plus(d_projected_init_real_2);
-
-    Vector* d_projected_init_imaginary_1 = d_phi_real_squared_inverse->mult(
-            rhs_imaginary);
-    Vector* d_projected_init_imaginary_2 = d_phi_imaginary_squared_inverse->mult(
-            rhs_real);
-    d_projected_init_imaginary = d_projected_init_imaginary_2->minus(
-                                     d_projected_init_imaginary_1);
+    int info;
+    zgetrf(&mtx_size, &mtx_size, d_phi_squared_factor.data(), &mtx_size,
+           d_phi_squared_pivots.data(), &info);
+    CAROM_VERIFY(info == 0);
+}
 
-    delete d_phi_real_squared_2;
-    delete d_projected_init_real_1;
-    delete d_projected_init_real_2;
-    delete d_phi_imaginary_squared_2;
-    delete d_projected_init_imaginary_1;
-    delete d_projected_init_imaginary_2;
-    delete rhs_real;
-    delete rhs_imaginary;
+void
+DMD::solvePhiSquared(const double* rhs_real, const double* rhs_imaginary,
+                     int num_rhs, double* projected_real,
+                     double* projected_imaginary)
+{
+    CAROM_VERIFY(!d_phi_squared_factor.empty());
+    int mtx_size = d_phi_squared_pivots.size();
+
+    // phi* x init is phi_real^T init - i phi_imaginary^T init. The k x
+    // num_rhs row major inputs and outputs are transposed to and from the
+    // column major complex right hand sides.
+    std::vector<double> rhs(2 * mtx_size * num_rhs);
+    for (int i = 0; i < mtx_size; i++)
+    {
+        for (int j = 0; j < num_rhs; j++)
+        {
+            rhs[2 * (i + j * mtx_size)] = rhs_real[i * num_rhs + j];
+            rhs[2 * (i + j * mtx_size) + 1] = -rhs_imaginary[i * num_rhs + j];
+        }
+    }
 
-    delete [] inverse_input;
-    delete [] ipiv;
-    delete [] work;
+    char trans = 'N';
+    int info;
+    zgetrs(&trans, &mtx_size, &num_rhs, d_phi_squared_factor.data(), &mtx_size,
+           d_phi_squared_pivots.data(), rhs.data(), &mtx_size, &info);
+    CAROM_VERIFY(info == 0);
 
-    d_init_projected = true;
+    for (int i = 0; i < mtx_size; i++)
+    {
+        for (int j = 0; j < num_rhs; j++)
+        {
+            projected_real[i * num_rhs + j] = rhs[2 * (i + j * mtx_size)];
+            projected_imaginary[i * num_rhs + j] = rhs[2 * (i + j * mtx_size) + 1];
+        }
+    }
 }
 
 Vector*
@@ -598,28 +1022,151 @@ DMD::predict(double t, int power)
     CAROM_VERIFY(d_init_projected);
     CAROM_VERIFY(t >= 0.0);
 
-    t -= d_t_offset;
+    loadLazily(d_phi_real, "phi_real");
+    loadLazily(d_phi_imaginary, "phi_imaginary");
+    loadLazily(d_projected_init_real, "projected_init_real");
+    loadLazily(d_projected_init_imaginary, "projected_init_imaginary");
 
-    std::pair<Matrix*, Matrix*> d_phi_pair = phiMultEigs(t, power);
-    Matrix* d_phi_mult_eigs_real = d_phi_pair.first;
-    Matrix* d_phi_mult_eigs_imaginary = d_phi_pair.second;
+    t -= d_t_offset;
 
-    Vector* d_predicted_state_real_1 = d_phi_mult_eigs_real->mult(
-                                           d_projected_init_real);
-    Vector* d_predicted_state_real_2 = d_phi_mult_eigs_imaginary->mult(
-                                           d_projected_init_imaginary);
-    Vector* d_predicted_state_real = d_predicted_state_real_1->minus(
-                                         d_predicted_state_real_2);
+    // Scale the projected initial condition by the eigenvalue powers, then
+    // take the real part of phi times the scaled coefficients.
+    std::vector<double> coef_real(d_k);
+    std::vector<double> coef_imaginary(d_k);
+    computeModeCoefficients(t, power, coef_real.data(), coef_imaginary.data(),
+                            1);
+
+    Vector* d_predicted_state_real = new Vector(d_phi_real->numRows(),
+            d_phi_real->distributed());
+    int num_rows = d_phi_real->numRows();
+    if (num_rows > 0 && d_k > 0)
+    {
+        // The row major phi is the column major phi^T, hence the transposes.
+        char trans = 'T';
+        int inc = 1;
+        double one = 1.0, minus_one = -1.0, zero = 0.0;
+        dgemv(&trans, &d_k, &num_rows, &one, d_phi_real->getData(), &d_k,
+              coef_real.data(), &inc, &zero,
+              d_predicted_state_real->getData(), &inc);
+        dgemv(&trans, &d_k, &num_rows, &minus_one,
+              d_phi_imaginary->getData(), &d_k, coef_imaginary.data(), &inc,
+              &one, d_predicted_state_real->getData(), &inc);
+    }
     addOffset(d_predicted_state_real, t, power);
 
-    delete d_phi_mult_eigs_real;
-    delete d_phi_mult_eigs_imaginary;
-    delete d_predicted_state_real_1;
-    delete d_predicted_state_real_2;
-
     return d_predicted_state_real;
 }
 
+Matrix*
+DMD::predict(const std::vector<double>& times, int power)
+{
+    CAROM_VERIFY(d_trained);
+    CAROM_VERIFY(d_init_projected);
+
+    loadLazily(d_phi_real, "phi_real");
+    loadLazily(d_phi_imaginary, "phi_imaginary");
+    loadLazily(d_projected_init_real, "projected_init_real");
+    loadLazily(d_projected_init_imaginary, "projected_init_imaginary");
+
+    int num_times = times.size();
+    std::vector<double> shifted_times(times);
+    for (int j = 0; j < num_times; j++)
+    {
+        CAROM_VERIFY(times[j] >= 0.0);
+        shifted_times[j] -= d_t_offset;
+    }
+
+    // Coefficients of the modes at every time, stored as the k x T row
+    // major matrices C_real and C_imaginary.
+    std::vector<double> coef_real(d_k * num_times);
+    std::vector<double> coef_imaginary(d_k * num_times);
+    for (int j = 0; j < num_times; j++)
+    {
+        computeModeCoefficients(shifted_times[j], power, &coef_real[j],
+                                &coef_imaginary[j], num_times);
+    }
+
+    // The states are the real part of the complex product phi * C, i.e.
+    // phi_real * C_real - phi_imaginary * C_imaginary. All matrices are row
+    // major, so compute the transposed products in column major order.
+    int num_rows = d_phi_real->numRows();
+    Matrix* d_predicted_states = new Matrix(num_rows, num_times,
+            d_phi_real->distributed());
+    if (num_rows > 0 && num_times > 0 && d_k > 0)
+    {
+        char trans = 'N';
+        double one = 1.0, minus_one = -1.0, zero = 0.0;
+        dgemm(&trans, &trans, &num_times, &num_rows, &d_k, &one,
+              coef_real.data(), &num_times, d_phi_real->getData(), &d_k,
+              &zero, d_predicted_states->getData(), &num_times);
+        dgemm(&trans, &trans, &num_times, &num_rows, &d_k, &minus_one,
+              coef_imaginary.data(), &num_times, d_phi_imaginary->getData(),
+              &d_k, &one, d_predicted_states->getData(), &num_times);
+    }
+    addOffset(*d_predicted_states, shifted_times, power);
+
+    return d_predicted_states;
+}
+
+Matrix*
+DMD::predict(double t, const Matrix& projected_real,
+             const Matrix& projected_imaginary, int power)
+{
+    CAROM_VERIFY(d_trained);
+    CAROM_VERIFY(t >= 0.0);
+    CAROM_VERIFY(projected_real.numRows() == d_k &&
+                 projected_imaginary.numRows() == d_k);
+    CAROM_VERIFY(projected_real.numColumns() == projected_imaginary.numColumns());
+
+    loadLazily(d_phi_real, "phi_real");
+    loadLazily(d_phi_imaginary, "phi_imaginary");
+
+    t -= d_t_offset;
+
+    // Scale each projected initial condition by the eigenvalue powers. The
+    // coefficients are stored as the k x n row major matrices C_real and
+    // C_imaginary.
+    int num_inits = projected_real.numColumns();
+    std::vector<double> coef_real(d_k * num_inits);
+    std::vector<double> coef_imaginary(d_k * num_inits);
+    for (int i = 0; i < d_k; i++)
+    {
+        std::complex<double> eig_exp = computeEigExp(d_eigs[i], t);
+        for (int k = 0; k < power; ++k)
+        {
+            eig_exp *= d_eigs[i];
+        }
+        for (int j = 0; j < num_inits; j++)
+        {
+            std::complex<double> coef = eig_exp * std::complex<double>(
+                                            projected_real.item(i, j),
+                                            projected_imaginary.item(i, j));
+            coef_real[i * num_inits + j] = std::real(coef);
+            coef_imaginary[i * num_inits + j] = std::imag(coef);
+        }
+    }
+
+    // The states are phi_real * C_real - phi_imaginary * C_imaginary, formed
+    // as in predict at several times.
+    int num_rows = d_phi_real->numRows();
+    Matrix* d_predicted_states = new Matrix(num_rows, num_inits,
+                                            d_phi_real->distributed());
+    if (num_rows > 0 && num_inits > 0 && d_k > 0)
+    {
+        char trans = 'N';
+        double one = 1.0, minus_one = -1.0, zero = 0.0;
+        dgemm(&trans, &trans, &num_inits, &num_rows, &d_k, &one,
+              coef_real.data(), &num_inits, d_phi_real->getData(), &d_k,
+              &zero, d_predicted_states->getData(), &num_inits);
+        dgemm(&trans, &trans, &num_inits, &num_rows, &d_k, &minus_one,
+              coef_imaginary.data(), &num_inits, d_phi_imaginary->getData(),
+              &d_k, &one, d_predicted_states->getData(), &num_inits);
+    }
+    addOffset(*d_predicted_states, std::vector<double>(num_inits, t), power);
+
+    return d_predicted_states;
+}
+
 void
 DMD::addOffset(Vector*& result, double t, int power)
 {
@@ -629,18 +1176,31 @@ DMD::addOffset(Vector*& result, double t, int power)
     }
 }
 
+void
+DMD::addOffset(Matrix& result, const std::vector<double>& times, int power)
+{
+    if (d_state_offset)
+    {
+        for (int i = 0; i < result.numRows(); i++)
+        {
+            for (int j = 0; j < result.numColumns(); j++)
+            {
+                result.item(i, j) += d_state_offset->item(i);
+            }
+        }
+    }
+}
+
 std::complex<double>
 DMD::computeEigExp(std::complex<double> eig, double t)
 {
     return std::pow(eig, t / d_dt);
 }
 
-std::pair<Matrix*, Matrix*>
-DMD::phiMultEigs(double t, int power)
+void
+DMD::computeModeCoefficients(double t, int power, double* coef_real,
+                             double* coef_imaginary, int stride)
 {
-    Matrix* d_eigs_exp_real = new Matrix(d_k, d_k, false);
-    Matrix* d_eigs_exp_imaginary = new Matrix(d_k, d_k, false);
-
     for (int i = 0; i < d_k; i++)
     {
         std::complex<double> eig_exp = computeEigExp(d_eigs[i], t);
@@ -648,24 +1208,12 @@ DMD::phiMultEigs(double t, int power)
         {
             eig_exp *= d_eigs[i];
         }
-        d_eigs_exp_real->item(i, i) = std::real(eig_exp);
-        d_eigs_exp_imaginary->item(i, i) = std::imag(eig_exp);
+        std::complex<double> coef = eig_exp * std::complex<double>(
+                                        d_projected_init_real->item(i),
+                                        d_projected_init_imaginary->item(i));
+        coef_real[i * stride] = std::real(coef);
+        coef_imaginary[i * stride] = std::imag(coef);
     }
-
-    Matrix* d_phi_mult_eigs_real = d_phi_real->mult(d_eigs_exp_real);
-    Matrix* d_phi_mult_eigs_real_2 = d_phi_imaginary->mult(d_eigs_exp_imaginary);
-    *d_phi_mult_eigs_real -= *d_phi_mult_eigs_real_2;
-    Matrix* d_phi_mult_eigs_imaginary = d_phi_real->mult(d_eigs_exp_imaginary);
-    Matrix* d_phi_mult_eigs_imaginary_2 = d_phi_imaginary->mult(d_eigs_exp_real);
-    *d_phi_mult_eigs_imaginary += *d_phi_mult_eigs_imaginary_2;
-
-    delete d_eigs_exp_real;
-    delete d_eigs_exp_imaginary;
-    delete d_phi_mult_eigs_real_2;
-    delete d_phi_mult_eigs_imaginary_2;
-
-    return std::pair<Matrix*,Matrix*>(d_phi_mult_eigs_real,
-                                      d_phi_mult_eigs_imaginary);
 }
 
 double
@@ -680,25 +1228,37 @@ DMD::getSnapshotMatrix()
     return createSnapshotMatrix(d_snapshots);
 }
 
+Matrix*
+DMD::getSnapshotBlock()
+{
+    return new Matrix(d_snapshots.data(), getNumSamples(), d_dim, false, false);
+}
+
 const Matrix*
-DMD::createSnapshotMatrix(std::vector<Vector*> snapshots)
+DMD::createSnapshotMatrix(const std::vector<double>& snapshots)
 {
-    CAROM_VERIFY(snapshots.size() > 0);
-    CAROM_VERIFY(snapshots[0]->dim() > 0);
-    for (int i = 0 ; i < snapshots.size() - 1; i++)
-    {
-        CAROM_VERIFY(snapshots[i]->dim() == snapshots[i + 1]->dim());
-        CAROM_VERIFY(snapshots[i]->distributed() == snapshots[i + 1]->distributed());
-    }
+    CAROM_VERIFY(d_dim > 0);
+    CAROM_VERIFY(snapshots.size() > 0 && snapshots.size() % d_dim == 0);
 
-    Matrix* snapshot_mat = new Matrix(snapshots[0]->dim(), snapshots.size(),
-                                      snapshots[0]->distributed());
+    int num_snapshots = snapshots.size() / d_dim;
+    Matrix* snapshot_mat = new Matrix(d_dim, num_snapshots, true);
 
-    for (int i = 0; i < snapshots[0]->dim(); i++)
+    // Transpose in blocks so that both the reads and writes stay in cache.
+    const int block = 64;
+    for (int jj = 0; jj < num_snapshots; jj += block)
     {
-        for (int j = 0; j < snapshots.size(); j++)
+        int j_end = std::min(jj + block, num_snapshots);
+        for (int ii = 0; ii < d_dim; ii += block)
         {
-            snapshot_mat->item(i, j) = snapshots[j]->item(i);
+            int i_end = std::min(ii + block, d_dim);
+            for (int j = jj; j < j_end; j++)
+            {
+                const double* snapshot = &snapshots[static_cast<size_t>(j) * d_dim];
+                for (int i = ii; i < i_end; i++)
+                {
+                    snapshot_mat->item(i, j) = snapshot[i];
+                }
+            }
         }
     }
 
@@ -710,6 +1270,131 @@ DMD::load(std::string base_file_name)
 {
     CAROM_ASSERT(!base_file_name.empty());
 
+    std::string model_file_name = getModelFileName(base_file_name);
+    if (!Utilities::file_exist(model_file_name))
+    {
+        loadSeparateFiles(base_file_name);
+        MPI_Barrier(MPI_COMM_WORLD);
+        return;
+    }
+
+    HDFDatabase database;
+    database.open(model_file_name, "r");
+
+    database.getDouble("dt", d_dt);
+    database.getDouble("t_offset", d_t_offset);
+    database.getInteger("k", d_k);
+
+    int num_eigs;
+    database.getInteger("num_eigs", num_eigs);
+
+    std::vector<double> eigs_real(num_eigs);
+    std::vector<double> eigs_imag(num_eigs);
+    database.getDoubleArray("eigs_real", eigs_real.data(), num_eigs);
+    database.getDoubleArray("eigs_imag", eigs_imag.data(), num_eigs);
+
+    d_eigs.clear();
+    for (int i = 0; i < num_eigs; i++)
+    {
+        d_eigs.push_back(std::complex<double>(eigs_real[i], eigs_imag[i]));
+    }
+
+    // The state offset is needed by every prediction, so read it now.
+    if (database.exists("state_offset_data"))
+    {
+        d_state_offset = new Vector();
+        d_state_offset->read(database, "state_offset_");
+    }
+    database.close();
+
+    d_model_file_name = model_file_name;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+void
+DMD::load(const char* base_file_name)
+{
+    load(std::string(base_file_name));
+}
+
+void
+DMD::save(std::string base_file_name)
+{
+    CAROM_ASSERT(!base_file_name.empty());
+    CAROM_VERIFY(d_trained);
+
+    // Read any components not in memory yet before the model file may be
+    // overwritten.
+    loadLazily(d_basis, "basis");
+    loadLazily(d_A_tilde, "A_tilde");
+    loadLazily(d_phi_real, "phi_real");
+    loadLazily(d_phi_imaginary, "phi_imaginary");
+    loadLazily(d_projected_init_real, "projected_init_real");
+    loadLazily(d_projected_init_imaginary, "projected_init_imaginary");
+    d_model_file_name.clear();
+
+    HDFDatabase database;
+    database.create(getModelFileName(base_file_name));
+
+    database.putDouble("dt", d_dt);
+    database.putDouble("t_offset", d_t_offset);
+    database.putInteger("k", d_k);
+    database.putInteger("num_eigs", d_eigs.size());
+
+    std::vector<double> eigs_real;
+    std::vector<double> eigs_imag;
+
+    for (int i = 0; i < d_eigs.size(); i++)
+    {
+        eigs_real.push_back(d_eigs[i].real());
+        eigs_imag.push_back(d_eigs[i].imag());
+    }
+
+    database.putDoubleArray("eigs_real", eigs_real.data(), eigs_real.size());
+    database.putDoubleArray("eigs_imag", eigs_imag.data(), eigs_imag.size());
+
+    if (d_basis != NULL)
+    {
+        d_basis->write(database, "basis_");
+    }
+
+    if (d_A_tilde != NULL)
+    {
+        d_A_tilde->write(database, "A_tilde_");
+    }
+
+    d_phi_real->write(database, "phi_real_");
+    d_phi_imaginary->write(database, "phi_imaginary_");
+    d_projected_init_real->write(database, "projected_init_real_");
+    d_projected_init_imaginary->write(database, "projected_init_imaginary_");
+
+    if (d_state_offset != NULL)
+    {
+        d_state_offset->write(database, "state_offset_");
+    }
+    database.close();
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+void
+DMD::save(const char* base_file_name)
+{
+    save(std::string(base_file_name));
+}
+
+std::string
+DMD::getModelFileName(const std::string& base_file_name) const
+{
+    char tmp[100];
+    sprintf(tmp, ".%06d", d_rank);
+    return base_file_name + tmp;
+}
+
+void
+DMD::loadSeparateFiles(const std::string& base_file_name)
+{
     char tmp[100];
     std::string full_file_name = base_file_name;
     HDFDatabase database;
@@ -761,14 +1446,6 @@ DMD::load(std::string base_file_name)
     d_phi_imaginary = new Matrix();
     d_phi_imaginary->read(full_file_name);
 
-    full_file_name = base_file_name + "_phi_real_squared_inverse";
-    d_phi_real_squared_inverse = new Matrix();
-    d_phi_real_squared_inverse->read(full_file_name);
-
-    full_file_name = base_file_name + "_phi_imaginary_squared_inverse";
-    d_phi_imaginary_squared_inverse = new Matrix();
-    d_phi_imaginary_squared_inverse->read(full_file_name);
-
     full_file_name = base_file_name + "_projected_init_real";
     d_projected_init_real = new Vector();
     d_projected_init_real->read(full_file_name);
@@ -783,103 +1460,42 @@ DMD::load(std::string base_file_name)
         d_state_offset = new Vector();
         d_state_offset->read(full_file_name);
     }
-
-    MPI_Barrier(MPI_COMM_WORLD);
 }
 
 void
-DMD::load(const char* base_file_name)
+DMD::loadLazily(Matrix*& mat, const std::string& key)
 {
-    load(std::string(base_file_name));
-}
-
-void
-DMD::save(std::string base_file_name)
-{
-    CAROM_ASSERT(!base_file_name.empty());
-    CAROM_VERIFY(d_trained);
-
-    if (d_rank == 0)
+    if (mat != NULL || d_model_file_name.empty())
     {
-        char tmp[100];
-        std::string full_file_name = base_file_name;
-        HDFDatabase database;
-        database.create(full_file_name);
-
-        sprintf(tmp, "dt");
-        database.putDouble(tmp, d_dt);
-
-        sprintf(tmp, "t_offset");
-        database.putDouble(tmp, d_t_offset);
-
-        sprintf(tmp, "k");
-        database.putInteger(tmp, d_k);
-
-        sprintf(tmp, "num_eigs");
-        database.putInteger(tmp, d_eigs.size());
-
-        std::vector<double> eigs_real;
-        std::vector<double> eigs_imag;
-
-        for (int i = 0; i < d_eigs.size(); i++)
-        {
-            eigs_real.push_back(d_eigs[i].real());
-            eigs_imag.push_back(d_eigs[i].imag());
-        }
-
-        sprintf(tmp, "eigs_real");
-        database.putDoubleArray(tmp, &eigs_real[0], eigs_real.size());
-
-        sprintf(tmp, "eigs_imag");
-        database.putDoubleArray(tmp, &eigs_imag[0], eigs_imag.size());
-        database.close();
+        return;
     }
 
-    std::string full_file_name;
-
-    if (d_basis != NULL)
+    HDFDatabase database;
+    database.open(d_model_file_name, "r");
+    if (database.exists(key + "_data"))
     {
-        full_file_name = base_file_name + "_basis";
-        d_basis->write(full_file_name);
+        mat = new Matrix();
+        mat->read(database, key + "_");
     }
+    database.close();
+}
 
-    if (d_A_tilde != NULL)
+void
+DMD::loadLazily(Vector*& vec, const std::string& key)
+{
+    if (vec != NULL || d_model_file_name.empty())
     {
-        full_file_name = base_file_name + "_A_tilde";
-        d_A_tilde->write(full_file_name);
+        return;
     }
 
-    full_file_name = base_file_name + "_phi_real";
-    d_phi_real->write(full_file_name);
-
-    full_file_name = base_file_name + "_phi_imaginary";
-    d_phi_imaginary->write(full_file_name);
-
-    full_file_name = base_file_name + "_phi_real_squared_inverse";
-    d_phi_real_squared_inverse->write(full_file_name);
-
-    full_file_name = base_file_name + "_phi_imaginary_squared_inverse";
-    d_phi_imaginary_squared_inverse->write(full_file_name);
-
-    full_file_name = base_file_name + "_projected_init_real";
-    d_projected_init_real->write(full_file_name);
-
-    full_file_name = base_file_name + "_projected_init_imaginary";
-    d_projected_init_imaginary->write(full_file_name);
-
-    if (d_state_offset != NULL)
+    HDFDatabase database;
+    database.open(d_model_file_name, "r");
+    if (database.exists(key + "_data"))
     {
-        full_file_name = base_file_name + "_state_offset";
-        d_state_offset->write(full_file_name);
+        vec = new Vector();
+        vec->read(database, key + "_");
     }
-
-    MPI_Barrier(MPI_COMM_WORLD);
-}
-
-void
-DMD::save(const char* base_file_name)
-{
-    save(std::string(base_file_name));
+    database.close();
 }
 
 void
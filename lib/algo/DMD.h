@@ -21,6 +21,7 @@
 #include "ParametricDMD.h"
 #include <vector>
 #include <complex>
+#include <string>
 
 namespace CAROM {
 
@@ -30,6 +31,8 @@ class ComplexEigenPair;
 
 /**
  * Struct DMDInternal is a struct containing the necessary matrices to compute phi.
+ * The snapshots are stored one per row, i.e. snapshots_in and snapshots_out
+ * are the transposes of the snapshot matrices.
  */
 struct DMDInternal
 {
@@ -48,6 +51,19 @@ class DMD
 {
 public:
 
+    /**
+     * @brief The SVD used to factor the snapshots when training.
+     *        full: the full SVD of the snapshots, computed with ScaLAPACK.
+     *        randomized: the SVD of the snapshots projected onto a random
+     *                    subspace, which is cheap when the subspace is small.
+     *        truncated: only the retained left singular vectors are formed,
+     *                   from the eigendecomposition of the Gram matrix of the
+     *                   snapshots. Singular values below the square root of
+     *                   machine precision times the largest one are
+     *                   inaccurate.
+     */
+    enum class SVDMethod {full, randomized, truncated};
+
     /**
      * @brief Constructor. Basic DMD with uniform time step size.
      *
@@ -58,16 +74,26 @@ public:
     DMD(int dim, double dt, Vector* state_offset = NULL);
 
     /**
-     * @brief Constructor. DMD from saved models.
+     * @brief Constructor. DMD from saved models. Only the eigenvalues and
+     *        the scalar parameters of the model are read; the matrices and
+     *        vectors are read on first use.
      *
      * @param[in] base_file_name The base part of the filename of the
      *                           database to load when restarting from a save.
      */
     DMD(std::string base_file_name);
 
+    /**
+     * @brief Destructor.
+     */
+    virtual ~DMD() {}
+
     /**
      * @brief Sample the new state, u_in. Any samples in d_snapshots
      *        taken at the same or later time will be erased.
+     *        The snapshots are appended to one contiguous buffer, so no
+     *        allocation is made per sample once reserveSamples has been
+     *        called.
      *
      * @pre u_in != 0
      * @pre t >= 0.0
@@ -77,6 +103,27 @@ public:
      */
     virtual void takeSample(double* u_in, double t);
 
+    /**
+     * @brief Preallocate the storage for the given number of samples.
+     *
+     * @param[in] num_samples The expected number of samples.
+     */
+    void reserveSamples(int num_samples);
+
+    /**
+     * @brief Sets the SVD used to factor the snapshots when training.
+     *
+     * @param[in] svd_method              The SVD method. See SVDMethod.
+     * @param[in] randomized_subspace_dim The dimension of the random
+     *                                    subspace of the randomized SVD. If
+     *                                    not positive, the full dimension is
+     *                                    used. Only the leading
+     *                                    randomized_subspace_dim singular
+     *                                    values are available when choosing
+     *                                    the modes by energy fraction.
+     */
+    void setSVDMethod(SVDMethod svd_method, int randomized_subspace_dim = -1);
+
     /**
      * @param[in] energy_fraction The energy fraction to keep after doing SVD.
      * @param[in] W0              The initial basis to prepend to W.
@@ -103,6 +150,22 @@ public:
      */
     void projectInitialCondition(const Vector* init);
 
+    /**
+     * @brief Project several initial conditions at once. The factorization
+     *        of phi* x phi is computed on the first projection and reused,
+     *        and the products with phi of all the initial conditions are
+     *        summed across processors in a single reduction.
+     *
+     * @param[in]  inits               The matrix whose column j is the j-th
+     *                                 initial condition, distributed as phi.
+     * @param[out] projected_real      The k x n real part of
+     *                                 pinv(phi) x inits.
+     * @param[out] projected_imaginary The k x n imaginary part of
+     *                                 pinv(phi) x inits.
+     */
+    void projectInitialConditions(const Matrix& inits, Matrix*& projected_real,
+                                  Matrix*& projected_imaginary);
+
     /**
      * @brief Predict state given a time. Uses the projected initial condition of the
      *        training dataset (the first column).
@@ -111,6 +174,36 @@ public:
      */
     Vector* predict(double t, int power = 0);
 
+    /**
+     * @brief Predict the states at several times at once. Uses the projected
+     *        initial condition of the training dataset (the first column).
+     *
+     * @param[in] times The times of the outputted states.
+     * @param[in] power The power of the eigenvalues, as in predict(t, power).
+     *
+     * @return The distributed matrix whose column j is the state at times[j].
+     */
+    Matrix* predict(const std::vector<double>& times, int power = 0);
+
+    /**
+     * @brief Predict the states at a time from several initial conditions
+     *        at once.
+     *
+     * @param[in] t                   The time of the outputted states.
+     * @param[in] projected_real      The real part of the projected initial
+     *                                conditions from
+     *                                projectInitialConditions.
+     * @param[in] projected_imaginary The imaginary part of the projected
+     *                                initial conditions.
+     * @param[in] power               The power of the eigenvalues, as in
+     *                                predict(t, power).
+     *
+     * @return The distributed matrix whose column j is the state at time t
+     *         from the j-th initial condition.
+     */
+    Matrix* predict(double t, const Matrix& projected_real,
+                    const Matrix& projected_imaginary, int power = 0);
+
     /**
      * @brief Get the time offset contained within d_t_offset.
      */
@@ -121,19 +214,28 @@ public:
      *
      * @return The number of samples taken.
      */
-    int getNumSamples() const
+    virtual int getNumSamples() const
     {
-        return d_snapshots.size();
+        return d_sampled_times.size();
     }
 
     /**
-     * @brief Get the snapshot matrix contained within d_snapshots.
+     * @brief Get the snapshot matrix contained within d_snapshots, with one
+     *        snapshot per column.
      */
     const Matrix* getSnapshotMatrix();
 
     /**
      * @brief Load the object state from a file.
      *
+     * The model is read from the single file per processor written by save.
+     * Only the eigenvalues and the scalar parameters are read here; each
+     * matrix or vector is read the first time it is needed, so a predictor
+     * does not read the basis or A_tilde and an interpolator does not read
+     * phi. Since distributed components are read collectively, all
+     * processors must use the loaded object in the same way. Models saved
+     * in the former multi-file layout are read eagerly.
+     *
      * @param[in] base_file_name The base part of the filename to load the
      *                           database from.
      */
@@ -148,7 +250,9 @@ public:
     void load(const char* base_file_name);
 
     /**
-     * @brief Save the object state to a file.
+     * @brief Save the object state to a file. Each processor writes all
+     *        components of the model into the single file
+     *        base_file_name.<processor ID>.
      *
      * @param[in] base_file_name The base part of the filename to save the
      *                           database to.
@@ -169,14 +273,8 @@ public:
     void summary(std::string base_file_name);
 
 protected:
-    friend void getParametricDMD<DMD>(DMD*& parametric_dmd,
-                                      std::vector<Vector*>& parameter_points,
-                                      std::vector<DMD*>& dmds,
-                                      Vector* desired_point,
-                                      std::string rbf,
-                                      std::string interp_method,
-                                      double closest_rbf_val,
-                                      bool reorthogonalize_W);
+    friend class ParametricDMDInterpolator<DMD>;
+    friend class WindowedDMD;
 
     /**
      * @brief Constructor. Variant of DMD with non-uniform time step size.
@@ -219,12 +317,19 @@ protected:
         const DMD& rhs);
 
     /**
-     * @brief Internal function to multiply d_phi with the eigenvalues.
+     * @brief Compute the coefficients of the modes at time t, i.e. the
+     *        projected initial condition scaled by the eigenvalue powers.
+     *        Coefficient i is written to coef_real[i * stride] and
+     *        coef_imaginary[i * stride].
      */
-    std::pair<Matrix*, Matrix*> phiMultEigs(double t, int power = 0);
+    void computeModeCoefficients(double t, int power, double* coef_real,
+                                 double* coef_imaginary, int stride);
 
     /**
      * @brief Construct the DMD object.
+     *
+     * @param[in] f_snapshots The snapshots stored one per row, i.e. the
+     *                        transpose of the snapshot matrix.
      */
     void constructDMD(const Matrix* f_snapshots,
                       int rank,
@@ -233,11 +338,112 @@ protected:
                       double linearity_tol);
 
     /**
-     * @brief Returns a pair of pointers to the minus and plus snapshot matrices
+     * @brief Factor the snapshots with the selected SVD method, set d_sv,
+     *        choose d_k and set d_basis to the leading d_k left singular
+     *        vectors.
+     *
+     * @param[in] f_snapshots_in The snapshots stored one per row.
+     *
+     * @return The leading d_k right singular vectors.
+     */
+    Matrix* computeSVD(const Matrix* f_snapshots_in);
+
+    /**
+     * @brief computeSVD with the full ScaLAPACK SVD.
+     */
+    Matrix* computeFullSVD(const Matrix* f_snapshots_in);
+
+    /**
+     * @brief computeSVD with the randomized SVD.
+     */
+    Matrix* computeRandomizedSVD(const Matrix* f_snapshots_in);
+
+    /**
+     * @brief computeSVD from the Gram matrix of the snapshots.
+     */
+    Matrix* computeTruncatedSVD(const Matrix* f_snapshots_in);
+
+    /**
+     * @brief computeSVD given the Gram matrix of the snapshots, X^T X, and
+     *        the global number of rows. Only the singular values above the
+     *        rounding error of the largest are kept.
+     */
+    Matrix* computeSVDFromGramian(const Matrix* f_snapshots_in,
+                                  Matrix* gramian, int num_total_rows);
+
+    /**
+     * @brief Construct the DMD object from the reduced products of the
+     *        snapshots, so that the only communication is the one that
+     *        formed the products.
+     *
+     * @param[in] f_snapshots_in  The minus snapshots stored one per row.
+     * @param[in] f_snapshots_out The plus snapshots stored one per row.
+     * @param[in] gramian         X^T X.
+     * @param[in] cross_gramian   X^T Y.
+     * @param[in] out_gramian     Y^T Y.
+     * @param[in] num_total_rows  The global number of rows of the snapshots.
+     */
+    void constructDMDFromGramians(Matrix* f_snapshots_in,
+                                  Matrix* f_snapshots_out,
+                                  Matrix* gramian,
+                                  const Matrix* cross_gramian,
+                                  const Matrix* out_gramian,
+                                  int num_total_rows);
+
+    /**
+     * @brief Project the initial condition given the real and imaginary
+     *        parts of phi* x phi and of phi_real^T x init and
+     *        phi_imaginary^T x init. phi* x phi is factored and kept for
+     *        later projections.
+     */
+    void projectInitialCondition(const Matrix* phi_real_squared,
+                                 const Matrix* phi_imaginary_squared,
+                                 const Vector* rhs_real,
+                                 const Vector* rhs_imaginary);
+
+    /**
+     * @brief Compute and keep the LU factorization of phi* x phi given its
+     *        real and imaginary parts.
+     */
+    void factorPhiSquared(const Matrix* phi_real_squared,
+                          const Matrix* phi_imaginary_squared);
+
+    /**
+     * @brief Solve (phi* x phi) x c = phi* x init with the kept
+     *        factorization for num_rhs initial conditions, given
+     *        phi_real^T x inits and phi_imaginary^T x inits. All the
+     *        matrices are k x num_rhs and row major.
+     */
+    void solvePhiSquared(const double* rhs_real, const double* rhs_imaginary,
+                         int num_rhs, double* projected_real,
+                         double* projected_imaginary);
+
+    /**
+     * @brief Choose d_k from d_sv and d_energy_fraction, unless d_k was
+     *        given when training.
+     */
+    void selectNumModes();
+
+    /**
+     * @brief Returns a pair of pointers to the minus and plus snapshot
+     *        matrices. The snapshots are stored one per row, both in the
+     *        input and in the returned matrices.
      */
     virtual std::pair<Matrix*, Matrix*> computeDMDSnapshotPair(
         const Matrix* snapshots);
 
+    /**
+     * @brief Returns the distributed matrix snapshots^T * B, where the
+     *        snapshots are stored one per row and B is not distributed.
+     */
+    Matrix* multSnapshots(const Matrix* snapshots, const Matrix* B) const;
+
+    /**
+     * @brief Returns the snapshots in d_snapshots stored one per row. The
+     *        returned matrix does not own its data.
+     */
+    Matrix* getSnapshotBlock();
+
     /**
      * @brief Compute phi.
      */
@@ -254,9 +460,43 @@ protected:
     virtual void addOffset(Vector*& result, double t = 0.0, int power = 0);
 
     /**
-     * @brief Get the snapshot matrix contained within d_snapshots.
+     * @brief Add the appropriate offset to each column of result, the
+     *        column j being the solution predicted at times[j].
      */
-    const Matrix* createSnapshotMatrix(std::vector<Vector*> snapshots);
+    virtual void addOffset(Matrix& result, const std::vector<double>& times,
+                           int power);
+
+    /**
+     * @brief Get the snapshot matrix, with one snapshot per column, from a
+     *        buffer holding one snapshot after the other.
+     */
+    const Matrix* createSnapshotMatrix(const std::vector<double>& snapshots);
+
+    /**
+     * @brief Returns the name of the file holding this processor's part of
+     *        a model saved with the given base file name.
+     */
+    std::string getModelFileName(const std::string& base_file_name) const;
+
+    /**
+     * @brief Load a model saved in the former layout, with the metadata and
+     *        each matrix and vector in separate files.
+     */
+    void loadSeparateFiles(const std::string& base_file_name);
+
+    /**
+     * @brief If mat has not been read yet from the model file, read it
+     *        from the entries with the given key. mat stays NULL if the
+     *        model file does not contain it.
+     */
+    void loadLazily(Matrix*& mat, const std::string& key);
+
+    /**
+     * @brief If vec has not been read yet from the model file, read it
+     *        from the entries with the given key. vec stays NULL if the
+     *        model file does not contain it.
+     */
+    void loadLazily(Vector*& vec, const std::string& key);
 
     /**
      * @brief The rank of the process this object belongs to.
@@ -284,14 +524,14 @@ protected:
     double d_t_offset;
 
     /**
-     * @brief std::vector holding the snapshots.
+     * @brief The snapshots, stored contiguously one after the other.
      */
-    std::vector<Vector*> d_snapshots;
+    std::vector<double> d_snapshots;
 
     /**
      * @brief The stored times of each sample.
      */
-    std::vector<Vector*> d_sampled_times;
+    std::vector<double> d_sampled_times;
 
     /**
      * @brief State offset in snapshot.
@@ -328,6 +568,16 @@ protected:
      */
     int d_k;
 
+    /**
+     * @brief The SVD used to factor the snapshots when training.
+     */
+    SVDMethod d_svd_method = SVDMethod::full;
+
+    /**
+     * @brief The dimension of the random subspace of the randomized SVD.
+     */
+    int d_randomized_subspace_dim = -1;
+
     /**
      * @brief The left singular vector basis.
      */
@@ -349,14 +599,15 @@ protected:
     Matrix* d_phi_imaginary = NULL;
 
     /**
-     * @brief The real part of d_phi_squared_inverse.
+     * @brief The column major LU factorization of phi* x phi, with the real
+     *        and imaginary parts interleaved, or empty if not computed yet.
      */
-    Matrix* d_phi_real_squared_inverse = NULL;
+    std::vector<double> d_phi_squared_factor;
 
     /**
-     * @brief The imaginary part of d_phi_squared_inverse.
+     * @brief The pivots of d_phi_squared_factor.
      */
-    Matrix* d_phi_imaginary_squared_inverse = NULL;
+    std::vector<int> d_phi_squared_pivots;
 
     /**
      * @brief The real part of the projected initial condition.
@@ -373,6 +624,13 @@ protected:
      */
     std::vector<std::complex<double>> d_eigs;
 
+    /**
+     * @brief The model file from which the matrices and vectors not yet in
+     *        memory are read on first use. Empty if the model is not
+     *        loaded lazily.
+     */
+    std::string d_model_file_name;
+
 };
 
 }
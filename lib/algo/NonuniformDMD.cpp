@@ -13,6 +13,7 @@
 #include "NonuniformDMD.h"
 #include "linalg/Matrix.h"
 #include "utils/Utilities.h"
+#include "utils/HDFDatabase.h"
 
 namespace CAROM {
 
@@ -27,12 +28,7 @@ NonuniformDMD::NonuniformDMD(std::string base_file_name) : DMD(base_file_name)
 {
     CAROM_ASSERT(!base_file_name.empty());
 
-    std::string full_file_name = base_file_name + "_derivative_offset";
-    if (Utilities::file_exist(full_file_name + ".000000"))
-    {
-        d_derivative_offset = new Vector();
-        d_derivative_offset->read(full_file_name);
-    }
+    loadDerivativeOffset(base_file_name);
 }
 
 NonuniformDMD::NonuniformDMD(std::vector<std::complex<double>> eigs,
@@ -49,29 +45,26 @@ NonuniformDMD::NonuniformDMD(std::vector<std::complex<double>> eigs,
 std::pair<Matrix*, Matrix*>
 NonuniformDMD::computeDMDSnapshotPair(const Matrix* snapshots)
 {
-    CAROM_VERIFY(snapshots->numColumns() > 1);
+    CAROM_VERIFY(snapshots->numRows() > 1);
 
-    // TODO: Making two copies of the snapshot matrix has a lot of overhead.
-    //       We need to figure out a way to do submatrix multiplication and to
-    //       reimplement this algorithm using one snapshot matrix.
-    Matrix* f_snapshots_in = new Matrix(snapshots->numRows(),
-                                        snapshots->numColumns() - 1, snapshots->distributed());
-    Matrix* f_snapshots_out = new Matrix(snapshots->numRows(),
-                                         snapshots->numColumns() - 1, snapshots->distributed());
+    int num_snapshots = snapshots->numRows() - 1;
+    int dim = snapshots->numColumns();
+    Matrix* f_snapshots_in = new Matrix(num_snapshots, dim, false);
+    Matrix* f_snapshots_out = new Matrix(num_snapshots, dim, false);
 
     // Break up snapshots into snapshots_in and snapshots_out
-    // snapshots_in = all columns of snapshots except last
-    // snapshots_out = finite difference of all columns of snapshots
-    for (int i = 0; i < snapshots->numRows(); i++)
+    // snapshots_in = all snapshots except last
+    // snapshots_out = finite difference of all snapshots
+    for (int j = 0; j < num_snapshots; j++)
     {
-        for (int j = 0; j < snapshots->numColumns() - 1; j++)
+        double dt_inv = 1.0 / (d_sampled_times[j + 1] - d_sampled_times[j]);
+        for (int i = 0; i < dim; i++)
         {
-            f_snapshots_in->item(i, j) = snapshots->item(i, j);
-            f_snapshots_out->item(i, j) =
-                (snapshots->item(i, j + 1) - snapshots->item(i,j)) /
-                (d_sampled_times[j + 1]->item(0) - d_sampled_times[j]->item(0));
-            if (d_state_offset) f_snapshots_in->item(i, j) -= d_state_offset->item(i);
-            if (d_derivative_offset) f_snapshots_out->item(i, j)
+            f_snapshots_in->item(j, i) = snapshots->item(j, i);
+            f_snapshots_out->item(j, i) =
+                (snapshots->item(j + 1, i) - snapshots->item(j, i)) * dt_inv;
+            if (d_state_offset) f_snapshots_in->item(j, i) -= d_state_offset->item(i);
+            if (d_derivative_offset) f_snapshots_out->item(j, i)
                 -= d_derivative_offset->item(i);
         }
     }
@@ -114,16 +107,35 @@ NonuniformDMD::addOffset(Vector*& result, double t, int power)
     }
 }
 
+void
+NonuniformDMD::addOffset(Matrix& result, const std::vector<double>& times,
+                         int power)
+{
+    CAROM_VERIFY(power == 0 || power == 1);
+    if (power == 0)
+    {
+        DMD::addOffset(result, times, power);
+    }
+    if (d_derivative_offset)
+    {
+        for (int i = 0; i < result.numRows(); i++)
+        {
+            for (int j = 0; j < result.numColumns(); j++)
+            {
+                double scale = power == 0 ? times[j] : 1.0;
+                result.item(i, j) += scale * d_derivative_offset->item(i);
+            }
+        }
+    }
+}
+
 void
 NonuniformDMD::load(std::string base_file_name)
 {
     CAROM_ASSERT(!base_file_name.empty());
 
-    std::string full_file_name = base_file_name + "_derivative_offset";
-    d_derivative_offset = new Vector();
-    d_derivative_offset->read(full_file_name);
-
     DMD::load(base_file_name);
+    loadDerivativeOffset(base_file_name);
 }
 
 void
@@ -132,13 +144,40 @@ NonuniformDMD::save(std::string base_file_name)
     CAROM_ASSERT(!base_file_name.empty());
     CAROM_VERIFY(d_trained);
 
+    DMD::save(base_file_name);
+
     if (d_derivative_offset != NULL)
     {
-        std::string full_file_name = base_file_name + "_derivative_offset";
-        d_derivative_offset->write(full_file_name);
+        HDFDatabase database;
+        database.open(getModelFileName(base_file_name), "wr");
+        d_derivative_offset->write(database, "derivative_offset_");
+        database.close();
     }
+}
 
-    DMD::save(base_file_name);
+void
+NonuniformDMD::loadDerivativeOffset(const std::string& base_file_name)
+{
+    std::string model_file_name = getModelFileName(base_file_name);
+    if (Utilities::file_exist(model_file_name))
+    {
+        HDFDatabase database;
+        database.open(model_file_name, "r");
+        if (database.exists("derivative_offset_data"))
+        {
+            d_derivative_offset = new Vector();
+            d_derivative_offset->read(database, "derivative_offset_");
+        }
+        database.close();
+        return;
+    }
+
+    std::string full_file_name = base_file_name + "_derivative_offset";
+    if (Utilities::file_exist(full_file_name + ".000000"))
+    {
+        d_derivative_offset = new Vector();
+        d_derivative_offset->read(full_file_name);
+    }
 }
 
 }
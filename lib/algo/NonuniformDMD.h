@@ -72,14 +72,7 @@ public:
     void save(std::string base_file_name) override;
 
 protected:
-    friend void getParametricDMD<NonuniformDMD>(NonuniformDMD*& parametric_dmd,
-            std::vector<Vector*>& parameter_points,
-            std::vector<NonuniformDMD*>& dmds,
-            Vector* desired_point,
-            std::string rbf,
-            std::string interp_method,
-            double closest_rbf_val,
-            bool reorthogonalize_W);
+    friend class ParametricDMDInterpolator<NonuniformDMD>;
 
     /**
      * @brief Constructor.
@@ -138,6 +131,18 @@ private:
      */
     void addOffset(Vector*& result, double t, int power);
 
+    /**
+     * @brief Add the appropriate offset to each column of the solutions
+     *        predicted at several times.
+     */
+    void addOffset(Matrix& result, const std::vector<double>& times,
+                   int power);
+
+    /**
+     * @brief Read the derivative offset, if any, of a saved model.
+     */
+    void loadDerivativeOffset(const std::string& base_file_name);
+
     /**
      * @brief Derivative offset in snapshot.
      */
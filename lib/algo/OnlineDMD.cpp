@@ -0,0 +1,215 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Implementation of the OnlineDMD algorithm.
+
+#include "OnlineDMD.h"
+
+#include "linalg/BasisGenerator.h"
+#include "linalg/Matrix.h"
+#include "linalg/Options.h"
+#include "linalg/Vector.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace CAROM {
+
+OnlineDMD::OnlineDMD(int dim, double dt, int max_basis_dimension,
+                     double linearity_tol, Vector* state_offset) :
+    DMD(dim, dt, state_offset),
+    d_num_rows_of_W(0),
+    d_last_sampled_time(0.0)
+{
+    CAROM_VERIFY(max_basis_dimension > 0);
+    CAROM_VERIFY(linearity_tol > 0.0);
+
+    // The rank of the incremental SVD never exceeds max_basis_dimension, so
+    // all samples fall in a single time interval. The right singular vectors
+    // are updated since they carry the time dynamics.
+    Options options(dim, max_basis_dimension + 1, -1, true);
+    options.setMaxBasisDimension(max_basis_dimension);
+    options.setIncrementalSVD(linearity_tol, dt, 1.0, dt);
+    d_basis_generator = new BasisGenerator(options, true);
+}
+
+OnlineDMD::~OnlineDMD()
+{
+    delete d_basis_generator;
+    delete d_init;
+}
+
+void OnlineDMD::takeSample(double* u_in, double t)
+{
+    CAROM_VERIFY(u_in != 0);
+    CAROM_VERIFY(t >= 0.0);
+
+    if (d_sample_rows.empty())
+    {
+        d_t_offset = t;
+    }
+    t -= d_t_offset;
+    CAROM_VERIFY(d_sample_rows.empty() || t > d_last_sampled_time);
+    d_last_sampled_time = t;
+
+    Vector sample(u_in, d_dim, true);
+    if (d_state_offset)
+    {
+        sample -= *d_state_offset;
+    }
+    if (d_init == NULL)
+    {
+        d_init = new Vector(sample);
+    }
+
+    // The incremental SVD rejects a zero sample, which is a zero row of the
+    // right singular vectors. Any other rejection is a failure of the SVD
+    // update.
+    if (sample.norm() == 0.0)
+    {
+        d_sample_rows.push_back(-1);
+    }
+    else
+    {
+        CAROM_VERIFY(d_basis_generator->takeSample(sample.getData(), t, d_dt));
+        d_sample_rows.push_back(d_num_rows_of_W++);
+    }
+}
+
+void OnlineDMD::train(double energy_fraction, const Matrix* W0,
+                      double linearity_tol)
+{
+    CAROM_VERIFY(W0 == NULL);
+    CAROM_VERIFY(getNumSamples() > 1);
+    CAROM_VERIFY(energy_fraction > 0 && energy_fraction <= 1);
+    d_energy_fraction = energy_fraction;
+    constructOnlineDMD();
+}
+
+void OnlineDMD::train(int k, const Matrix* W0, double linearity_tol)
+{
+    CAROM_VERIFY(W0 == NULL);
+    CAROM_VERIFY(getNumSamples() > 1);
+    CAROM_VERIFY(k > 0 && k <= getNumSamples() - 1);
+    d_energy_fraction = -1.0;
+    d_k = k;
+    constructOnlineDMD();
+}
+
+void OnlineDMD::clearModel()
+{
+    delete d_basis;
+    d_basis = NULL;
+    delete d_A_tilde;
+    d_A_tilde = NULL;
+    delete d_phi_real;
+    d_phi_real = NULL;
+    delete d_phi_imaginary;
+    d_phi_imaginary = NULL;
+    d_phi_squared_factor.clear();
+    d_phi_squared_pivots.clear();
+    delete d_projected_init_real;
+    d_projected_init_real = NULL;
+    delete d_projected_init_imaginary;
+    d_projected_init_imaginary = NULL;
+    d_sv.clear();
+    d_trained = false;
+    d_init_projected = false;
+}
+
+void OnlineDMD::constructOnlineDMD()
+{
+    CAROM_VERIFY(d_num_rows_of_W > 0);
+    clearModel();
+
+    const Matrix* U = d_basis_generator->getSpatialBasis();
+    const Vector* S = d_basis_generator->getSingularValues();
+    const Matrix* W = d_basis_generator->getTemporalBasis();
+    int r = S->dim();
+    int m = getNumSamples() - 1;
+
+    // The reduced snapshots X~ = U^T X and Y~ = U^T Y are S times the rows
+    // of W of the first m and the last m samples. Store their transposes.
+    Matrix X_tilde_T(m, r, false);
+    Matrix Y_tilde_T(m, r, false);
+    for (int j = 0; j < m; j++)
+    {
+        int row_in = d_sample_rows[j];
+        int row_out = d_sample_rows[j + 1];
+        for (int i = 0; i < r; i++)
+        {
+            X_tilde_T.item(j, i) = row_in < 0 ? 0.0 : S->item(i) * W->item(row_in, i);
+            Y_tilde_T.item(j, i) = row_out < 0 ? 0.0 : S->item(i) * W->item(row_out, i);
+        }
+    }
+
+    // G = X~ X~^T = Q Lambda Q^T, so the left singular vectors of X are U Q
+    // and its singular values are the square roots of Lambda.
+    Matrix* G = X_tilde_T.transposeMult(X_tilde_T);
+    Matrix* A_xy = Y_tilde_T.transposeMult(X_tilde_T);
+    EigenPair eigenpair_G = SymmetricRightEigenSolve(G);
+
+    // The eigenvalues are in ascending order.
+    d_num_singular_vectors = std::min(r, m);
+    for (int i = 0; i < d_num_singular_vectors; i++)
+    {
+        d_sv.push_back(std::sqrt(std::max(eigenpair_G.eigs[r - 1 - i], 0.0)));
+    }
+    selectNumModes();
+
+    // Q_k holds the leading k eigenvectors of G.
+    Matrix Q_k(r, d_k, false);
+    for (int i = 0; i < r; i++)
+    {
+        for (int j = 0; j < d_k; j++)
+        {
+            Q_k.item(i, j) = eigenpair_G.ev->item(i, r - 1 - j);
+        }
+    }
+    d_basis = U->mult(Q_k);
+
+    // With V_k S_k^{-1} = X^T U Q_k Lambda_k^{-1},
+    // Y V_k S_k^{-1} = U A_xy Q_k Lambda_k^{-1} = U M and
+    // A_tilde = (U Q_k)^T Y V_k S_k^{-1} = Q_k^T M.
+    Matrix* M = A_xy->mult(Q_k);
+    for (int j = 0; j < d_k; j++)
+    {
+        double lambda_inv = 1.0 / (d_sv[j] * d_sv[j]);
+        for (int i = 0; i < r; i++)
+        {
+            M->item(i, j) *= lambda_inv;
+        }
+    }
+    d_A_tilde = Q_k.transposeMult(M);
+
+    // Calculate the right eigenvalues/eigenvectors of A_tilde and the exact
+    // DMD modes phi = Y V_k S_k^{-1} ev = U M ev.
+    ComplexEigenPair eigenpair = NonSymmetricRightEigenSolve(d_A_tilde);
+    d_eigs = eigenpair.eigs;
+
+    Matrix* UM = U->mult(M);
+    d_phi_real = UM->mult(eigenpair.ev_real);
+    d_phi_imaginary = UM->mult(eigenpair.ev_imaginary);
+
+    // Calculate pinv(d_phi) * initial_condition.
+    projectInitialCondition(d_init);
+
+    d_trained = true;
+
+    delete G;
+    delete A_xy;
+    delete eigenpair_G.ev;
+    delete M;
+    delete UM;
+    delete eigenpair.ev_real;
+    delete eigenpair.ev_imaginary;
+}
+
+}
@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Computes the DMD algorithm on a stream of snapshots. The
+//              snapshots are not retained; an incremental SVD of the
+//              snapshots is updated as they arrive and the DMD operator is
+//              formed from it whenever the model is trained.
+
+#ifndef included_OnlineDMD_h
+#define included_OnlineDMD_h
+
+#include "DMD.h"
+#include <vector>
+
+namespace CAROM {
+
+class BasisGenerator;
+class Vector;
+
+/**
+ * Class OnlineDMD implements the DMD algorithm with uniform time step size
+ * on snapshots that are not retained. The incremental SVD of the snapshot
+ * matrix Z = [x_0, ..., x_m] = U S W^T is updated with each sample. Since
+ * X = [x_0, ..., x_{m-1}] and Y = [x_1, ..., x_m] are U S times the leading
+ * and trailing rows of W transposed, the reduced operator and the exact DMD
+ * modes follow from U, S and W alone. The memory is that of the left
+ * singular vectors plus one row of W per snapshot, and train may be called
+ * at any time to refresh the model.
+ */
+class OnlineDMD : public DMD
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] dim                 The full-order state dimension.
+     * @param[in] dt                  The dt between samples.
+     * @param[in] max_basis_dimension The maximum dimension of the incremental
+     *                                SVD basis of the snapshots.
+     * @param[in] linearity_tol       The tolerance below which a snapshot is
+     *                                considered linearly dependent on the
+     *                                basis of the incremental SVD.
+     * @param[in] state_offset        The state offset.
+     */
+    OnlineDMD(int dim, double dt, int max_basis_dimension,
+              double linearity_tol = 1.0e-12, Vector* state_offset = NULL);
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~OnlineDMD();
+
+    /**
+     * @brief Update the incremental SVD with the new state, u_in. Unlike
+     *        DMD, the snapshots are not retained, so they must be taken at
+     *        strictly increasing times.
+     *
+     * @pre u_in != 0
+     * @pre t >= 0.0
+     *
+     * @param[in] u_in The new state.
+     * @param[in] t    The time of the newly sampled state.
+     */
+    void takeSample(double* u_in, double t) override;
+
+    /**
+     * @param[in] energy_fraction The energy fraction to keep after doing SVD.
+     * @param[in] W0              Not supported, must be NULL.
+     * @param[in] linearity_tol   Unused.
+     */
+    void train(double energy_fraction, const Matrix* W0 = NULL,
+               double linearity_tol = 0.0) override;
+
+    /**
+     * @param[in] k               The number of modes (eigenvalues) to keep
+     *                            after doing SVD.
+     * @param[in] W0              Not supported, must be NULL.
+     * @param[in] linearity_tol   Unused.
+     */
+    void train(int k, const Matrix* W0 = NULL,
+               double linearity_tol = 0.0) override;
+
+    /**
+     * @brief Returns the number of samples taken.
+     *
+     * @return The number of samples taken.
+     */
+    int getNumSamples() const override
+    {
+        return d_sample_rows.size();
+    }
+
+private:
+
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    OnlineDMD();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    OnlineDMD(
+        const OnlineDMD& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    OnlineDMD&
+    operator = (
+        const OnlineDMD& rhs);
+
+    /**
+     * @brief Construct the DMD model from the current incremental SVD.
+     */
+    void constructOnlineDMD();
+
+    /**
+     * @brief Delete the model of a previous training.
+     */
+    void clearModel();
+
+    /**
+     * @brief The incremental SVD of the snapshots.
+     */
+    BasisGenerator* d_basis_generator;
+
+    /**
+     * @brief The row of the right singular vectors corresponding to each
+     *        sample, or -1 for a zero sample which the incremental SVD
+     *        does not take.
+     */
+    std::vector<int> d_sample_rows;
+
+    /**
+     * @brief The number of rows of the right singular vectors.
+     */
+    int d_num_rows_of_W;
+
+    /**
+     * @brief The time of the last sample, relative to d_t_offset.
+     */
+    double d_last_sampled_time;
+
+    /**
+     * @brief The first sample, minus the state offset, which is the initial
+     *        condition projected onto the modes.
+     */
+    Vector* d_init = NULL;
+};
+
+}
+
+#endif
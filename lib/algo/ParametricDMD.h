@@ -24,9 +24,223 @@
 #include "mpi.h"
 
 #include <complex>
+#include <string>
+#include <vector>
 
 namespace CAROM {
 
+/**
+ * Class ParametricDMDInterpolator interpolates the DMD models of a set of
+ * parameter points to any number of unsampled parameter points. The bases
+ * and reduced operators are loaded once, and the rotation matrices and the
+ * interpolation coefficients are computed once per reference point and
+ * reused, so each query only evaluates the interpolants and solves the
+ * small eigenvalue problem of the interpolated reduced operator.
+ *
+ * The DMD objects must outlive the interpolator.
+ */
+template <class T>
+class ParametricDMDInterpolator
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] parameter_points  The parameter points.
+     * @param[in] dmds              The DMD objects associated with
+     *                              each parameter point.
+     * @param[in] rbf               The RBF type ("G" == gaussian,
+     *                              "IQ" == inverse quadratic, "IMQ" == inverse
+     *                              multiquadric, "W" == compactly supported
+     *                              Wendland C2)
+     * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
+     *                              "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
+     * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
+     *                              Set the RBF value of the nearest two parameter points to a value between 0.0 to 1.0
+     * @param[in] reorthogonalize_W Whether to reorthogonalize the interpolated W (basis) matrix.
+     */
+    ParametricDMDInterpolator(std::vector<Vector*>& parameter_points,
+                              std::vector<T*>& dmds,
+                              std::string rbf = "G",
+                              std::string interp_method = "LS",
+                              double closest_rbf_val = 0.9,
+                              bool reorthogonalize_W = false) :
+        d_parameter_points(parameter_points),
+        d_dmds(dmds),
+        d_rbf(rbf),
+        d_interp_method(interp_method),
+        d_closest_rbf_val(closest_rbf_val),
+        d_reorthogonalize_W(reorthogonalize_W),
+        d_rotation_matrices(dmds.size()),
+        d_basis_interpolators(dmds.size(), NULL),
+        d_A_tilde_interpolators(dmds.size(), NULL)
+    {
+        CAROM_VERIFY(parameter_points.size() == dmds.size());
+        CAROM_VERIFY(dmds.size() > 1);
+        for (int i = 0; i < dmds.size() - 1; i++)
+        {
+            CAROM_VERIFY(dmds[i]->d_dt == dmds[i + 1]->d_dt);
+            CAROM_VERIFY(dmds[i]->d_k == dmds[i + 1]->d_k);
+        }
+        CAROM_VERIFY(closest_rbf_val >= 0.0 && closest_rbf_val <= 1.0);
+
+        int mpi_init;
+        MPI_Initialized(&mpi_init);
+        if (mpi_init == 0) {
+            MPI_Init(nullptr, nullptr);
+        }
+
+        for (int i = 0; i < dmds.size(); i++)
+        {
+            dmds[i]->loadLazily(dmds[i]->d_basis, "basis");
+            dmds[i]->loadLazily(dmds[i]->d_A_tilde, "A_tilde");
+            d_bases.push_back(dmds[i]->d_basis);
+            d_A_tildes.push_back(dmds[i]->d_A_tilde);
+        }
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~ParametricDMDInterpolator()
+    {
+        for (int i = 0; i < d_rotation_matrices.size(); i++)
+        {
+            delete d_basis_interpolators[i];
+            delete d_A_tilde_interpolators[i];
+            for (int j = 0; j < d_rotation_matrices[i].size(); j++)
+            {
+                delete d_rotation_matrices[i][j];
+            }
+        }
+    }
+
+    /**
+     * @brief Create the parametric DMD at an unsampled parameter point.
+     *        The caller owns the returned DMD.
+     *
+     * @param[in] desired_point The desired point to create a parametric DMD at.
+     */
+    T* interpolate(Vector* desired_point)
+    {
+        int ref_point = getClosestPoint(d_parameter_points, desired_point);
+        if (d_basis_interpolators[ref_point] == NULL)
+        {
+            d_rotation_matrices[ref_point] = obtainRotationMatrices(
+                                                 d_parameter_points, d_bases, ref_point);
+            d_basis_interpolators[ref_point] = new MatrixInterpolator(
+                d_parameter_points, d_rotation_matrices[ref_point], d_bases,
+                ref_point, "B", d_rbf, d_interp_method, d_closest_rbf_val);
+            d_A_tilde_interpolators[ref_point] = new MatrixInterpolator(
+                d_parameter_points, d_rotation_matrices[ref_point], d_A_tildes,
+                ref_point, "R", d_rbf, d_interp_method, d_closest_rbf_val);
+        }
+
+        Matrix* W = d_basis_interpolators[ref_point]->interpolate(desired_point,
+                    d_reorthogonalize_W);
+        Matrix* A_tilde = d_A_tilde_interpolators[ref_point]->interpolate(
+                              desired_point);
+
+        // Calculate the right eigenvalues/eigenvectors of A_tilde
+        ComplexEigenPair eigenpair = NonSymmetricRightEigenSolve(A_tilde);
+        std::vector<std::complex<double>> eigs = eigenpair.eigs;
+
+        // Calculate phi (phi = W * eigenvectors)
+        Matrix* phi_real = W->mult(eigenpair.ev_real);
+        Matrix* phi_imaginary = W->mult(eigenpair.ev_imaginary);
+
+        T* parametric_dmd = new T(eigs, phi_real, phi_imaginary, d_dmds[0]->d_k,
+                                  d_dmds[0]->d_dt, d_dmds[0]->d_t_offset,
+                                  d_dmds[0]->d_state_offset);
+
+        delete W;
+        delete A_tilde;
+        delete eigenpair.ev_real;
+        delete eigenpair.ev_imaginary;
+
+        return parametric_dmd;
+    }
+
+private:
+
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    ParametricDMDInterpolator();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    ParametricDMDInterpolator(
+        const ParametricDMDInterpolator& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    ParametricDMDInterpolator&
+    operator = (
+        const ParametricDMDInterpolator& rhs);
+
+    /**
+     * @brief The parameter points.
+     */
+    std::vector<Vector*> d_parameter_points;
+
+    /**
+     * @brief The DMD objects associated with each parameter point.
+     */
+    std::vector<T*> d_dmds;
+
+    /**
+     * @brief The basis of each DMD object.
+     */
+    std::vector<Matrix*> d_bases;
+
+    /**
+     * @brief The reduced operator of each DMD object.
+     */
+    std::vector<Matrix*> d_A_tildes;
+
+    /**
+     * @brief The RBF type.
+     */
+    std::string d_rbf;
+
+    /**
+     * @brief The interpolation method type.
+     */
+    std::string d_interp_method;
+
+    /**
+     * @brief The RBF value of the nearest two parameter points.
+     */
+    double d_closest_rbf_val;
+
+    /**
+     * @brief Whether to reorthogonalize the interpolated basis.
+     */
+    bool d_reorthogonalize_W;
+
+    /**
+     * @brief The rotation matrices for each reference point, computed on
+     *        the first query closest to it.
+     */
+    std::vector<std::vector<Matrix*> > d_rotation_matrices;
+
+    /**
+     * @brief The basis interpolator for each reference point, or NULL if
+     *        not yet needed.
+     */
+    std::vector<MatrixInterpolator*> d_basis_interpolators;
+
+    /**
+     * @brief The reduced operator interpolator for each reference point, or
+     *        NULL if not yet needed.
+     */
+    std::vector<MatrixInterpolator*> d_A_tilde_interpolators;
+};
+
 /**
  * @brief Constructor.
  *
@@ -36,7 +250,8 @@ namespace CAROM {
  * @param[in] desired_point     The desired point to create a parametric DMD at.
  * @param[in] rbf               The RBF type ("G" == gaussian,
  *                              "IQ" == inverse quadratic, "IMQ" == inverse
- *                              multiquadric)
+ *                              multiquadric, "W" == compactly supported
+ *                              Wendland C2)
  * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
  *                              "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
  * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
@@ -53,61 +268,9 @@ void getParametricDMD(T*& parametric_dmd,
                       double closest_rbf_val = 0.9,
                       bool reorthogonalize_W = false)
 {
-    CAROM_VERIFY(parameter_points.size() == dmds.size());
-    CAROM_VERIFY(dmds.size() > 1);
-    for (int i = 0; i < dmds.size() - 1; i++)
-    {
-        CAROM_VERIFY(dmds[i]->d_dt == dmds[i + 1]->d_dt);
-        CAROM_VERIFY(dmds[i]->d_k == dmds[i + 1]->d_k);
-    }
-    CAROM_VERIFY(closest_rbf_val >= 0.0 && closest_rbf_val <= 1.0);
-
-    int mpi_init, rank;
-    MPI_Initialized(&mpi_init);
-    if (mpi_init == 0) {
-        MPI_Init(nullptr, nullptr);
-    }
-
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-
-    std::vector<Matrix*> bases;
-    std::vector<Matrix*> A_tildes;
-    for (int i = 0; i < dmds.size(); i++)
-    {
-        bases.push_back(dmds[i]->d_basis);
-        A_tildes.push_back(dmds[i]->d_A_tilde);
-    }
-
-    int ref_point = getClosestPoint(parameter_points, desired_point);
-    std::vector<CAROM::Matrix*> rotation_matrices = obtainRotationMatrices(
-                parameter_points,
-                bases, ref_point);
-
-    CAROM::MatrixInterpolator basis_interpolator(parameter_points,
-            rotation_matrices, bases, ref_point, "B", rbf, interp_method, closest_rbf_val);
-    Matrix* W = basis_interpolator.interpolate(desired_point, reorthogonalize_W);
-
-    CAROM::MatrixInterpolator A_tilde_interpolator(parameter_points,
-            rotation_matrices, A_tildes, ref_point, "R", rbf, interp_method,
-            closest_rbf_val);
-    Matrix* A_tilde = A_tilde_interpolator.interpolate(desired_point);
-
-    // Calculate the right eigenvalues/eigenvectors of A_tilde
-    ComplexEigenPair eigenpair = NonSymmetricRightEigenSolve(A_tilde);
-    std::vector<std::complex<double>> eigs = eigenpair.eigs;
-
-    // Calculate phi (phi = W * eigenvectors)
-    Matrix* phi_real = W->mult(eigenpair.ev_real);
-    Matrix* phi_imaginary = W->mult(eigenpair.ev_imaginary);
-
-    parametric_dmd = new T(eigs, phi_real, phi_imaginary, dmds[0]->d_k,
-                           dmds[0]->d_dt, dmds[0]->d_t_offset,
-                           dmds[0]->d_state_offset);
-
-    delete W;
-    delete A_tilde;
-    delete eigenpair.ev_real;
-    delete eigenpair.ev_imaginary;
+    ParametricDMDInterpolator<T> interpolator(parameter_points, dmds, rbf,
+            interp_method, closest_rbf_val, reorthogonalize_W);
+    parametric_dmd = interpolator.interpolate(desired_point);
 }
 
 /**
@@ -119,7 +282,8 @@ void getParametricDMD(T*& parametric_dmd,
  * @param[in] desired_point     The desired point to create a parametric DMD at.
  * @param[in] rbf               The RBF type ("G" == gaussian,
  *                              "IQ" == inverse quadratic, "IMQ" == inverse
- *                              multiquadric)
+ *                              multiquadric, "W" == compactly supported
+ *                              Wendland C2)
  * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
  *                              "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
  * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
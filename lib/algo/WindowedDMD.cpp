@@ -0,0 +1,217 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Implementation of the WindowedDMD algorithm.
+
+#include "WindowedDMD.h"
+#include "DMD.h"
+
+#include "linalg/Matrix.h"
+#include "linalg/Vector.h"
+#include "mpi.h"
+
+#include <algorithm>
+#include <utility>
+
+/* Use automatically detected Fortran name-mangling scheme */
+#define dgemm CAROM_FC_GLOBAL(dgemm, DGEMM)
+
+extern "C" {
+    // Matrix-matrix product.
+    void dgemm(char*, char*, int*, int*, int*, double*, double*, int*,
+               double*, int*, double*, double*, int*);
+}
+
+namespace CAROM {
+
+WindowedDMD::WindowedDMD(int dim, double dt, int window_num_samples,
+                         int window_overlap_samples, Vector* state_offset) :
+    d_dim(dim),
+    d_dt(dt),
+    d_window_num_samples(window_num_samples),
+    d_window_overlap_samples(window_overlap_samples),
+    d_state_offset(state_offset),
+    d_num_samples(0)
+{
+    CAROM_VERIFY(dim > 0);
+    CAROM_VERIFY(dt > 0.0);
+    CAROM_VERIFY(window_num_samples > 0);
+    CAROM_VERIFY(window_overlap_samples >= 0 &&
+                 window_overlap_samples < window_num_samples);
+}
+
+WindowedDMD::~WindowedDMD()
+{
+    for (size_t i = 0; i < d_windows.size(); i++)
+    {
+        delete d_windows[i];
+    }
+}
+
+void
+WindowedDMD::takeSample(double* u_in, double t)
+{
+    CAROM_VERIFY(u_in != 0);
+    CAROM_VERIFY(t >= 0.0);
+    CAROM_VERIFY(d_window_start_times.empty() ||
+                 t > d_window_start_times.back());
+
+    // The first sample of a window is the last sample of the previous
+    // window, which also takes the overlapping samples after it.
+    int window = d_num_samples / d_window_num_samples;
+    int window_sample = d_num_samples % d_window_num_samples;
+    if (window > 0 && window_sample <= d_window_overlap_samples)
+    {
+        d_windows[window - 1]->takeSample(u_in, t);
+    }
+    if (window_sample == 0)
+    {
+        d_windows.push_back(new DMD(d_dim, d_dt, d_state_offset));
+        d_window_start_times.push_back(t);
+    }
+    d_windows[window]->takeSample(u_in, t);
+    d_num_samples++;
+}
+
+void
+WindowedDMD::train(double energy_fraction)
+{
+    CAROM_VERIFY(energy_fraction > 0 && energy_fraction <= 1);
+    constructWindows(energy_fraction, -1);
+}
+
+void
+WindowedDMD::train(int k)
+{
+    CAROM_VERIFY(k > 0);
+    constructWindows(-1.0, k);
+}
+
+int
+WindowedDMD::getWindowIndex(double t) const
+{
+    CAROM_VERIFY(!d_windows.empty());
+
+    // A last window holding only its first sample is not trained; that
+    // sample ends the previous window.
+    int num_windows = d_windows.size();
+    if (num_windows > 1 && d_windows.back()->getNumSamples() < 2)
+    {
+        num_windows--;
+    }
+
+    int window = std::upper_bound(d_window_start_times.begin(),
+                                  d_window_start_times.begin() + num_windows, t) -
+                 d_window_start_times.begin() - 1;
+    return std::max(window, 0);
+}
+
+DMD*
+WindowedDMD::getWindow(int window) const
+{
+    CAROM_VERIFY(0 <= window &&
+                 window < static_cast<int>(d_windows.size()));
+    return d_windows[window];
+}
+
+Vector*
+WindowedDMD::predict(double t) const
+{
+    return d_windows[getWindowIndex(t)]->predict(t);
+}
+
+void
+WindowedDMD::constructWindows(double energy_fraction, int k)
+{
+    int num_windows = d_windows.size();
+    if (num_windows > 1 && d_windows.back()->getNumSamples() < 2)
+    {
+        num_windows--;
+    }
+    CAROM_VERIFY(num_windows > 0 && d_windows[0]->getNumSamples() > 1);
+
+    // Form X^T X, X^T Y and Y^T Y of every window locally, one after the
+    // other in one buffer.
+    std::vector<Matrix*> f_snapshots(num_windows);
+    std::vector<std::pair<Matrix*, Matrix*> > f_snapshot_pairs(num_windows);
+    std::vector<int> gramian_offsets(num_windows + 1, 0);
+    for (int w = 0; w < num_windows; w++)
+    {
+        f_snapshots[w] = d_windows[w]->getSnapshotBlock();
+        f_snapshot_pairs[w] = d_windows[w]->computeDMDSnapshotPair(f_snapshots[w]);
+        int num_snapshots = f_snapshot_pairs[w].first->numRows();
+        gramian_offsets[w + 1] = gramian_offsets[w] +
+                                 3 * num_snapshots * num_snapshots;
+    }
+
+    // The local number of rows is summed with the products, after them.
+    std::vector<double> gramians(gramian_offsets[num_windows] + 1);
+    gramians[gramian_offsets[num_windows]] = d_dim;
+    char trans_A = 'T', trans_B = 'N';
+    double one = 1.0, zero = 0.0;
+    for (int w = 0; w < num_windows; w++)
+    {
+        double* X = f_snapshot_pairs[w].first->getData();
+        double* Y = f_snapshot_pairs[w].second->getData();
+        int num_snapshots = f_snapshot_pairs[w].first->numRows();
+        int num_local_rows = f_snapshot_pairs[w].first->numColumns();
+        int ld = std::max(1, num_local_rows);
+        int size = num_snapshots * num_snapshots;
+        double* gramian = &gramians[gramian_offsets[w]];
+
+        // The column major product of A and B is the row major product of
+        // B and A, so the cross product is formed as Y^T X. BLAS requires a
+        // positive leading dimension, even on a process without rows.
+        dgemm(&trans_A, &trans_B, &num_snapshots, &num_snapshots,
+              &num_local_rows, &one, X, &ld, X, &ld,
+              &zero, gramian, &num_snapshots);
+        dgemm(&trans_A, &trans_B, &num_snapshots, &num_snapshots,
+              &num_local_rows, &one, Y, &ld, X, &ld,
+              &zero, gramian + size, &num_snapshots);
+        dgemm(&trans_A, &trans_B, &num_snapshots, &num_snapshots,
+              &num_local_rows, &one, Y, &ld, Y, &ld,
+              &zero, gramian + 2 * size, &num_snapshots);
+    }
+
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, gramians.data(),
+                               gramian_offsets[num_windows] + 1, MPI_DOUBLE,
+                               MPI_SUM, MPI_COMM_WORLD) == MPI_SUCCESS);
+    int num_total_rows = static_cast<int>(gramians[gramian_offsets[num_windows]]);
+
+    // The rest of the training of each window needs no communication.
+    for (int w = 0; w < num_windows; w++)
+    {
+        DMD* dmd = d_windows[w];
+        int num_snapshots = f_snapshot_pairs[w].first->numRows();
+        int size = num_snapshots * num_snapshots;
+        double* gramian_data = &gramians[gramian_offsets[w]];
+        Matrix gramian(gramian_data, num_snapshots, num_snapshots, false, false);
+        Matrix cross_gramian(gramian_data + size, num_snapshots, num_snapshots,
+                             false, false);
+        Matrix out_gramian(gramian_data + 2 * size, num_snapshots, num_snapshots,
+                           false, false);
+
+        dmd->d_energy_fraction = energy_fraction;
+        if (k != -1)
+        {
+            dmd->d_k = std::min(k, std::min(num_snapshots, num_total_rows));
+        }
+        dmd->constructDMDFromGramians(f_snapshot_pairs[w].first,
+                                      f_snapshot_pairs[w].second,
+                                      &gramian, &cross_gramian, &out_gramian,
+                                      num_total_rows);
+
+        delete f_snapshot_pairs[w].first;
+        delete f_snapshot_pairs[w].second;
+        delete f_snapshots[w];
+    }
+}
+
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Computes the DMD algorithm on consecutive time windows of the
+//              snapshots. The windows are independent, so the reductions of
+//              all the windows are done together when training and a model
+//              costs one collective regardless of the number of windows.
+
+#ifndef included_WindowedDMD_h
+#define included_WindowedDMD_h
+
+#include <cstddef>
+#include <vector>
+
+namespace CAROM {
+
+class DMD;
+class Vector;
+
+/**
+ * Class WindowedDMD splits a stream of snapshots into consecutive time
+ * windows and trains one DMD model with uniform time step size per window.
+ * A window holds window_num_samples + 1 samples; its last sample is the
+ * first sample of the next window, and the next window_overlap_samples
+ * samples are also given to it. Training forms the products X^T X, X^T Y
+ * and Y^T Y of every window locally and sums them in a single reduction;
+ * everything else is either local to the process or small and dense.
+ */
+class WindowedDMD
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] dim                    The full-order state dimension.
+     * @param[in] dt                     The dt between samples.
+     * @param[in] window_num_samples     The number of samples between the
+     *                                   start of two consecutive windows.
+     * @param[in] window_overlap_samples The number of samples past its end
+     *                                   that are also given to a window.
+     * @param[in] state_offset           The state offset of every window.
+     */
+    WindowedDMD(int dim, double dt, int window_num_samples,
+                int window_overlap_samples = 0, Vector* state_offset = NULL);
+
+    /**
+     * @brief Destructor.
+     */
+    ~WindowedDMD();
+
+    /**
+     * @brief Sample the new state, u_in, in the window of the current time
+     *        and, near a window boundary, in the previous window. The
+     *        samples must be taken at increasing times.
+     *
+     * @pre u_in != 0
+     * @pre t >= 0.0
+     *
+     * @param[in] u_in The new state.
+     * @param[in] t    The time of the newly sampled state.
+     */
+    void takeSample(double* u_in, double t);
+
+    /**
+     * @brief Train the DMD model of every window.
+     *
+     * @param[in] energy_fraction The energy fraction to keep after doing SVD.
+     */
+    void train(double energy_fraction);
+
+    /**
+     * @brief Train the DMD model of every window.
+     *
+     * @param[in] k The number of modes (eigenvalues) to keep after doing
+     *              SVD in every window. Windows with fewer samples or rows
+     *              keep all their modes. k must not exceed the numerical rank
+     *              of the snapshots of any window.
+     */
+    void train(int k);
+
+    /**
+     * @brief Returns the number of windows.
+     */
+    int getNumWindows() const
+    {
+        return d_windows.size();
+    }
+
+    /**
+     * @brief Returns the index of the window containing time t, i.e. the
+     *        last window starting at or before t.
+     *
+     * @param[in] t The time.
+     */
+    int getWindowIndex(double t) const;
+
+    /**
+     * @brief Returns the DMD model of a window.
+     *
+     * @param[in] window The index of the window.
+     */
+    DMD* getWindow(int window) const;
+
+    /**
+     * @brief Predict the state at time t with the model of the window
+     *        containing t.
+     *
+     * @param[in] t The time of the outputted state.
+     */
+    Vector* predict(double t) const;
+
+private:
+
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    WindowedDMD();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    WindowedDMD(
+        const WindowedDMD& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    WindowedDMD&
+    operator = (
+        const WindowedDMD& rhs);
+
+    /**
+     * @brief Train every window with a single reduction. A k of -1 selects
+     *        the modes by energy fraction.
+     */
+    void constructWindows(double energy_fraction, int k);
+
+    /**
+     * @brief The full-order state dimension.
+     */
+    int d_dim;
+
+    /**
+     * @brief The dt between samples.
+     */
+    double d_dt;
+
+    /**
+     * @brief The number of samples between the start of two windows.
+     */
+    int d_window_num_samples;
+
+    /**
+     * @brief The number of samples past its end given to a window.
+     */
+    int d_window_overlap_samples;
+
+    /**
+     * @brief The state offset of every window.
+     */
+    Vector* d_state_offset;
+
+    /**
+     * @brief The number of samples taken.
+     */
+    int d_num_samples;
+
+    /**
+     * @brief The DMD model of each window.
+     */
+    std::vector<DMD*> d_windows;
+
+    /**
+     * @brief The time of the first sample of each window.
+     */
+    std::vector<double> d_window_start_times;
+};
+
+}
+
+#endif
@@ -11,9 +11,12 @@
 // Description: Implementation of the Interpolator algorithm.
 
 #include "Interpolator.h"
+#include "KDTree.h"
 
 #include <limits.h>
+#include <algorithm>
 #include <cmath>
+#include <iostream>
 #include "linalg/Matrix.h"
 #include "linalg/scalapack_wrapper.h"
 #include "mpi.h"
@@ -38,7 +41,7 @@ Interpolator::Interpolator(std::vector<Vector*> parameter_points,
 {
     CAROM_VERIFY(parameter_points.size() == rotation_matrices.size());
     CAROM_VERIFY(parameter_points.size() > 1);
-    CAROM_VERIFY(rbf == "G" || rbf == "IQ" || rbf == "IMQ");
+    CAROM_VERIFY(rbf == "G" || rbf == "IQ" || rbf == "IMQ" || rbf == "W");
     CAROM_VERIFY(interp_method == "LS" || interp_method == "IDW"
                  || interp_method == "LP");
     CAROM_VERIFY(closest_rbf_val >= 0.0 && closest_rbf_val <= 1.0);
@@ -60,14 +63,147 @@ Interpolator::Interpolator(std::vector<Vector*> parameter_points,
     d_rbf = rbf;
     d_interp_method = interp_method;
     d_epsilon = convertClosestRBFToEpsilon(parameter_points, rbf, closest_rbf_val);
+    if (isCompactRBF(rbf))
+    {
+        d_tree = new KDTree(parameter_points);
+    }
+}
+
+Interpolator::~Interpolator()
+{
+    delete d_tree;
+}
+
+SparseRBFMatrix::SparseRBFMatrix(std::vector<Vector*>& parameter_points,
+                                 std::string rbf, double epsilon,
+                                 const KDTree& tree) :
+    d_num_points(parameter_points.size())
+{
+    CAROM_VERIFY(isCompactRBF(rbf));
+    CAROM_VERIFY(tree.numPoints() == d_num_points);
+
+    // Only the points within the support of each point have nonzero RBFs.
+    std::vector<int> neighbors;
+    d_row_offsets.push_back(0);
+    for (int i = 0; i < d_num_points; i++)
+    {
+        tree.radiusSearch(parameter_points[i], 1.0 / epsilon, neighbors);
+        for (size_t j = 0; j < neighbors.size(); j++)
+        {
+            d_columns.push_back(neighbors[j]);
+            d_values.push_back(neighbors[j] == i ? 1.0 :
+                               obtainRBF(rbf, epsilon, parameter_points[i],
+                                         parameter_points[neighbors[j]]));
+        }
+        d_row_offsets.push_back(d_columns.size());
+    }
+}
+
+void SparseRBFMatrix::mult(const double* x, double* y) const
+{
+    for (int i = 0; i < d_num_points; i++)
+    {
+        double sum = 0.0;
+        for (int k = d_row_offsets[i]; k < d_row_offsets[i + 1]; k++)
+        {
+            sum += d_values[k] * x[d_columns[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+bool SparseRBFMatrix::solve(double* rhs, int num_rhs) const
+{
+    // The Wendland C2 RBF is positive definite for parameter dimensions up to
+    // 3, where the conjugate gradient method converges in at most
+    // d_num_points iterations in exact arithmetic. Beyond that it may fail.
+    bool converged = true;
+    const double rel_tol = 1.0e-12;
+    const int max_iterations = 10 * d_num_points + 100;
+    std::vector<double> x(d_num_points), r(d_num_points), p(d_num_points),
+        Ap(d_num_points);
+    for (int n = 0; n < num_rhs; n++)
+    {
+        double* b = rhs + n * d_num_points;
+        double r_norm2 = 0.0;
+        for (int i = 0; i < d_num_points; i++)
+        {
+            x[i] = 0.0;
+            r[i] = b[i];
+            p[i] = b[i];
+            r_norm2 += r[i] * r[i];
+        }
+        double tol2 = rel_tol * rel_tol * r_norm2;
+
+        int iteration = 0;
+        while (r_norm2 > tol2 && iteration < max_iterations)
+        {
+            mult(p.data(), Ap.data());
+            double pAp = 0.0;
+            for (int i = 0; i < d_num_points; i++)
+            {
+                pAp += p[i] * Ap[i];
+            }
+            double alpha = r_norm2 / pAp;
+            double new_r_norm2 = 0.0;
+            for (int i = 0; i < d_num_points; i++)
+            {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * Ap[i];
+                new_r_norm2 += r[i] * r[i];
+            }
+            double beta = new_r_norm2 / r_norm2;
+            for (int i = 0; i < d_num_points; i++)
+            {
+                p[i] = r[i] + beta * p[i];
+            }
+            r_norm2 = new_r_norm2;
+            iteration++;
+        }
+        if (r_norm2 > tol2)
+        {
+            converged = false;
+        }
+
+        std::copy(x.begin(), x.end(), b);
+    }
+    return converged;
 }
 
 std::vector<double> obtainRBFToTrainingPoints(std::vector<Vector*>
         parameter_points,
-        std::string interp_method, std::string rbf, double epsilon, Vector* point)
+        std::string interp_method, std::string rbf, double epsilon, Vector* point,
+        const KDTree* tree)
 {
     std::vector<double> rbfs;
-    if (interp_method == "LS")
+    if (tree != NULL && isCompactRBF(rbf) && interp_method != "LP")
+    {
+        // Only the parameter points within the support have nonzero RBFs.
+        std::vector<int> neighbors;
+        tree->radiusSearch(point, 1.0 / epsilon, neighbors);
+        rbfs.resize(parameter_points.size(), 0.0);
+        bool distance_is_zero = false;
+        for (size_t i = 0; i < neighbors.size(); i++)
+        {
+            double res = obtainRBF(rbf, epsilon, point, parameter_points[neighbors[i]]);
+            rbfs[neighbors[i]] = res;
+            if (res == 1.0)
+            {
+                distance_is_zero = true;
+            }
+        }
+        if (interp_method == "IDW" && distance_is_zero)
+        {
+            for (size_t i = 0; i < neighbors.size(); i++)
+            {
+                if (rbfs[neighbors[i]] != 1.0)
+                {
+                    rbfs[neighbors[i]] = 0.0;
+                }
+            }
+        }
+    }
+    else if (interp_method == "LS")
     {
         for (int i = 0; i < parameter_points.size(); i++)
         {
@@ -128,6 +264,19 @@ std::vector<double> obtainRBFToTrainingPoints(std::vector<Vector*>
             rbfs.push_back(coeff);
         }
     }
+
+    // Beyond the support of every parameter point, IDW would divide by a zero
+    // sum and LS would return the reference point.
+    if (isCompactRBF(rbf) && interp_method != "LP" &&
+            std::all_of(rbfs.begin(), rbfs.end(),
+                        [](double res) {
+                            return res == 0.0;
+                        }))
+    {
+        CAROM_ERROR("The point is outside the support of the compactly "
+                    "supported RBF of every parameter point. Please choose a "
+                    "smaller epsilon value.");
+    }
     return rbfs;
 }
 
@@ -164,48 +313,75 @@ double obtainRBF(std::string rbf, double epsilon, Vector* point1,
     {
         res = 1.0 / std::sqrt(1.0 + eps_norm_squared);
     }
+    // Wendland C2 RBF, zero beyond a distance of 1 / epsilon
+    else if (rbf == "W")
+    {
+        double r = std::sqrt(eps_norm_squared);
+        if (r < 1.0)
+        {
+            res = std::pow(1.0 - r, 4) * (4.0 * r + 1.0);
+        }
+    }
 
     return res;
 }
 
+bool isCompactRBF(std::string rbf)
+{
+    return rbf == "W";
+}
+
 double convertClosestRBFToEpsilon(std::vector<Vector*> parameter_points,
                                   std::string rbf, double closest_rbf_val)
 {
+    // Find the squared distance between the closest two points.
+    KDTree tree(parameter_points);
     double closest_point_dist = INT_MAX;
+    for (size_t i = 0; i < parameter_points.size(); i++)
+    {
+        int j = tree.nearestNeighbor(parameter_points[i], i);
+        Vector diff;
+        parameter_points[i]->minus(*parameter_points[j], diff);
+        closest_point_dist = std::min(closest_point_dist, diff.norm2());
+    }
+
     double epsilon;
-    for (int i = 0; i < parameter_points.size(); i++)
+
+    // Gaussian RBF
+    if (rbf == "G")
+    {
+        epsilon = std::sqrt(-std::log(closest_rbf_val) / closest_point_dist);
+    }
+    // Inverse quadratic RBF
+    else if (rbf == "IQ")
+    {
+        epsilon = std::sqrt(((1.0 / closest_rbf_val) - 1.0) / closest_point_dist);
+    }
+    // Inverse multiquadric RBF
+    else if (rbf == "IMQ")
+    {
+        epsilon = std::sqrt((std::pow(1.0 / closest_rbf_val, 2) - 1.0) /
+                            closest_point_dist);
+    }
+    // Wendland C2 RBF, which decreases from 1 at r = 0 to 0 at r = 1, so
+    // bisect for the r where it equals closest_rbf_val.
+    else if (rbf == "W")
     {
-        for (int j = 0; j < parameter_points.size(); j++)
+        CAROM_VERIFY(closest_rbf_val > 0.0 && closest_rbf_val < 1.0);
+        double r_lo = 0.0, r_hi = 1.0;
+        for (int iteration = 0; iteration < 60; iteration++)
         {
-            if (i == j)
+            double r = 0.5 * (r_lo + r_hi);
+            if (std::pow(1.0 - r, 4) * (4.0 * r + 1.0) > closest_rbf_val)
             {
-                continue;
+                r_lo = r;
             }
-
-            Vector diff;
-            parameter_points[i]->minus(*parameter_points[j], diff);
-            double dist = diff.norm2();
-            if (dist < closest_point_dist)
+            else
             {
-                closest_point_dist = dist;
-
-                // Gaussian RBF
-                if (rbf == "G")
-                {
-                    epsilon = std::sqrt(-std::log(closest_rbf_val) / diff.norm2());
-                }
-                // Inverse quadratic RBF
-                else if (rbf == "IQ")
-                {
-                    epsilon = std::sqrt(((1.0 / closest_rbf_val) - 1.0) / diff.norm2());
-                }
-                // Inverse multiquadric RBF
-                else if (rbf == "IMQ")
-                {
-                    epsilon = std::sqrt((std::pow(1.0 / closest_rbf_val, 2) - 1.0) / diff.norm2());
-                }
+                r_hi = r;
             }
         }
+        epsilon = 0.5 * (r_lo + r_hi) / std::sqrt(closest_point_dist);
     }
 
     return epsilon;
@@ -228,22 +404,78 @@ std::vector<Matrix*> obtainRotationMatrices(std::vector<Vector*>
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
 
-    std::vector<Matrix*> rotation_matrices;
-
-    // Obtain the rotation matrices to rotate the bases into
-    // the same generalized coordinate space.
-    for (int i = 0; i < parameter_points.size(); i++)
+    int num_points = parameter_points.size();
+    int num_rows = bases[ref_point]->numRows();
+    int num_cols = bases[ref_point]->numColumns();
+    int size = num_cols * num_cols;
+    Matrix ref_basis(bases[ref_point]->getData(), num_rows, num_cols, false,
+                     false);
+
+    // Form the local part of the product of each basis with the reference
+    // basis, one after the other in one buffer, and sum them all in a single
+    // reduction rather than one per parameter point.
+    std::vector<double> basis_mult_bases(num_points * size, 0.0);
+    for (int i = 0; i < num_points; i++)
     {
         CAROM_VERIFY(bases[i]->numRows() == bases[ref_point]->numRows());
         CAROM_VERIFY(bases[i]->numColumns() == bases[ref_point]->numColumns());
         CAROM_VERIFY(bases[i]->distributed() == bases[ref_point]->distributed());
+        if (i == ref_point)
+        {
+            continue;
+        }
 
+        Matrix basis(bases[i]->getData(), num_rows, num_cols, false, false);
+        Matrix basis_mult_basis(&basis_mult_bases[i * size], num_cols, num_cols,
+                                false, false);
+        basis.transposeMult(ref_basis, basis_mult_basis);
+    }
+    if (bases[ref_point]->distributed() && num_procs > 1)
+    {
+        CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, basis_mult_bases.data(),
+                                   num_points * size, MPI_DOUBLE, MPI_SUM,
+                                   MPI_COMM_WORLD) == MPI_SUCCESS);
+    }
+
+    // The SVDs of the small products are independent, so they are dealt
+    // round-robin to the processes. Process p computes the rotation matrices
+    // of the points p, p + num_procs, ..., and all of them are shared in a
+    // single gather.
+    int num_local_points = (num_points + num_procs - 1) / num_procs;
+    std::vector<double> local_rotations(num_local_points * size, 0.0);
+    Matrix basis(num_cols, num_cols, false);
+    Matrix basis_right(num_cols, num_cols, false);
+    Vector sv(num_cols, false);
+    for (int i = rank; i < num_points; i += num_procs)
+    {
+        if (i == ref_point)
+        {
+            continue;
+        }
+
+        Matrix basis_mult_basis(&basis_mult_bases[i * size], num_cols, num_cols,
+                                false, false);
+        Matrix rotation_matrix(&local_rotations[(i / num_procs) * size],
+                               num_cols, num_cols, false, false);
+        SerialSVD(&basis_mult_basis, &basis_right, &sv, &basis);
+        basis.mult(basis_right, rotation_matrix);
+    }
+
+    std::vector<double> rotations(num_procs * num_local_points * size);
+    CAROM_VERIFY(MPI_Allgather(local_rotations.data(), num_local_points * size,
+                               MPI_DOUBLE, rotations.data(), num_local_points * size,
+                               MPI_DOUBLE, MPI_COMM_WORLD) == MPI_SUCCESS);
+
+    // Obtain the rotation matrices to rotate the bases into
+    // the same generalized coordinate space.
+    std::vector<Matrix*> rotation_matrices;
+    for (int i = 0; i < num_points; i++)
+    {
         // If at ref point, the rotation_matrix is the identity matrix
         // since the ref point doesn't need to be rotated.
         if (i == ref_point)
         {
-            Matrix* identity_matrix = new Matrix(bases[i]->numColumns(),
-                                                 bases[i]->numColumns(), false);
+            Matrix* identity_matrix = new Matrix(num_cols, num_cols, false);
             for (int j = 0; j < identity_matrix->numColumns(); j++) {
                 identity_matrix->item(j, j) = 1.0;
             }
@@ -251,36 +483,9 @@ std::vector<Matrix*> obtainRotationMatrices(std::vector<Vector*>
             continue;
         }
 
-        Matrix* basis_mult_basis = bases[i]->transposeMult(bases[ref_point]);
-        Matrix* basis = new Matrix(basis_mult_basis->numRows(),
-                                   basis_mult_basis->numColumns(), false);
-        Matrix* basis_right = new Matrix(basis_mult_basis->numColumns(),
-                                         basis_mult_basis->numColumns(), false);
-
-        // We need to compute the SVD of basis_mult_basis. Since it is
-        // undistributed due to the transposeMult, let's use lapack's serial SVD
-        // on rank 0 only.
-        if (rank == 0)
-        {
-            Vector* sv = new Vector(basis_mult_basis->numColumns(), false);
-            SerialSVD(basis_mult_basis, basis_right, sv, basis);
-            delete sv;
-        }
-
-        // Broadcast U and V which are computed only on root.
-        MPI_Bcast(basis->getData(), basis->numRows() * basis->numColumns(), MPI_DOUBLE,
-                  0, MPI_COMM_WORLD);
-        MPI_Bcast(basis_right->getData(),
-                  basis_right->numRows() * basis_right->numColumns(), MPI_DOUBLE, 0,
-                  MPI_COMM_WORLD);
-
-        // Obtain the rotation matrix.
-        Matrix* rotation_matrix = basis->mult(basis_right);
-
-        delete basis_mult_basis;
-        delete basis;
-        delete basis_right;
-        rotation_matrices.push_back(rotation_matrix);
+        int offset = ((i % num_procs) * num_local_points + i / num_procs) * size;
+        rotation_matrices.push_back(new Matrix(&rotations[offset], num_cols,
+                                               num_cols, false, true));
     }
 
     return rotation_matrices;
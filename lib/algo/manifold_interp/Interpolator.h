@@ -18,6 +18,7 @@
 
 namespace CAROM {
 
+class KDTree;
 class Matrix;
 class Vector;
 
@@ -42,7 +43,8 @@ protected:
      *                              to the reference point
      * @param[in] rbf               The RBF type ("G" == gaussian,
      *                              "IQ" == inverse quadratic, "IMQ" == inverse
-     *                              multiquadric)
+     *                              multiquadric, "W" == compactly supported
+     *                              Wendland C2)
      * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
      *                             "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
      * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
@@ -55,6 +57,11 @@ protected:
                  std::string interp_method,
                  double closest_rbf_val = 0.9);
 
+    /**
+     * @brief Destructor.
+     */
+    ~Interpolator();
+
     /**
      * @brief The rank of the process this object belongs to.
      */
@@ -105,6 +112,13 @@ protected:
      */
     Matrix* d_lambda_T;
 
+    /**
+     * @brief The spatial index of the parameter points, used to evaluate only
+     *        the RBFs whose support holds the unsampled parameter point when
+     *        the RBF is compactly supported, and NULL otherwise.
+     */
+    KDTree* d_tree = NULL;
+
 private:
 
     /**
@@ -126,6 +140,73 @@ private:
         const Interpolator& rhs);
 };
 
+/**
+ * SparseRBFMatrix is the sparse matrix of a compactly supported RBF between
+ * every pair of parameter points. Only the pairs within the support are
+ * stored, so it is assembled and applied at a cost proportional to the
+ * number of neighbors instead of the square of the number of points.
+ */
+class SparseRBFMatrix
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] parameter_points The parameter points.
+     * @param[in] rbf              Which RBF to compute, which must be
+     *                             compactly supported.
+     * @param[in] epsilon          The RBF parameter that determines the width
+     *                             of influence.
+     * @param[in] tree             The spatial index of the parameter points.
+     */
+    SparseRBFMatrix(std::vector<Vector*>& parameter_points, std::string rbf,
+                    double epsilon, const KDTree& tree);
+
+    /**
+     * @brief Solve the symmetric system with the RBF matrix by the
+     *        conjugate gradient method.
+     *
+     * The Wendland C2 RBF matrix is positive definite only for parameter
+     *        points of dimension at most 3. In higher dimensions the
+     *        method may not converge.
+     *
+     * @param[in,out] rhs     The right hand sides, one after the other,
+     *                        which are overwritten with the solutions.
+     * @param[in]     num_rhs The number of right hand sides.
+     *
+     * @return True if the method converged for every right hand side.
+     */
+    bool solve(double* rhs, int num_rhs) const;
+
+private:
+
+    /**
+     * @brief Compute y = B*x.
+     */
+    void mult(const double* x, double* y) const;
+
+    /**
+     * @brief The number of parameter points.
+     */
+    int d_num_points;
+
+    /**
+     * @brief The offset of the first stored entry of each row.
+     */
+    std::vector<int> d_row_offsets;
+
+    /**
+     * @brief The column of each stored entry.
+     */
+    std::vector<int> d_columns;
+
+    /**
+     * @brief The value of each stored entry.
+     */
+    std::vector<double> d_values;
+};
+
 /**
  * @brief Compute the RBF from the parameter points with the
  *        unsampled parameter point.
@@ -137,10 +218,18 @@ private:
  * @param[in] epsilon   The RBF parameter that determines the width of
                         influence.
  * @param[in] point The unsampled parameter point.
+ * @param[in] tree  The spatial index of the parameter points. If given and
+ *                  the RBF is compactly supported, only the RBFs of the
+ *                  parameter points within the support are computed and
+ *                  the others are zero.
+ *
+ * A compactly supported RBF that is zero at every parameter point is an
+ * error, except for "LP", which does not use the RBF.
  */
 std::vector<double> obtainRBFToTrainingPoints(std::vector<Vector*>
         parameter_points,
-        std::string interp_method, std::string rbf, double epsilon, Vector* point);
+        std::string interp_method, std::string rbf, double epsilon, Vector* point,
+        const KDTree* tree = NULL);
 
 /**
  * @brief Compute the sum of the RBF weights.
@@ -161,6 +250,13 @@ double rbfWeightedSum(std::vector<double>& rbf);
 double obtainRBF(std::string rbf, double epsilon, Vector* point1,
                  Vector* point2);
 
+/**
+ * @brief Returns whether the RBF is zero beyond a distance of 1 / epsilon.
+ *
+ * @param[in] rbf Which RBF.
+ */
+bool isCompactRBF(std::string rbf);
+
 /**
  * @brief Convert closest RBF value to an epsilon value.
  *
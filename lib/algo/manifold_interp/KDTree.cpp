@@ -0,0 +1,191 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Implementation of the KDTree class.
+
+#include "KDTree.h"
+
+#include "linalg/Vector.h"
+#include "utils/Utilities.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace CAROM {
+
+namespace {
+
+// Ranges of at most this many points are searched exhaustively.
+const int leaf_size = 8;
+
+}
+
+KDTree::KDTree(const std::vector<Vector*>& points) :
+    d_num_points(points.size()),
+    d_dim(points.empty() ? 0 : points[0]->dim())
+{
+    d_coords.resize(d_num_points * d_dim);
+    d_order.resize(d_num_points);
+    for (int i = 0; i < d_num_points; i++)
+    {
+        CAROM_VERIFY(!points[i]->distributed());
+        CAROM_VERIFY(points[i]->dim() == d_dim);
+        std::copy(points[i]->getData(), points[i]->getData() + d_dim,
+                  &d_coords[i * d_dim]);
+        d_order[i] = i;
+    }
+    build(0, d_num_points, 0);
+}
+
+void
+KDTree::build(int lo, int hi, int depth)
+{
+    if (hi - lo <= leaf_size)
+    {
+        return;
+    }
+
+    int axis = depth % d_dim;
+    int mid = (lo + hi) / 2;
+    std::nth_element(d_order.begin() + lo, d_order.begin() + mid,
+                     d_order.begin() + hi,
+                     [this, axis](int a, int b)
+    {
+        return d_coords[a * d_dim + axis] < d_coords[b * d_dim + axis];
+    });
+    build(lo, mid, depth + 1);
+    build(mid + 1, hi, depth + 1);
+}
+
+double
+KDTree::distanceSquared(const double* point, int index) const
+{
+    const double* coords = &d_coords[index * d_dim];
+    double distance = 0.0;
+    for (int i = 0; i < d_dim; i++)
+    {
+        double diff = point[i] - coords[i];
+        distance += diff * diff;
+    }
+    return distance;
+}
+
+void
+KDTree::radiusSearch(const Vector* point, double radius,
+                     std::vector<int>& indices) const
+{
+    CAROM_VERIFY(point->dim() == d_dim);
+    indices.clear();
+    radiusSearch(point->getData(), radius * radius, 0, d_num_points, 0,
+                 indices);
+}
+
+void
+KDTree::radiusSearch(const double* point, double radius_squared, int lo,
+                     int hi, int depth, std::vector<int>& indices) const
+{
+    if (hi - lo <= leaf_size)
+    {
+        for (int i = lo; i < hi; i++)
+        {
+            if (distanceSquared(point, d_order[i]) < radius_squared)
+            {
+                indices.push_back(d_order[i]);
+            }
+        }
+        return;
+    }
+
+    int axis = depth % d_dim;
+    int mid = (lo + hi) / 2;
+    int split = d_order[mid];
+    if (distanceSquared(point, split) < radius_squared)
+    {
+        indices.push_back(split);
+    }
+
+    // Only the side of the splitting plane the point is on can hold points
+    // within the radius, unless the plane itself is within the radius.
+    double diff = point[axis] - d_coords[split * d_dim + axis];
+    if (diff <= 0.0 || diff * diff < radius_squared)
+    {
+        radiusSearch(point, radius_squared, lo, mid, depth + 1, indices);
+    }
+    if (diff >= 0.0 || diff * diff < radius_squared)
+    {
+        radiusSearch(point, radius_squared, mid + 1, hi, depth + 1, indices);
+    }
+}
+
+int
+KDTree::nearestNeighbor(const Vector* point, int exclude) const
+{
+    CAROM_VERIFY(point->dim() == d_dim);
+    CAROM_VERIFY(d_num_points > (exclude >= 0 ? 1 : 0));
+    int best = -1;
+    double best_distance = std::numeric_limits<double>::max();
+    nearestNeighbor(point->getData(), exclude, 0, d_num_points, 0, best,
+                    best_distance);
+    return best;
+}
+
+void
+KDTree::nearestNeighbor(const double* point, int exclude, int lo, int hi,
+                        int depth, int& best, double& best_distance) const
+{
+    if (hi - lo <= leaf_size)
+    {
+        for (int i = lo; i < hi; i++)
+        {
+            double distance = distanceSquared(point, d_order[i]);
+            if (d_order[i] != exclude && distance < best_distance)
+            {
+                best = d_order[i];
+                best_distance = distance;
+            }
+        }
+        return;
+    }
+
+    int axis = depth % d_dim;
+    int mid = (lo + hi) / 2;
+    int split = d_order[mid];
+    double distance = distanceSquared(point, split);
+    if (split != exclude && distance < best_distance)
+    {
+        best = split;
+        best_distance = distance;
+    }
+
+    // Search the side of the point first, then the other side only if the
+    // splitting plane is nearer than the best point so far.
+    double diff = point[axis] - d_coords[split * d_dim + axis];
+    if (diff <= 0.0)
+    {
+        nearestNeighbor(point, exclude, lo, mid, depth + 1, best, best_distance);
+        if (diff * diff < best_distance)
+        {
+            nearestNeighbor(point, exclude, mid + 1, hi, depth + 1, best,
+                            best_distance);
+        }
+    }
+    else
+    {
+        nearestNeighbor(point, exclude, mid + 1, hi, depth + 1, best,
+                        best_distance);
+        if (diff * diff < best_distance)
+        {
+            nearestNeighbor(point, exclude, lo, mid, depth + 1, best,
+                            best_distance);
+        }
+    }
+}
+
+}
@@ -0,0 +1,139 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: A k-d tree over a set of parameter points for the neighbor
+//              searches of the RBF interpolators.
+
+#ifndef included_KDTree_h
+#define included_KDTree_h
+
+#include <vector>
+
+namespace CAROM {
+
+class Vector;
+
+/**
+ * KDTree is a static k-d tree over a set of undistributed points of the same
+ * dimension. It finds the points within a radius of a query point, or the
+ * nearest point, in time logarithmic in the number of points for
+ * well-spread points instead of visiting every point.
+ */
+class KDTree
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] points The points. The tree keeps a copy of their
+     *                   coordinates.
+     */
+    KDTree(const std::vector<Vector*>& points);
+
+    /**
+     * @brief Find the points within a distance of a query point.
+     *
+     * @param[in]  point   The query point.
+     * @param[in]  radius  The distance.
+     * @param[out] indices The indices of the points whose distance to the
+     *                     query point is less than radius, in no particular
+     *                     order.
+     */
+    void radiusSearch(const Vector* point, double radius,
+                      std::vector<int>& indices) const;
+
+    /**
+     * @brief Find the point nearest to a query point.
+     *
+     * @param[in] point   The query point.
+     * @param[in] exclude The index of a point to skip, or -1 for none.
+     *
+     * @return The index of the nearest point.
+     */
+    int nearestNeighbor(const Vector* point, int exclude = -1) const;
+
+    /**
+     * @brief Returns the number of points.
+     */
+    int numPoints() const
+    {
+        return d_num_points;
+    }
+
+private:
+
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    KDTree();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    KDTree(
+        const KDTree& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    KDTree&
+    operator = (
+        const KDTree& rhs);
+
+    /**
+     * @brief Split d_order[lo, hi) at its median along the axis of the
+     *        given depth and recurse on both halves.
+     */
+    void build(int lo, int hi, int depth);
+
+    /**
+     * @brief Search d_order[lo, hi) for the points within radius.
+     */
+    void radiusSearch(const double* point, double radius_squared, int lo,
+                      int hi, int depth, std::vector<int>& indices) const;
+
+    /**
+     * @brief Search d_order[lo, hi) for a point nearer than the best so far.
+     */
+    void nearestNeighbor(const double* point, int exclude, int lo, int hi,
+                         int depth, int& best, double& best_distance) const;
+
+    /**
+     * @brief Returns the squared distance between a query point and the
+     *        point of the given index.
+     */
+    double distanceSquared(const double* point, int index) const;
+
+    /**
+     * @brief The number of points.
+     */
+    int d_num_points;
+
+    /**
+     * @brief The dimension of the points.
+     */
+    int d_dim;
+
+    /**
+     * @brief The coordinates of the points, one point after the other.
+     */
+    std::vector<double> d_coords;
+
+    /**
+     * @brief The point indices, ordered so that each subtree is a range
+     *        whose median is the splitting point.
+     */
+    std::vector<int> d_order;
+};
+
+}
+
+#endif
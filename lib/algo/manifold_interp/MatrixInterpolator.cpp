@@ -26,11 +26,15 @@
 #endif
 
 /* Use automatically detected Fortran name-mangling scheme */
-#define dposv CAROM_FC_GLOBAL(dposv, DPOSV)
+#define dpotrf CAROM_FC_GLOBAL(dpotrf, DPOTRF)
+#define dpotrs CAROM_FC_GLOBAL(dpotrs, DPOTRS)
 
 extern "C" {
-    // Solve a system of linear equations.
-    void dposv(char*, int*, int*, double*, int*, double*, int*, int*);
+    // Cholesky factorization of a symmetric positive-definite matrix.
+    void dpotrf(char*, int*, double*, int*, int*);
+
+    // Solve a system of linear equations with a Cholesky factorization.
+    void dpotrs(char*, int*, int*, double*, int*, double*, int*, int*);
 }
 
 using namespace std;
@@ -83,6 +87,25 @@ MatrixInterpolator::MatrixInterpolator(std::vector<Vector*> parameter_points,
     }
 }
 
+MatrixInterpolator::~MatrixInterpolator()
+{
+    for (int i = 0; i < d_rotated_reduced_matrices.size(); i++)
+    {
+        // The reduced matrix of the ref_point is not a copy.
+        if (i != d_ref_point)
+        {
+            delete d_rotated_reduced_matrices[i];
+        }
+    }
+    for (int i = 0; i < d_gammas.size(); i++)
+    {
+        delete d_gammas[i];
+    }
+    delete d_rbf_factor;
+    delete d_sparse_rbf_matrix;
+    delete d_x_half_power;
+}
+
 Matrix* MatrixInterpolator::interpolate(Vector* point, bool orthogonalize)
 {
     Matrix* interpolated_matrix = NULL;
@@ -109,50 +132,43 @@ Matrix* MatrixInterpolator::interpolate(Vector* point, bool orthogonalize)
 
 void MatrixInterpolator::obtainLambda()
 {
-    if (d_interp_method == "LS")
+    if (d_interp_method == "LS" && isCompactRBF(d_rbf))
+    {
+        // Only the nonzero RBFs are kept and the weights are solved for
+        // iteratively.
+        d_sparse_rbf_matrix = new SparseRBFMatrix(d_parameter_points, d_rbf,
+                d_epsilon, *d_tree);
+    }
+    else if (d_interp_method == "LS")
     {
-        // Solving f = B*lambda
-        Matrix* f_T = new Matrix(d_gammas[0]->numRows() * d_gammas[0]->numColumns(),
-                                 d_gammas.size(), false);
-        for (int i = 0; i < f_T->numRows(); i++)
-        {
-            for (int j = 0; j < f_T->numColumns(); j++)
-            {
-                f_T->item(i, j) = d_gammas[j]->getData()[i];
-            }
-        }
-
         // Obtain B matrix by calculating RBF.
-        Matrix* B = new Matrix(d_gammas.size(), d_gammas.size(), false);
-        for (int i = 0; i < B->numRows(); i++)
+        d_rbf_factor = new Matrix(d_gammas.size(), d_gammas.size(), false);
+        for (int i = 0; i < d_rbf_factor->numRows(); i++)
         {
-            B->item(i, i) = 1.0;
-            for (int j = i + 1; j < B->numColumns(); j++)
+            d_rbf_factor->item(i, i) = 1.0;
+            for (int j = i + 1; j < d_rbf_factor->numColumns(); j++)
             {
                 double res = obtainRBF(d_rbf, d_epsilon, d_parameter_points[i],
                                        d_parameter_points[j]);
-                B->item(i, j) = res;
-                B->item(j, i) = res;
+                d_rbf_factor->item(i, j) = res;
+                d_rbf_factor->item(j, i) = res;
             }
         }
 
+        // Factor B once. Since f = B*lambda and the interpolant is
+        // lambda*rbf = f*(B^-1 rbf), each query solves for the weights
+        // B^-1 rbf instead of storing lambda, a copy of all the gammas.
         char uplo = 'U';
         int gamma_size = d_gammas.size();
-        int num_elements = d_gammas[0]->numRows() * d_gammas[0]->numColumns();
         int info;
 
-        dposv(&uplo, &gamma_size, &num_elements, B->getData(),  &gamma_size,
-              f_T->getData(), &gamma_size, &info);
+        dpotrf(&uplo, &gamma_size, d_rbf_factor->getData(), &gamma_size, &info);
         if (info != 0)
         {
             std::cout << "Linear solve failed. Please choose a different epsilon value." <<
                       std::endl;
         }
         CAROM_VERIFY(info == 0);
-
-        delete B;
-
-        d_lambda_T = f_T;
     }
 }
 
@@ -163,40 +179,52 @@ Matrix* MatrixInterpolator::obtainLogInterpolatedMatrix(
         d_rotated_reduced_matrices[d_ref_point]->numRows(),
         d_rotated_reduced_matrices[d_ref_point]->numColumns(),
         d_rotated_reduced_matrices[d_ref_point]->distributed());
-    if (d_interp_method == "LS")
+
+    // Obtain the weight of each gamma.
+    std::vector<double> weights(rbf);
+    if (d_interp_method == "LS" && d_sparse_rbf_matrix != NULL)
     {
-        for (int i = 0; i < d_lambda_T->numRows(); i++)
+        if (!d_sparse_rbf_matrix->solve(weights.data(), 1))
         {
-            for (int j = 0; j < rbf.size(); j++)
-            {
-                log_interpolated_matrix->getData()[i] += d_lambda_T->item(i, j) * rbf[j];
-            }
+            CAROM_ERROR("Conjugate gradient solve with the compactly "
+                        "supported RBF failed. Please choose a different "
+                        "epsilon value.");
         }
     }
+    else if (d_interp_method == "LS")
+    {
+        char uplo = 'U';
+        int gamma_size = d_gammas.size();
+        int num_rhs = 1;
+        int info;
+
+        dpotrs(&uplo, &gamma_size, &num_rhs, d_rbf_factor->getData(), &gamma_size,
+               weights.data(), &gamma_size, &info);
+        CAROM_VERIFY(info == 0);
+    }
     else if (d_interp_method == "IDW")
     {
         double sum = rbfWeightedSum(rbf);
-        int num_elements = d_rotated_reduced_matrices[d_ref_point]->numRows() *
-                           d_rotated_reduced_matrices[d_ref_point]->numColumns();
-        for (int i = 0; i < num_elements; i++)
+        for (int j = 0; j < weights.size(); j++)
         {
-            for (int j = 0; j < rbf.size(); j++)
-            {
-                log_interpolated_matrix->getData()[i] += d_gammas[j]->getData()[i] * rbf[j];
-            }
-            log_interpolated_matrix->getData()[i] /= sum;
+            weights[j] /= sum;
         }
     }
-    else if (d_interp_method == "LP")
+
+    // Sum the weighted gammas one after the other.
+    int num_elements = d_rotated_reduced_matrices[d_ref_point]->numRows() *
+                       d_rotated_reduced_matrices[d_ref_point]->numColumns();
+    double* log_interpolated_data = log_interpolated_matrix->getData();
+    for (int j = 0; j < weights.size(); j++)
     {
-        int num_elements = d_rotated_reduced_matrices[d_ref_point]->numRows() *
-                           d_rotated_reduced_matrices[d_ref_point]->numColumns();
+        if (weights[j] == 0.0)
+        {
+            continue;
+        }
+        const double* gamma_data = d_gammas[j]->getData();
         for (int i = 0; i < num_elements; i++)
         {
-            for (int j = 0; j < rbf.size(); j++)
-            {
-                log_interpolated_matrix->getData()[i] += d_gammas[j]->getData()[i] * rbf[j];
-            }
+            log_interpolated_data[i] += weights[j] * gamma_data[i];
         }
     }
     return log_interpolated_matrix;
@@ -301,14 +329,14 @@ Matrix* MatrixInterpolator::interpolateSPDMatrix(Vector* point)
 
         delete x_half_power_inv;
 
-        // Obtain lambda for the P interpolation matrix
+        // Factor the RBF matrix for the P interpolation matrix
         obtainLambda();
     }
 
     // Obtain distances from database points to new point
     std::vector<double> rbf = obtainRBFToTrainingPoints(d_parameter_points,
                               d_interp_method,
-                              d_rbf, d_epsilon, point);
+                              d_rbf, d_epsilon, point, d_tree);
 
     // Interpolate gammas to get gamma for new point
     Matrix* log_interpolated_matrix = obtainLogInterpolatedMatrix(rbf);
@@ -414,13 +442,13 @@ Matrix* MatrixInterpolator::interpolateNonSingularMatrix(Vector* point)
 
         delete ref_matrix_inv;
 
-        // Obtain lambda for the P interpolation matrix
+        // Factor the RBF matrix for the P interpolation matrix
         obtainLambda();
     }
 
     // Obtain distances from database points to new point
     std::vector<double> rbf = obtainRBFToTrainingPoints(d_parameter_points,
-                              d_interp_method, d_rbf, d_epsilon, point);
+                              d_interp_method, d_rbf, d_epsilon, point, d_tree);
 
     // Interpolate gammas to get gamma for new point
     Matrix* log_interpolated_matrix = obtainLogInterpolatedMatrix(rbf);
@@ -488,13 +516,13 @@ Matrix* MatrixInterpolator::interpolateMatrix(Vector* point)
             }
         }
 
-        // Obtain lambda for the P interpolation matrix
+        // Factor the RBF matrix for the P interpolation matrix
         obtainLambda();
     }
     // Obtain distances from database points to new point
     std::vector<double> rbf = obtainRBFToTrainingPoints(d_parameter_points,
                               d_interp_method,
-                              d_rbf, d_epsilon, point);
+                              d_rbf, d_epsilon, point, d_tree);
 
     // Interpolate gammas to get gamma for new point
     Matrix* interpolated_matrix = obtainLogInterpolatedMatrix(rbf);
@@ -51,7 +51,8 @@ public:
      *                              positive-definite)
      * @param[in] rbf               The RBF type ("G" == gaussian,
      *                              "IQ" == inverse quadratic, "IMQ" == inverse
-     *                              multiquadric)
+     *                              multiquadric, "W" == compactly supported
+     *                              Wendland C2)
      * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
      *                              "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
      * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
@@ -66,6 +67,11 @@ public:
                        std::string interp_method = "LS",
                        double closest_rbf_val = 0.9);
 
+    /**
+     * @brief Destructor.
+     */
+    ~MatrixInterpolator();
+
     /**
      * @brief Obtain the interpolated reduced matrix of the unsampled parameter point.
      *
@@ -95,8 +101,8 @@ private:
         const MatrixInterpolator& rhs);
 
     /**
-     * @brief Solve the system of equations of the gammas to obtain the
-     *        lambda for the P matrix.
+     * @brief Factor the RBF matrix of the parameter points, which maps the
+     *        lambda of the P matrix to the gammas.
      */
     void obtainLambda();
 
@@ -150,7 +156,20 @@ private:
     /**
      * @brief The reduced matrix of the reference point to the half power.
      */
-    Matrix* d_x_half_power;
+    Matrix* d_x_half_power = NULL;
+
+    /**
+     * @brief The Cholesky factor of the RBF matrix of the parameter points,
+     *        used by the LS interpolation method.
+     */
+    Matrix* d_rbf_factor = NULL;
+
+    /**
+     * @brief The sparse RBF matrix of the parameter points, used instead of
+     *        d_rbf_factor by the LS interpolation method when the RBF is
+     *        compactly supported.
+     */
+    SparseRBFMatrix* d_sparse_rbf_matrix = NULL;
 };
 
 }
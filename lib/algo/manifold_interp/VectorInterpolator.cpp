@@ -11,6 +11,7 @@
 // Description: Implementation of the VectorInterpolator algorithm.
 
 #include "VectorInterpolator.h"
+#include "KDTree.h"
 
 #include <limits.h>
 #include <cmath>
@@ -114,7 +115,7 @@ Vector* VectorInterpolator::interpolate(Vector* point)
 
     // Obtain distances from database points to new point
     std::vector<double> rbf = obtainRBFToTrainingPoints(d_parameter_points,
-                              d_interp_method, d_rbf, d_epsilon, point);
+                              d_interp_method, d_rbf, d_epsilon, point, d_tree);
 
     // Interpolate gammas to get gamma for new point
     Vector* log_interpolated_vector = obtainLogInterpolatedVector(rbf);
@@ -192,34 +193,50 @@ Matrix* solveLinearSystem(std::vector<Vector*> parameter_points,
             }
         }
 
-        // Obtain B vector by calculating RBF.
-        Matrix* B = new Matrix(data.size(), data.size(), false);
-        for (int i = 0; i < B->numRows(); i++)
+        if (isCompactRBF(rbf))
         {
-            B->item(i, i) = 1.0;
-            for (int j = i + 1; j < B->numColumns(); j++)
+            // Only the nonzero RBFs are kept and each element is solved for
+            // iteratively.
+            KDTree tree(parameter_points);
+            SparseRBFMatrix B(parameter_points, rbf, epsilon, tree);
+            if (!B.solve(f_T->getData(), f_T->numRows()))
             {
-                double res = obtainRBF(rbf, epsilon, parameter_points[i], parameter_points[j]);
-                B->item(i, j) = res;
-                B->item(j, i) = res;
+                CAROM_ERROR("Conjugate gradient solve with the compactly "
+                            "supported RBF failed. Please choose a different "
+                            "epsilon value.");
             }
         }
+        else
+        {
+            // Obtain B vector by calculating RBF.
+            Matrix* B = new Matrix(data.size(), data.size(), false);
+            for (int i = 0; i < B->numRows(); i++)
+            {
+                B->item(i, i) = 1.0;
+                for (int j = i + 1; j < B->numColumns(); j++)
+                {
+                    double res = obtainRBF(rbf, epsilon, parameter_points[i], parameter_points[j]);
+                    B->item(i, j) = res;
+                    B->item(j, i) = res;
+                }
+            }
 
-        char uplo = 'U';
-        int gamma_size = data.size();
-        int num_elements = data[0]->dim();
-        int info;
+            char uplo = 'U';
+            int gamma_size = data.size();
+            int num_elements = data[0]->dim();
+            int info;
 
-        dposv(&uplo, &gamma_size, &num_elements, B->getData(),  &gamma_size,
-              f_T->getData(), &gamma_size, &info);
-        if (info != 0)
-        {
-            std::cout << "Linear solve failed. Please choose a different epsilon value." <<
-                      std::endl;
-        }
-        CAROM_VERIFY(info == 0);
+            dposv(&uplo, &gamma_size, &num_elements, B->getData(),  &gamma_size,
+                  f_T->getData(), &gamma_size, &info);
+            if (info != 0)
+            {
+                std::cout << "Linear solve failed. Please choose a different epsilon value." <<
+                          std::endl;
+            }
+            CAROM_VERIFY(info == 0);
 
-        delete B;
+            delete B;
+        }
     }
 
     return f_T;
@@ -45,7 +45,8 @@ public:
      *                              to the reference point
      * @param[in] rbf               The RBF type ("G" == gaussian,
      *                             "IQ" == inverse quadratic, "IMQ" == inverse
-     *                              multiquadric)
+     *                              multiquadric, "W" == compactly supported
+     *                              Wendland C2)
      * @param[in] interp_method     The interpolation method type ("LS" == linear solve,
      *                             "IDW" == inverse distance weighting, "LP" == lagrangian polynomials)
      * @param[in] closest_rbf_val   The RBF parameter determines the width of influence.
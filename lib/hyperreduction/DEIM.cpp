@@ -12,15 +12,28 @@
 // rhs to be sampled for the interpolation of the rhs.
 
 #include "linalg/Matrix.h"
+#include "linalg/Vector.h"
 #include "Utilities.h"
 #include "mpi.h"
 #include <cmath>
 #include <vector>
-#include <map>
-#include <set>
 
 #include "DEIM.h"
 
+/* Use automatically detected Fortran name-mangling scheme */
+#define dgemv CAROM_FC_GLOBAL(dgemv, DGEMV)
+#define dgemm CAROM_FC_GLOBAL(dgemm, DGEMM)
+
+extern "C" {
+    // Matrix-matrix product.
+    void dgemm(char*, char*, int*, int*, int*, double*, double*, int*,
+               double*, int*, double*, double*, int*);
+
+    // Matrix-vector product.
+    void dgemv(char*, int*, int*, double*, double*, int*, double*, int*,
+               double*, double*, int*);
+}
+
 using namespace std;
 
 namespace CAROM {
@@ -39,44 +52,6 @@ DEIM(const Matrix* f_basis,
     // processor that owns each sampled row, and fills f_basis_sampled_inv with
     // the inverse of the sampled rows of the basis of the RHS.
 
-    // Create an MPI_Datatype for the RowInfo struct.
-    MPI_Datatype MaxRowType, oldtypes[2];
-    int blockcounts[2];
-    MPI_Aint offsets[2], extent, lower_bound;
-    MPI_Status stat;
-    offsets[0] = 0;
-    oldtypes[0] = MPI_DOUBLE;
-    blockcounts[0] = 1;
-
-    /*
-       MPI_Type_extent is deprecated in MPI-2 and removed in
-       MPI-3. MPI_Type_extent has been replaced by MPI_Type_get_extent.
-    */
-#if (MPI_VERSION == 1)
-    MPI_Type_extent(MPI_DOUBLE, &extent);
-#else
-    MPI_Type_get_extent(MPI_DOUBLE, &lower_bound, &extent);
-#endif
-
-    offsets[1] = extent;
-    oldtypes[1] = MPI_INT;
-    blockcounts[1] = 2;
-
-    /*
-      MPI_Type_struct is deprecated in MPI-2 and removed in
-      MPI-3. MPI_Type_struct has been replaced by MPI_Type_create_struct.
-     */
-#if (MPI_VERSION == 1)
-    MPI_Type_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#else
-    MPI_Type_create_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#endif
-    MPI_Type_commit(&MaxRowType);
-
-    // Create an MPI_Op for the RowInfoMax function.
-    MPI_Op RowInfoOp;
-    MPI_Op_create((MPI_User_function*)RowInfoMax, true, &RowInfoOp);
-
     // Get the number of basis vectors and the size of each basis vector.
     CAROM_VERIFY(0 < num_f_basis_vectors_used
                  && num_f_basis_vectors_used <= f_basis->numColumns());
@@ -88,138 +63,226 @@ DEIM(const Matrix* f_basis,
     CAROM_VERIFY(!f_basis_sampled_inv.distributed());
     int basis_size = f_basis->numRows();
 
-    // The small matrix inverted by the algorithm.  We'll allocate the largest
-    // matrix we'll need and set its size at each step in the algorithm.
-    Matrix M(num_basis_vectors, num_basis_vectors, false);
+    // The LU factorization of the sampled block, M = tmp_fs(0:i, 0:i), which
+    // gains a row and a column at each step. L is unit lower triangular and
+    // is stored below the diagonal, U on and above it.
+    Matrix LU(num_basis_vectors, num_basis_vectors, false);
 
     // Scratch space used throughout the algorithm.
     double* c = new double [num_basis_vectors];
+    double* u = new double [num_basis_vectors];
+    double* f_basis_mult_c = new double [std::max(basis_size, 1)];
+    int f_basis_lda = f_basis->numColumns();
 
-    vector<set<int> > proc_sampled_f_row(num_procs);
-    vector<map<int, int> > proc_f_row_to_tmp_fs_row(num_procs);
-    int num_f_basis_cols = f_basis_sampled_inv.numColumns();
-    Matrix tmp_fs(f_basis_sampled_inv.numRows(),
-                  num_f_basis_cols,
-                  f_basis_sampled_inv.distributed());
+    // The selected rows of the basis of the RHS, in the order they were
+    // selected, are tmp_fs.
+    GreedyRowSelector selector(f_basis, num_basis_vectors, num_basis_vectors,
+                               myid, num_procs);
+    const Matrix& tmp_fs = selector.getSampledBasis();
 
     // Figure out the 1st sampled row of the RHS.
-    RowInfo f_bv_max_local, f_bv_max_global;
-    f_bv_max_local.row_val = -1.0;
-    f_bv_max_local.proc = myid;
     for (int i = 0; i < basis_size; ++i) {
-        double f_bv_val = fabs(f_basis->item(i, 0));
-        if (f_bv_val > f_bv_max_local.row_val) {
-            f_bv_max_local.row_val = f_bv_val;
-            f_bv_max_local.row = i;
-        }
+        f_basis_mult_c[i] = fabs(f_basis->item(i, 0));
     }
-    MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                  MaxRowType, RowInfoOp, MPI_COMM_WORLD);
-
-    // Now get the first sampled row of the basis of the RHS.
-    if (f_bv_max_global.proc == myid) {
-        for (int j = 0; j < num_basis_vectors; ++j) {
-            c[j] = f_basis->item(f_bv_max_global.row, j);
-        }
-    }
-    MPI_Bcast(c, num_basis_vectors, MPI_DOUBLE,
-              f_bv_max_global.proc, MPI_COMM_WORLD);
-    // Now add the first sampled row of the basis of the RHS to tmp_fs.
-    for (int j = 0; j < num_basis_vectors; ++j) {
-        tmp_fs.item(0, j) = c[j];
-    }
-    proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-    proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] = 0;
+    selector.selectRows(f_basis_mult_c, 1);
 
     // Now repeat the process for the other sampled rows of the basis of the
     // RHS.
+    LU.item(0, 0) = tmp_fs.item(0, 0);
+    CAROM_VERIFY(LU.item(0, 0) != 0.0);
     for (int i = 1; i < num_basis_vectors; ++i) {
         // If we currently know about S sampled rows of the basis of the RHS then
-        // M contains the first S columns of those S sampled rows.
-        M.setSize(i, i);
+        // M contains the first S columns of those S sampled rows and LU holds
+        // its factorization. Compute c, the inverse of M times the next column
+        // of the sampled rows of the basis of the RHS, by solving L u = that
+        // column and then U c = u. u is also the new column of U.
         for (int row = 0; row < i; ++row) {
-            for (int col = 0; col < i; ++col) {
-                M.item(row, col) = tmp_fs.item(row, col);
+            double tmp = tmp_fs.item(row, i);
+            for (int col = 0; col < row; ++col) {
+                tmp -= LU.item(row, col)*u[col];
             }
+            u[row] = tmp;
         }
-
-        // Invert M.
-        M.inverse();
-
-        // Now compute c, the inverse of M times the next column of the sampled
-        // rows of the basis of the RHS.
-        for (int minv_row = 0; minv_row < i; ++minv_row) {
-            double tmp = 0.0;
-            for (int minv_col = 0; minv_col < i; ++minv_col) {
-                tmp += M.item(minv_row, minv_col)*tmp_fs.item(minv_col, i);
+        for (int row = i - 1; row >= 0; --row) {
+            double tmp = u[row];
+            for (int col = row + 1; col < i; ++col) {
+                tmp -= LU.item(row, col)*c[col];
             }
-            c[minv_row] = tmp;
+            c[row] = tmp/LU.item(row, row);
         }
 
         // Now figure out the next sampled row of the basis of f.
         // Compute the first S basis vectors of the RHS times c and find the
         // row of this product have the greatest absolute value.  This is the
         // next sampled row of the basis of f.
-        f_bv_max_local.row_val = -1.0;
-        f_bv_max_local.proc = myid;
+        if (basis_size > 0) {
+            // The row major basis is the column major transposed basis.
+            char trans = 'T';
+            int inc = 1;
+            double one = 1.0, zero = 0.0;
+            dgemv(&trans, &i, &basis_size, &one, f_basis->getData(),
+                  &f_basis_lda, c, &inc, &zero, f_basis_mult_c, &inc);
+        }
         for (int F_row = 0; F_row < basis_size; ++F_row) {
-            double tmp = 0.0;
-            for (int F_col = 0; F_col < i; ++F_col) {
-                tmp += f_basis->item(F_row, F_col)*c[F_col];
-            }
-            double r_val = fabs(f_basis->item(F_row, i) - tmp);
-            if (r_val > f_bv_max_local.row_val) {
-                f_bv_max_local.row_val = r_val;
-                f_bv_max_local.row = F_row;
-            }
+            f_basis_mult_c[F_row] = fabs(f_basis->item(F_row, i) -
+                                         f_basis_mult_c[F_row]);
         }
-        MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                      MaxRowType, RowInfoOp, MPI_COMM_WORLD);
+        selector.selectRows(f_basis_mult_c, 1);
 
-        // Now get the next sampled row of the basis of f.
-        if (f_bv_max_global.proc == myid) {
-            for (int j = 0; j < num_basis_vectors; ++j) {
-                c[j] = f_basis->item(f_bv_max_global.row, j);
+        // Extend the factorization with the new row, solving l^T U = the new
+        // row and setting the new diagonal entry of U to what remains of it.
+        for (int col = 0; col < i; ++col) {
+            double tmp = tmp_fs.item(i, col);
+            for (int k = 0; k < col; ++k) {
+                tmp -= LU.item(i, k)*LU.item(k, col);
             }
+            LU.item(i, col) = tmp/LU.item(col, col);
         }
-        MPI_Bcast(c, num_basis_vectors, MPI_DOUBLE,
-                  f_bv_max_global.proc, MPI_COMM_WORLD);
-        // Now add the ith sampled row of the basis of the RHS to tmp_fs.
-        for (int j = 0; j < num_basis_vectors; ++j) {
-            tmp_fs.item(i, j) = c[j];
+        double tmp = tmp_fs.item(i, i);
+        for (int k = 0; k < i; ++k) {
+            LU.item(k, i) = u[k];
+            tmp -= LU.item(i, k)*u[k];
         }
-        proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-        proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] = i;
+        // A zero pivot means the sampled rows of the basis are singular.
+        CAROM_VERIFY(tmp != 0.0);
+        LU.item(i, i) = tmp;
     }
 
     // Fill f_sampled_row, and f_sampled_rows_per_proc.  Unscramble tmp_fs into
     // f_basis_sampled_inv.
-    int idx = 0;
-    for (int i = 0; i < num_procs; ++i) {
-        set<int>& this_proc_sampled_f_row = proc_sampled_f_row[i];
-        map<int, int>& this_proc_f_row_to_tmp_fs_row =
-            proc_f_row_to_tmp_fs_row[i];
-        f_sampled_rows_per_proc[i] = this_proc_sampled_f_row.size();
-        for (set<int>::iterator j = this_proc_sampled_f_row.begin();
-                j != this_proc_sampled_f_row.end(); ++j) {
-            int this_f_row = *j;
-            f_sampled_row[idx] = this_f_row;
-            int tmp_fs_row = this_proc_f_row_to_tmp_fs_row[this_f_row];
-            for (int col = 0; col < num_f_basis_cols; ++col) {
-                f_basis_sampled_inv.item(idx, col) = tmp_fs.item(tmp_fs_row, col);
+    selector.getSampledRows(f_sampled_row.data(), f_sampled_rows_per_proc.data(),
+                            f_basis_sampled_inv);
+
+    // Now invert f_basis_sampled_inv.
+    f_basis_sampled_inv.inverse();
+
+    delete [] c;
+    delete [] u;
+    delete [] f_basis_mult_c;
+}
+
+double
+BlockDEIM(const Matrix* f_basis,
+          int num_f_basis_vectors_used,
+          std::vector<int>& f_sampled_row,
+          std::vector<int>& f_sampled_rows_per_proc,
+          Matrix& f_basis_sampled_inv,
+          int myid,
+          int num_procs,
+          int block_size)
+{
+    CAROM_VERIFY(num_procs == f_sampled_rows_per_proc.size());
+    CAROM_VERIFY(block_size > 0);
+    CAROM_VERIFY(0 < num_f_basis_vectors_used
+                 && num_f_basis_vectors_used <= f_basis->numColumns());
+    int num_basis_vectors = num_f_basis_vectors_used;
+    CAROM_VERIFY(num_basis_vectors == f_sampled_row.size());
+    CAROM_VERIFY(num_basis_vectors == f_basis_sampled_inv.numRows()
+                 && num_basis_vectors == f_basis_sampled_inv.numColumns());
+    CAROM_VERIFY(!f_basis_sampled_inv.distributed());
+    int basis_size = f_basis->numRows();
+    int f_basis_lda = f_basis->numColumns();
+    block_size = std::min(block_size, num_basis_vectors);
+
+    // The LU factorization of the sampled block, M = tmp_fs(0:s, 0:s), which
+    // gains a block of rows and columns at each round. L is unit lower
+    // triangular and is stored below the diagonal, U on and above it.
+    Matrix LU(num_basis_vectors, num_basis_vectors, false);
+
+    // The interpolation coefficients of the block, c = M^{-1} tmp_fs(0:s, J),
+    // and the residual of the block, both row major with a column per basis
+    // vector of the block J.
+    std::vector<double> c(num_basis_vectors*block_size);
+    std::vector<double> residual(std::max(basis_size, 1)*block_size);
+
+    GreedyRowSelector selector(f_basis, num_basis_vectors, num_basis_vectors,
+                               myid, num_procs);
+    const Matrix& tmp_fs = selector.getSampledBasis();
+
+    for (int s = 0; s < num_basis_vectors; s += block_size) {
+        int b = std::min(block_size, num_basis_vectors - s);
+
+        // Solve L u = tmp_fs(0:s, J), which is the new block of columns of U,
+        // and then U c = u.
+        for (int j = 0; j < b; ++j) {
+            for (int row = 0; row < s; ++row) {
+                double tmp = tmp_fs.item(row, s + j);
+                for (int col = 0; col < row; ++col) {
+                    tmp -= LU.item(row, col)*LU.item(col, s + j);
+                }
+                LU.item(row, s + j) = tmp;
+            }
+            for (int row = s - 1; row >= 0; --row) {
+                double tmp = LU.item(row, s + j);
+                for (int col = row + 1; col < s; ++col) {
+                    tmp -= LU.item(row, col)*c[col*b + j];
+                }
+                c[row*b + j] = tmp/LU.item(row, row);
+            }
+        }
+
+        // The residual is the block of basis vectors minus the first s basis
+        // vectors times c. The row major basis is the column major transposed
+        // basis, so the transposed residual is formed as c^T times the
+        // transposed basis.
+        for (int i = 0; i < basis_size; ++i) {
+            for (int j = 0; j < b; ++j) {
+                residual[i*b + j] = f_basis->item(i, s + j);
+            }
+        }
+        if (s > 0 && basis_size > 0) {
+            char trans = 'N';
+            double minus_one = -1.0, one = 1.0;
+            dgemm(&trans, &trans, &b, &basis_size, &s, &minus_one, c.data(), &b,
+                  f_basis->getData(), &f_basis_lda, &one, residual.data(), &b);
+        }
+        selector.selectPivotedRows(residual.data(), b, b);
+
+        // Extend the factorization with the new block of rows. Solve
+        // l^T U = the new rows for the block of L, and factor the Schur
+        // complement of M, which is the residual at the new rows. Its rows
+        // were selected as pivots in order, so it needs no pivoting.
+        for (int i = s; i < s + b; ++i) {
+            for (int col = 0; col < s; ++col) {
+                double tmp = tmp_fs.item(i, col);
+                for (int k = 0; k < col; ++k) {
+                    tmp -= LU.item(i, k)*LU.item(k, col);
+                }
+                LU.item(i, col) = tmp/LU.item(col, col);
+            }
+            for (int col = s; col < s + b; ++col) {
+                double tmp = tmp_fs.item(i, col);
+                for (int k = 0; k < s; ++k) {
+                    tmp -= LU.item(i, k)*LU.item(k, col);
+                }
+                LU.item(i, col) = tmp;
+            }
+        }
+        for (int j = s; j < s + b; ++j) {
+            // A zero pivot means the sampled rows of the basis are singular.
+            CAROM_VERIFY(LU.item(j, j) != 0.0);
+            for (int i = j + 1; i < s + b; ++i) {
+                LU.item(i, j) /= LU.item(j, j);
+                for (int col = j + 1; col < s + b; ++col) {
+                    LU.item(i, col) -= LU.item(i, j)*LU.item(j, col);
+                }
             }
-            ++idx;
         }
     }
 
+    // Fill f_sampled_row, and f_sampled_rows_per_proc.  Unscramble tmp_fs into
+    // f_basis_sampled_inv.
+    selector.getSampledRows(f_sampled_row.data(), f_sampled_rows_per_proc.data(),
+                            f_basis_sampled_inv);
+
     // Now invert f_basis_sampled_inv.
     f_basis_sampled_inv.inverse();
 
-    // Free the MPI_Datatype and MPI_Op.
-    MPI_Type_free(&MaxRowType);
-    MPI_Op_free(&RowInfoOp);
-
-    delete [] c;
+    // The error bound constant is the largest singular value of the inverse.
+    Matrix U, V;
+    Vector S;
+    SerialSVD(&f_basis_sampled_inv, &U, &S, &V);
+    return S(0);
 }
 
 }
@@ -49,6 +49,53 @@ DEIM(const Matrix* f_basis,
      int myid,
      int num_procs);
 
+/**
+ * @brief Computes the DEIM algorithm on the given basis, processing
+ *        block_size basis vectors per round.
+ *
+ * Each round forms the residual of the next block of basis vectors against
+ * their interpolation at the rows sampled so far with one matrix-matrix
+ * product and selects as many rows from that residual, so that the number of
+ * collective rounds is the number of blocks. Each process nominates rows by
+ * Gaussian elimination with partial pivoting on its own rows of the residual,
+ * and the nominees of all processes are eliminated again to select the rows.
+ *
+ * On one process this is Gaussian elimination with partial pivoting on the
+ * basis, as is DEIM, so every block_size selects the rows of DEIM. On several
+ * processes, a block_size of 1 still selects the rows of DEIM, but with a
+ * larger block_size the rows depend on the number of processes, since the
+ * nominees of a process need not include the global pivots. The returned
+ * error bound constant measures the quality of the selection.
+ *
+ * @param[in] f_basis The basis vectors for the RHS.
+ * @param[in] num_f_basis_vectors_used The number of basis vectors in f_basis
+ *                                     to use in the algorithm.
+ * @param[out] f_sampled_row The local row ids of each sampled row.  This will
+ *                           contain the sampled rows from all processors.  Use
+ *                           f_sampled_rows_per_proc to index into this array
+ *                           for the sampled rows from a specific processor.
+ * @param[out] f_sampled_rows_per_proc The number of sampled rows for each
+ *                                     processor.
+ * @param[out] f_basis_sampled_inv The inverse of the sampled basis of the RHS.
+ * @param[in] myid The rank of this process.
+ * @param[in] num_procs The total number of processes.
+ * @param[in] block_size The number of basis vectors processed per round.
+ *
+ * @return The constant ||(P^T U)^{-1}||_2 of the DEIM error bound
+ *         ||f - U (P^T U)^{-1} P^T f||_2 <=
+ *         ||(P^T U)^{-1}||_2 ||f - U U^T f||_2 for an orthonormal basis U,
+ *         where P selects the sampled rows.
+ */
+double
+BlockDEIM(const Matrix* f_basis,
+          int num_f_basis_vectors_used,
+          std::vector<int>& f_sampled_row,
+          std::vector<int>& f_sampled_rows_per_proc,
+          Matrix& f_basis_sampled_inv,
+          int myid,
+          int num_procs,
+          int block_size);
+
 }
 
 #endif
@@ -12,11 +12,11 @@
 // rhs to be sampled for the interpolation of the rhs.
 
 #include "linalg/Matrix.h"
+#include "Utilities.h"
 #include "mpi.h"
 #include <cmath>
 
 #include <vector>
-#include <set>
 #include <algorithm>
 
 namespace CAROM {
@@ -50,9 +50,6 @@ QDEIM(const Matrix* f_basis,
     const int numCol = f_basis->numColumns();
     const int num_samples_req_QR = numCol;
 
-    std::vector<double> sampled_row_data;
-    if (myid == 0) sampled_row_data.resize(num_samples_req * numCol);
-
     std::vector<int> f_sampled_row_owner((myid == 0
                                           && f_basis->distributed()) ? num_samples_req : 0);
 
@@ -64,14 +61,14 @@ QDEIM(const Matrix* f_basis,
 
     if (f_basis->distributed())
     {
-        // Gather the sampled rows to root process in sampled_row_data
+        // Tell each process which of its rows are sampled by QR.
 
         // On root, f_sampled_row contains all global pivots.
         // On non-root processes, it contains the local pivots.
 
         std::vector<int> ns((myid == 0) ? num_procs : 0);
         std::vector<int> disp((myid == 0) ? num_procs : 0);
-        std::vector<int> all_sampled_rows((myid == 0) ? num_samples_req : 0);
+        std::vector<int> all_sampled_rows((myid == 0) ? num_samples_req_QR : 0);
         if (myid == 0)
         {
             for (int r=0; r<num_procs; ++r)
@@ -87,10 +84,7 @@ QDEIM(const Matrix* f_basis,
             CAROM_VERIFY(disp[num_procs-1] + ns[num_procs-1] == num_samples_req_QR);
 
             for (int r=0; r<num_procs; ++r)
-            {
-                f_sampled_rows_per_proc[r] = ns[r];
                 ns[r] = 0;
-            }
 
             for (int i=0; i<num_samples_req_QR; ++i)
             {
@@ -98,31 +92,12 @@ QDEIM(const Matrix* f_basis,
                 all_sampled_rows[disp[owner] + ns[owner]] = f_sampled_row[i];
                 ns[owner]++;
             }
-
-            // Reorder f_sampled_row and f_sampled_row_owner to match the order of f_basis_sampled_inv
-            for (int i=0; i<num_samples_req_QR; ++i)
-                f_sampled_row[i] = all_sampled_rows[i];
-
-            int os = 0;
-            for (int r=0; r<num_procs; ++r)
-            {
-                for (int i=0; i<f_sampled_rows_per_proc[r]; ++i)
-                {
-                    f_sampled_row_owner[os + i] = r;
-                }
-
-                os += f_sampled_rows_per_proc[r];
-            }
         }
 
-        MPI_Bcast(f_sampled_rows_per_proc.data(), num_procs, MPI_INT, 0,
-                  MPI_COMM_WORLD);
-
         int count = 0;
         MPI_Scatter(ns.data(), 1, MPI_INT, &count, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
         std::vector<int> my_sampled_rows(count);
-        std::vector<double> my_sampled_row_data(count*numCol);
 
         MPI_Scatterv(all_sampled_rows.data(), ns.data(), disp.data(), MPI_INT,
                      my_sampled_rows.data(), count, MPI_INT, 0, MPI_COMM_WORLD);
@@ -142,115 +117,60 @@ QDEIM(const Matrix* f_basis,
 
         for (int i=0; i<count; ++i)
         {
-            const int msr = my_sampled_rows[i];
-            const bool mycond = my_sampled_rows[i] >= row_offset[myid]
-                                && my_sampled_rows[i] < row_offset[myid] + f_basis->numRows();
             CAROM_VERIFY(my_sampled_rows[i] >= row_offset[myid]
                          && my_sampled_rows[i] < row_offset[myid] + f_basis->numRows());
-            const int row = my_sampled_rows[i] - row_offset[myid];
-            os = i*numCol;
-            for (int j=0; j<numCol; ++j)
-                my_sampled_row_data[os + j] = f_basis->item(row, j);
+            my_sampled_rows[i] -= row_offset[myid];
         }
 
-        if (myid == 0)
-        {
-            for (int r=0; r<num_procs; ++r)
-            {
-                ns[r] *= numCol;
-                disp[r] *= numCol;
-            }
-        }
-
-        MPI_Gatherv(my_sampled_row_data.data(), count*numCol, MPI_DOUBLE,
-                    sampled_row_data.data(),
-                    ns.data(), disp.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        // The sampled rows of the basis, in the order they were sampled, are
+        // gathered on every process by the selector, starting with the rows
+        // sampled by QR.
+        GreedyRowSelector selector(f_basis, numCol, num_samples_req, myid,
+                                   num_procs);
+        selector.selectGivenRows(&my_sampled_rows);
+        const Matrix& sampled_rows = selector.getSampledBasis();
 
         const int nf = f_basis->numRows();
+        const int n = numCol;
+
+        // The remaining (num_samples_req - numCol) samples are set by
+        // GappyPOD+E, which needs the singular values and right singular
+        // vectors of the sampled rows. They are computed by every process.
+        // The SVD of the first s sampled rows, A = U diag(sigma) W^T, is
+        // updated for each new row a from the SVD of the (n+1)-by-n matrix
+        // [diag(sigma) W^T; a], which has the same singular values and
+        // right singular vectors as [A; a], so the cost of an update does
+        // not grow with the number of samples.
+        Matrix A(n, n, false);
+        Matrix U(n, n, false);
+        Matrix V(n, n, false);
+        Vector sigma(n, false);
 
-        std::vector<int> rcnt(num_procs);
-        std::vector<int> rdsp(num_procs);
-        MPI_Gather(&nf, 1, MPI_INT, rcnt.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
-
-        int nglobal = 0;
-        rdsp[0] = 0;
-        if (myid == 0)
-        {
-            for (int i=0; i<num_procs; ++i)
-                nglobal += rcnt[i];
-
-            for (int i=1; i<num_procs; ++i)
-                rdsp[i] = rdsp[i-1] + rcnt[i-1];
-        }
-
-        std::set<int> globalSamples;
-        if (myid == 0)
+        // Use lapack's dgesdd Fortran function to perform the SVD. As this is
+        // Fortran, A and all the computed matrices are in column major order.
+        for (int i=0; i<n; ++i)
         {
-            int count = 0;
-            for (int i=0; i<num_procs; ++i)
+            for (int j=0; j<n; ++j)
             {
-                for (int j=0; j<f_sampled_rows_per_proc[i]; ++j, ++count)
-                {
-                    globalSamples.insert(f_sampled_row[count]);
-                }
+                A.getData()[i + (j*n)] = sampled_rows.item(i, j);
             }
-
-            CAROM_VERIFY(count == numCol);
         }
+        SerialSVD(&A, &U, &sigma, &V);
 
-        std::vector<double> rg(myid == 0 ? nglobal : 0);
-        std::vector<int> isort(myid == 0 ? nglobal : 0);
-
-        int n = numCol;
-        Matrix V(n, n, false);
+        std::vector<double> r(std::max(nf, 1));
 
         for (int s = numCol; s < num_samples_req; ++s)  // Determine sample s
         {
-            int m = s;
-
-            double g = 0.0;
-            if (myid == 0)
-            {
-                // At this point, only the first (numCol) entries of f_sampled_row and rows of sampled_row_data are set by QR.
-                // Now set the remaining (num_samples_req - numCol) samples by GappyPOD+E.
-                Matrix A(m, n, false);
-
-                // Compute SVD of the first s rows of sampled_row_data locally on root
-                // Use lapack's dgesdd Fortran function to perform the SVD. As this is
-                // Fortran, A and all the computed matrices are in column major order.
-                for (int i=0; i<m; ++i)
-                {
-                    for (int j=0; j<n; ++j)
-                    {
-                        A.getData()[i + (j*m)] = sampled_row_data[(i*numCol) + j];
-                    }
-                }
-                Matrix* U = NULL;
-                Vector sigma(n, false);
-                SerialSVD(&A, U, &sigma, &V);
-                delete U;
-
-                g = (sigma.getData()[n-2] * sigma.getData()[n-2]) - (sigma.getData()[n-1] *
-                        sigma.getData()[n-1]);
-
-                // Note that V stores the right singular vectors row-wise
-
-                // Set Ubt = U * V = (V' * U')'
-                V.transpose();
-            }
-
-            MPI_Bcast(&g, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-
-            // Broadcast the small n-by-n undistributed matrix V which is computed only on root.
-            MPI_Bcast(V.getData(), n*n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            const double g = (sigma.item(n-2) * sigma.item(n-2)) -
+                             (sigma.item(n-1) * sigma.item(n-1));
 
+            // Note that V stores the right singular vectors column-wise, so
+            // that Ubt = U * V = (V' * U')'.
             Matrix *Ubt = f_basis->mult(V);  // distributed
 
             CAROM_VERIFY(Ubt->distributed() && Ubt->numRows() == f_basis->numRows()
                          && Ubt->numColumns() == n);
 
-            std::vector<double> r(nf);
-
             for (int i=0; i<nf; ++i)
             {
                 r[i] = g;
@@ -261,143 +181,31 @@ QDEIM(const Matrix* f_basis,
                 r[i] -= sqrt((r[i] * r[i]) - (4.0 * g * Ubt->item(i, n-1) * Ubt->item(i, n-1)));
             }
 
-            MPI_Gatherv(r.data(), nf, MPI_DOUBLE, rg.data(), rcnt.data(), rdsp.data(),
-                        MPI_DOUBLE, 0, MPI_COMM_WORLD);
-
-            int owner = -1;
-            if (myid == 0)
-            {
-                for (int i=0; i<nglobal; ++i)
-                {
-                    isort[i] = i;
-                }
-
-                std::sort(isort.begin(), isort.end(), [&](const int& a, const int& b) {
-                    return (rg[a] > rg[b]);
-                }
-                         );  // descending order
-
-                // Choose sample s as the first entry in isort not already in f_sampled_row
-                f_sampled_row[s] = -1;
-                for (int i=0; i<nglobal; ++i)
-                {
-                    std::set<int>::iterator it = globalSamples.find(isort[i]);
-                    if (it == globalSamples.end()) // not found
-                    {
-                        CAROM_VERIFY(i <= s && f_sampled_row[s] == -1);
-                        f_sampled_row[s] = isort[i];
-                        break;
-                    }
-                }
-
-                CAROM_VERIFY(f_sampled_row[s] >= 0);
-                for (int i=num_procs-1; i >= 0; --i)
-                {
-                    if (f_sampled_row[s] >= row_offset[i])
-                    {
-                        owner = i;
-                        break;
-                    }
-                }
-
-                CAROM_VERIFY(owner >= 0);
-                f_sampled_rows_per_proc[owner]++;
-                f_sampled_row_owner[s] = owner;
-
-                for (int i=0; i < num_procs; ++i)
-                    ns[i] = -1;
-
-                ns[owner] = f_sampled_row[s];
-                globalSamples.insert(f_sampled_row[s]);
-            }
-
-            // Send one row of f_basis, corresponding to sample s, to root process for f_basis_sampled_inv.
-            // First, scatter from root to tell the owning process the sample index.
-
-            int sample = -1;
-            MPI_Scatter(ns.data(), 1, MPI_INT, &sample, 1, MPI_INT, 0, MPI_COMM_WORLD);
-
-            const int tagSendRecv = 111;
-            if (sample > -1)
-            {
-                CAROM_VERIFY(sample >= row_offset[myid]);
-                MPI_Send(f_basis->getData() + ((sample - row_offset[myid]) * numCol), numCol,
-                         MPI_DOUBLE, 0, tagSendRecv, MPI_COMM_WORLD);
-            }
-
-            if (myid == 0)
-            {
-                MPI_Status status;
-                MPI_Recv(sampled_row_data.data() + (s*numCol), numCol, MPI_DOUBLE, owner,
-                         tagSendRecv, MPI_COMM_WORLD, &status);
-            }
-
             delete Ubt;
-        }  // loop s over samples
 
-        // Subtract row_offset to convert f_sampled_row from global to local indices
-        // Also, reorder f_sampled_row by process
-        if (myid == 0)
-        {
-            ns[0] = 0;
-            disp[0] = 0;
-            for (int r=1; r<num_procs; ++r)
-            {
-                ns[r] = 0;
-                disp[r] = disp[r-1] + f_sampled_rows_per_proc[r-1];
-            }
+            // Choose sample s as the unsampled row with the largest r over
+            // all processes.
+            selector.selectRows(r.data(), 1);
 
-            for (int i=0; i<num_samples_req; ++i)
-            {
-                const int owner = f_sampled_row_owner[i];
-                f_sampled_row[i] -= row_offset[owner];
-
-                all_sampled_rows[disp[owner] + ns[owner]] = i;
-                ns[owner]++;
-            }
-
-            std::vector<int> sortedRow(num_samples_req);
-
-            for (int r=0; r<num_procs; ++r)
+            if (s + 1 < num_samples_req)
             {
-                CAROM_VERIFY(ns[r] == f_sampled_rows_per_proc[r]);
-
-                // Sort the local indices of f_sampled_row for process r.
-                for (int i=0; i<ns[r]; ++i)
-                {
-                    isort[i] = i;
-                }
-
-                std::sort(isort.begin(), isort.begin() + ns[r], [&](const int& a,
-                const int& b) {
-                    return (f_sampled_row[all_sampled_rows[disp[r] + a]] <
-                            f_sampled_row[all_sampled_rows[disp[r] + b]]);
-                }
-                         );  // ascending order locally
-
-                for (int i=0; i<ns[r]; ++i)
+                A.setSize(n + 1, n);
+                for (int j=0; j<n; ++j)
                 {
-                    const int ig = all_sampled_rows[disp[r] + isort[i]];
-                    const int s = (disp[r] + i);
-                    // Put row ig of sampled_row_data into row s of f_basis_sampled_inv
-                    // Put entry ig of f_sampled_row into entry s of sortedRow
-
-                    for (int j=0; j<numCol; ++j)
+                    for (int i=0; i<n; ++i)
                     {
-                        f_basis_sampled_inv.item(s, j) = sampled_row_data[(ig*numCol) + j];
+                        A.getData()[i + (j*(n+1))] = sigma.item(i) * V.item(j, i);
                     }
-
-                    sortedRow[s] = f_sampled_row[ig];
+                    A.getData()[n + (j*(n+1))] = sampled_rows.item(s, j);
                 }
+                SerialSVD(&A, &U, &sigma, &V);
             }
+        }  // loop s over samples
 
-            for (int i=0; i<num_samples_req; ++i)
-                f_sampled_row[i] = sortedRow[i];
-        }
-
-        MPI_Bcast(f_sampled_row.data(), num_samples_req, MPI_INT, 0, MPI_COMM_WORLD);
-        MPI_Bcast(f_sampled_rows_per_proc.data(), num_procs, MPI_INT, 0,
-                  MPI_COMM_WORLD);
+        // Fill f_sampled_row, and f_sampled_rows_per_proc, and the sampled
+        // rows of f_basis_sampled_inv, ordered by process and by local row.
+        selector.getSampledRows(f_sampled_row.data(), f_sampled_rows_per_proc.data(),
+                                f_basis_sampled_inv);
     }
     else
     {
@@ -12,8 +12,8 @@
 #include "Utilities.h"
 #include "mpi.h"
 #include <cmath>
-#include <map>
 #include <set>
+#include <vector>
 
 #include "STSampling.h"
 
@@ -21,6 +21,80 @@ using namespace std;
 
 namespace CAROM {
 
+namespace {
+
+// The space-time basis vectors are \phi_j(s,t) = s_basis(s,j) t_basis(t,j),
+// so the inner product of \phi_j and \phi_l over the space-time indices S x T
+// is the product of the inner products of the spatial basis vectors over S
+// and of the temporal basis vectors over T. The algorithms below form the
+// least-squares problems and the error norms from these small Gramians
+// instead of the space-time error vector and the sampled space-time basis.
+
+// Adds the outer product of the first num_cols entries of a row of the basis
+// to the Gramian.
+void AddToGramian(const Matrix* basis, int row, int num_cols,
+                  Matrix& gramian)
+{
+    for (int j = 0; j < num_cols; ++j)
+    {
+        const double basis_j = basis->item(row, j);
+        for (int l = 0; l < num_cols; ++l)
+            gramian.item(j, l) += basis_j * basis->item(row, l);
+    }
+}
+
+// Computes the coefficients c of the least-squares approximation of \phi_i by
+// [\phi_0, ..., \phi_{i-1}] over S x T, from the Gramians of the spatial basis
+// over S and of the temporal basis over T. These are the normal equations
+// that Matrix::transposePseudoinverse solves for the sampled space-time
+// basis, whose Gramian is the entrywise product of the two Gramians. Like
+// Matrix::transposePseudoinverse, it requires the sampled space-time basis,
+// with num_sampled_rows = |S| |T| rows, to have at least i rows.
+void SolveSampledLeastSquares(const Matrix& s_gramian, const Matrix& t_gramian,
+                              const int i, const int num_sampled_rows,
+                              Matrix& normal, std::vector<double>& c)
+{
+    CAROM_VERIFY(num_sampled_rows >= i);
+    normal.setSize(i, i);
+    for (int j = 0; j < i; ++j)
+    {
+        for (int l = 0; l < i; ++l)
+            normal.item(j, l) = s_gramian.item(j, l) * t_gramian.item(j, l);
+    }
+    normal.inverse();
+
+    for (int j = 0; j < i; ++j)
+    {
+        c[j] = 0.0;
+        for (int l = 0; l < i; ++l)
+            c[j] += normal.item(j, l) * s_gramian.item(l, i) * t_gramian.item(l, i);
+    }
+}
+
+// Returns the squared l2 norm over a set of indices of one dimension of the
+// error \phi_i - \sum_{j<i} c_j \phi_j at a fixed index of the other
+// dimension. The basis of the fixed dimension has the values basis_row there,
+// and gramian is the Gramian of the other basis over the set.
+double ErrorNorm2(const double* basis_row, const std::vector<double>& c,
+                  const Matrix& gramian, const int i, std::vector<double>& a)
+{
+    for (int j = 0; j < i; ++j)
+        a[j] = -c[j] * basis_row[j];
+    a[i] = basis_row[i];
+
+    double norm2 = 0.0;
+    for (int j = 0; j <= i; ++j)
+    {
+        double tmp = 0.0;
+        for (int l = 0; l <= i; ++l)
+            tmp += gramian.item(j, l) * a[l];
+        norm2 += a[j] * tmp;
+    }
+    return norm2;
+}
+
+}
+
 // This function implements Algorithm 2 of Choi and Carlberg 2019.
 // All spatial indices are used here.
 // Spatial basis s_basis is distributed, of size (number of spatial DOFs) x (number of basis vectors)
@@ -36,7 +110,8 @@ void SampleTemporalIndices(const Matrix* s_basis,
                            const int num_samples_req,
                            const bool excludeFinalTime)
 {
-    CAROM_VERIFY(t_basis->distributed());
+    // Every process reads all temporal rows.
+    CAROM_VERIFY(!t_basis->distributed());
 
     // Get the number of basis vectors and the size of each basis vector.
     CAROM_VERIFY(0 < num_f_basis_vectors_used
@@ -50,101 +125,56 @@ void SampleTemporalIndices(const Matrix* s_basis,
     CAROM_VERIFY(num_samples <= t_basis->numRows() - numExcluded);
     const int s_size = s_basis->numRows();
     const int t_size = t_basis->numRows();
+    const int t_lda = t_basis->numColumns();
 
     const int ns_mod_nr = num_samples % num_basis_vectors;
     int ns = 0;
 
-    // The small matrix inverted by the algorithm.  We'll allocate the largest
-    // matrix we'll need and set its size at each step in the algorithm.
-    Matrix M(num_basis_vectors, num_basis_vectors,
-             false);  // TODO: is this big enough to avoid reallocations?
+    // The Gramian of the spatial basis over all spatial indices, which is
+    // the only quantity reduced over the processes, and the Gramian of the
+    // temporal basis over the temporal samples.
+    Matrix s_gramian(num_basis_vectors, num_basis_vectors, false);
+    Matrix t_sampled_gramian(num_basis_vectors, num_basis_vectors, false);
+    s_gramian = 0.0;
+    t_sampled_gramian = 0.0;
+    for (int s = 0; s < s_size; ++s)
+        AddToGramian(s_basis, s, num_basis_vectors, s_gramian);
+    if (s_basis->distributed() && num_procs > 1)
+    {
+        MPI_Allreduce(MPI_IN_PLACE, s_gramian.getData(),
+                      num_basis_vectors * num_basis_vectors, MPI_DOUBLE, MPI_SUM,
+                      MPI_COMM_WORLD);
+    }
+
+    // The normal matrix of the least-squares problem, inverted in place.
+    Matrix normal(num_basis_vectors, num_basis_vectors, false);
 
     std::set<int> samples;  // Temporal samples, identical on all processes
 
-    std::vector<double> error(s_size * t_size);
-    std::vector<double> MZphi(num_basis_vectors);
-
-    // Initialize error as the first space-time basis vector
-    for (int s=0; s<s_size; ++s)
-    {
-        for (int t=0; t<t_size; ++t)
-            error[t + (s*t_size)] = s_basis->item(s, 0) * t_basis->item(t, 0);
-    }
+    std::vector<double> c(num_basis_vectors);
+    std::vector<double> a(num_basis_vectors);
+    std::vector<double> errorNorm2(t_size);
 
     for (int i=0; i<num_basis_vectors; ++i)
     {
         CAROM_VERIFY(samples.size() == ns);
         if (i > 0)
         {
-            // Set error vector to (I - [\phi_0, ..., \phi_{i-1}] (Z [\phi_0, ..., \phi_{i-1}])^+ Z) \phi_i
-            // where \phi_j is the j-th space-time basis vector (tensor product of columns j of s_basis and t_basis).
-
-            // First, set M to Z [\phi_0, ..., \phi_{i-1}], where Z selects all spatial indices and the temporal indices in `samples`
-            M.setSize(ns * s_size, i);
-
-            int ti = 0;
-            for (auto t : samples) // loop over ns values
-            {
-                for (int s = 0; s < s_size; ++s)
-                {
-                    const int row = ti + (s*ns);
-                    for (int col = 0; col < i; ++col)
-                    {
-                        M.item(row, col) = s_basis->item(s, col) * t_basis->item(t, col);
-                    }
-                }
-
-                ti++;
-            }
-
-            // Compute the pseudo-inverse of M, storing its transpose.
-            M.transposePseudoinverse();
-
-            // TODO: in parallel, it seems this matrix should be distributed, and the pseudo-inverse needs to be computed in parallel.
-            // In DEIM and GNAT, we gather the non-local rows that have been sampled, but here we use all spatial rows, so this will be
-            // more expensive. Fortunately, the matrix to be inverted in the pseudo-inverse computation will still be small.
-            // Hopefully M just needs to be declared as `distributed`.
-
-            // Multiply Z\phi_i by the transpose of M, which is (Z [\phi_0, ..., \phi_{i-1}])^+.
-            // The result is a vector of length i, stored in MZphi.
-            for (int j = 0; j < i; ++j) MZphi[j] = 0.0;
-
-            ti = 0;
-            for (auto t : samples) // loop over ns values
-            {
-                for (int s = 0; s < s_size; ++s)
-                {
-                    const int row = ti + (s*ns);
-                    const double phi_i_s_t = s_basis->item(s, i) * t_basis->item(t,
-                                             i);  // \phi_i(s,t)
-
-                    for (int col = 0; col < i; ++col)
-                    {
-                        MZphi[col] += M.item(row, col) * phi_i_s_t;
-                    }
-                }
-
-                ti++;
-            }
-
-            // Initialize error as space-time basis vector i
-            for (int s=0; s<s_size; ++s)
-            {
-                for (int t=0; t<t_size; ++t)
-                    error[t + (s*t_size)] = s_basis->item(s, i) * t_basis->item(t, i);
-            }
-
-            // Multiply MZphi by [\phi_0, ..., \phi_{i-1}], subtracting the result from error
-            for (int s=0; s<s_size; ++s)
-            {
-                for (int t=0; t<t_size; ++t)
-                {
-                    for (int j=0; j<i; ++j)
-                        error[t + (s*t_size)] -= MZphi[j] * s_basis->item(s, j) * t_basis->item(t, j);
-                }
-            }
+            // The error vector is (I - [\phi_0, ..., \phi_{i-1}] (Z [\phi_0, ..., \phi_{i-1}])^+ Z) \phi_i
+            // where \phi_j is the j-th space-time basis vector (tensor product of columns j of s_basis and t_basis)
+            // and Z selects all spatial indices and the temporal indices in `samples`.
+            // Its coefficients c are the least-squares solution for Z \phi_i.
+            SolveSampledLeastSquares(s_gramian, t_sampled_gramian, i,
+                                     ns * s_basis->numDistributedRows(), normal,
+                                     c);
+        }
 
-            // Now error is set.
+        // The l2 spatial error norm of each temporal index, identical on all
+        // processes.
+        for (int t=0; t<t_size - numExcluded; ++t)
+        {
+            errorNorm2[t] = ErrorNorm2(t_basis->getData() + t * t_lda, c,
+                                       s_gramian, i, a);
         }
 
         const int nsi = i < ns_mod_nr ? (num_samples / num_basis_vectors) + 1 :
@@ -162,23 +192,15 @@ void SampleTemporalIndices(const Matrix* s_basis,
                 if (found != samples.end())
                     continue;
 
-                double norm2 = 0.0;
-                for (int s=0; s<s_size; ++s)
-                {
-                    norm2 += error[t + (s*t_size)] * error[t + (s*t_size)];
-                }
-
-                // TODO: this Allreduce is expensive for every t. Can this be improved?
-                double globalNorm2 = 0.0;
-                MPI_Allreduce(&norm2, &globalNorm2, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-                if (globalNorm2 > maxNorm)
+                if (errorNorm2[t] > maxNorm)
                 {
-                    maxNorm = globalNorm2;
+                    maxNorm = errorNorm2[t];
                     tmax = t;
                 }
             }
 
             samples.insert(tmax);
+            AddToGramian(t_basis, tmax, num_basis_vectors, t_sampled_gramian);
         }
 
         ns += nsi;
@@ -216,48 +238,7 @@ void SampleSpatialIndices(const Matrix* s_basis,
     // processor that owns each sampled row, and fills f_basis_sampled with
     // the sampled rows of the basis of the RHS.
 
-    // Create an MPI_Datatype for the RowInfo struct.
-    MPI_Datatype MaxRowType, oldtypes[2];
-    int blockcounts[2];
-    MPI_Aint offsets[2], extent, lower_bound;
-    MPI_Status stat;
-    offsets[0] = 0;
-    oldtypes[0] = MPI_DOUBLE;
-    blockcounts[0] = 1;
-
-    /*
-        MPI_Type_extent is deprecated in MPI-2 and removed in
-        MPI-3. MPI_Type_extent has been replaced by MPI_Type_get_extent.
-    */
-
-#if (MPI_VERSION == 1)
-    MPI_Type_extent(MPI_DOUBLE, &extent);
-#else
-    MPI_Type_get_extent(MPI_DOUBLE, &lower_bound, &extent);
-#endif
-
-    offsets[1] = extent;
-    oldtypes[1] = MPI_INT;
-    blockcounts[1] = 2;
-
-    /*
-      MPI_Type_struct is deprecated in MPI-2 and removed in
-      MPI-3. MPI_Type_struct has been replaced by MPI_Type_create_struct.
-     */
-
-#if (MPI_VERSION == 1)
-    MPI_Type_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#else
-    MPI_Type_create_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#endif
-
-    MPI_Type_commit(&MaxRowType);
-
-    // Create an MPI_Op for the RowInfoMax function.
-    MPI_Op RowInfoOp;
-    MPI_Op_create((MPI_User_function*)RowInfoMax, true, &RowInfoOp);
-
-    //CAROM_VERIFY(!t_basis->distributed());
+    CAROM_VERIFY(!t_basis->distributed());
 
     // Get the number of basis vectors and the size of each basis vector.
     CAROM_VERIFY(0 < num_f_basis_vectors_used
@@ -276,205 +257,67 @@ void SampleSpatialIndices(const Matrix* s_basis,
     CAROM_VERIFY(!f_basis_sampled.distributed());
     const int s_size = s_basis->numRows();
     const int t_size = t_basis->numRows();
+    const int s_lda = s_basis->numColumns();
 
     const int ns_mod_nr = num_samples % num_basis_vectors;
     int ns = 0;
 
-    // The small matrix inverted by the algorithm.  We'll allocate the largest
-    // matrix we'll need and set its size at each step in the algorithm.
-    Matrix M(num_basis_vectors, num_basis_vectors,
-             false);  // TODO: is this big enough to avoid reallocations?
-
-    // TODO: change these variable names
-    std::vector<std::set<int> > proc_sampled_f_row(num_procs);
-    std::vector<std::map<int, int> > proc_f_row_to_tmp_fs_row(num_procs);
-    int num_f_basis_cols =
-        f_basis_sampled.numColumns(); // TODO: just use num_basis_vectors
-    Matrix tmp_fs(f_basis_sampled.numRows(),
-                  num_f_basis_cols,
-                  f_basis_sampled.distributed()); // TODO: should this be distributed?
-
-    // TODO: change these variable names
-    RowInfo f_bv_max_local, f_bv_max_global;
-
-    std::vector<double> error(s_size * t_size);
-    std::vector<double> MZphi(num_basis_vectors);
-    std::vector<double> sampled_row(num_basis_vectors);
-
-    // Initialize error as the first space-time basis vector
-    for (int s=0; s<s_size; ++s)
-    {
-        for (int t=0; t<t_size; ++t)
-            error[t + (s*t_size)] = s_basis->item(s, 0) * t_basis->item(t, 0);
-    }
+    // The sampled rows of the spatial basis, in the order they were sampled,
+    // are tmp_fs. They are identical on all processes, so no quantity below
+    // is reduced over the processes.
+    GreedyRowSelector selector(s_basis, num_basis_vectors, num_samples, myid,
+                               num_procs);
+    const Matrix& tmp_fs = selector.getSampledBasis();
+
+    // The Gramians of the temporal basis over all temporal indices and over
+    // the temporal samples, and of the spatial basis over the spatial
+    // samples.
+    Matrix t_gramian(num_basis_vectors, num_basis_vectors, false);
+    Matrix t_sampled_gramian(num_basis_vectors, num_basis_vectors, false);
+    Matrix s_sampled_gramian(num_basis_vectors, num_basis_vectors, false);
+    t_gramian = 0.0;
+    t_sampled_gramian = 0.0;
+    s_sampled_gramian = 0.0;
+    for (int t = 0; t < t_size; ++t)
+        AddToGramian(t_basis, t, num_basis_vectors, t_gramian);
+    for (int ti = 0; ti < num_t_samples; ++ti)
+        AddToGramian(t_basis, t_samples[ti], num_basis_vectors, t_sampled_gramian);
+
+    // The normal matrix of the least-squares problem, inverted in place.
+    Matrix normal(num_basis_vectors, num_basis_vectors, false);
+
+    std::vector<double> c(num_basis_vectors);
+    std::vector<double> a(num_basis_vectors);
+    std::vector<double> errorNorm2(std::max(s_size, 1));
 
     for (int i=0; i<num_basis_vectors; ++i)
     {
         if (i > 0)
         {
-            // Set error vector to (I - [\phi_0, ..., \phi_{i-1}] (Z [\phi_0, ..., \phi_{i-1}])^+ Z) \phi_i
-            // where \phi_j is the j-th space-time basis vector (tensor product of columns j of s_basis and t_basis).
-
-            // First, set M to Z [\phi_0, ..., \phi_{i-1}], where Z selects spatial indices in `samples` and the temporal indices in `t_samples`
-
-            /* // Distributed version: should this be used?
-            M.setSize(proc_sampled_f_row[myid].size() * num_t_samples, i);
-
-            int si = 0;
-            for (auto s : proc_sampled_f_row[myid]) // loop over local spatial sample indices
-              {
-                for (int ti = 0; ti < num_t_samples; ++ti)
-            {
-              const int t = t_samples[ti];
-              const int row = ti + (si*num_t_samples);
-              for (int col = 0; col < i; ++col)
-                {
-                  M.item(row, col) = s_basis->item(s, col) * t_basis->item(t, col);
-                }
-            }
-
-                si++;
-              }
-            */
-
-            // Set M to be the global sampled matrix and invert on each process.
-            M.setSize(ns * num_t_samples, i);
-            for (int k = 0; k < i; ++k)
-                for (int j = 0; j < ns; ++j)
-                {
-                    for (int ti = 0; ti < num_t_samples; ++ti)
-                    {
-                        const int t = t_samples[ti];
-                        const int row = ti + (j*num_t_samples);
-
-                        M.item(row, k) = tmp_fs.item(j, k) * t_basis->item(t, k);
-                    }
-                }
-
-            // Compute the pseudo-inverse of M, storing its transpose.
-            M.transposePseudoinverse();
-
-            // Multiply Z\phi_i by the transpose of M, which is (Z [\phi_0, ..., \phi_{i-1}])^+.
-            // The result is a vector of length i, stored in MZphi.
-            for (int j = 0; j < i; ++j) MZphi[j] = 0.0;
-
-            /*
-            // Distributed version: should this be used?
-
-            // TODO: in parallel, it seems this matrix should be distributed, and the pseudo-inverse needs to be computed in parallel.
-            // In DEIM and GNAT, we gather the non-local spatial rows that have been sampled. This is so far just a serial implementation.
-
-            si = 0;
-            for (auto s : proc_sampled_f_row[myid]) // loop over local spatial sample indices
-              {
-                for (int ti = 0; ti < num_t_samples; ++ti)
-            {
-              const int t = t_samples[ti];
-              const int row = ti + (si*num_t_samples);
-              const double phi_i_s_t = s_basis->item(s, i) * t_basis->item(t, i);  // \phi_i(s,t)
-              for (int col = 0; col < i; ++col)
-                {
-                  MZphi[col] += M.item(row, col) * phi_i_s_t;
-                }
-            }
-
-                si++;
-              }
-
-            CAROM_VERIFY(si * num_t_samples == M.numRows());
-            */
-
-            for (int j = 0; j < ns; ++j)
-            {
-                for (int ti = 0; ti < num_t_samples; ++ti)
-                {
-                    const int t = t_samples[ti];
-                    const int row = ti + (j*num_t_samples);
-
-                    const double phi_i_s_t = s_basis->item(j, i) * t_basis->item(t,
-                                             i);  // \phi_i(s,t)
-
-                    for (int k = 0; k < i; ++k)
-                        MZphi[k] += M.item(row, k) * phi_i_s_t;
-                }
-            }
-
-            // Initialize error as space-time basis vector i
-            for (int s=0; s<s_size; ++s)
-            {
-                for (int t=0; t<t_size; ++t)
-                    error[t + (s*t_size)] = s_basis->item(s, i) * t_basis->item(t, i);
-            }
-
-            // Multiply MZphi by [\phi_0, ..., \phi_{i-1}], subtracting the result from error
-            for (int s=0; s<s_size; ++s)
-            {
-                for (int t=0; t<t_size; ++t)
-                {
-                    for (int j=0; j<i; ++j)
-                        error[t + (s*t_size)] -= MZphi[j] * s_basis->item(s, j) * t_basis->item(t, j);
-                }
-            }
-
-            // Now error is set.
+            // The error vector is (I - [\phi_0, ..., \phi_{i-1}] (Z [\phi_0, ..., \phi_{i-1}])^+ Z) \phi_i
+            // where \phi_j is the j-th space-time basis vector (tensor product of columns j of s_basis and t_basis)
+            // and Z selects spatial indices in `samples` and the temporal indices in `t_samples`.
+            // Its coefficients c are the least-squares solution for Z \phi_i.
+            SolveSampledLeastSquares(s_sampled_gramian, t_sampled_gramian, i,
+                                     ns * num_t_samples, normal, c);
         }
 
         const int nsi = i < ns_mod_nr ? (num_samples / num_basis_vectors) + 1 :
                         num_samples / num_basis_vectors;
 
-        for (int j=0; j<nsi; ++j)
+        // The spatial indices not sampled yet that have the maximum l2
+        // temporal error norms are the next nsi samples, which are all
+        // selected at once.
+        for (int s=0; s<s_size; ++s)
         {
-            // Find the spatial index not sampled yet that has the maximum l2 temporal error norm.
-            // First find the process-local maximum.
-
-            double maxNorm = -1.0;
-            int smax = 0;
-            for (int s=0; s<s_size; ++s)
-            {
-                std::set<int>::const_iterator found = proc_sampled_f_row[myid].find(s);
-                if (found != proc_sampled_f_row[myid].end())
-                    continue;
-
-                double norm2 = 0.0;
-                for (int t=0; t<t_size; ++t)
-                {
-                    norm2 += error[t + (s*t_size)] * error[t + (s*t_size)];
-                }
-
-                if (norm2 > maxNorm)
-                {
-                    maxNorm = norm2;
-                    smax = s;
-                }
-            }
-
-            // The local maximum with respect spatial indices is (maxNorm, smax).
-            // Now find the global maximum.
-            //RowInfo f_bv_max_local, f_bv_max_global;
-            f_bv_max_local.row_val = maxNorm;
-            f_bv_max_local.row = smax;
-            f_bv_max_local.proc = myid;
-
-            MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                          MaxRowType, RowInfoOp, MPI_COMM_WORLD);
-
-            proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-            proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] = ns + j;
-
-            // Now get the sampled row of the spatial basis.
-            if (f_bv_max_global.proc == myid) {
-                for (int k = 0; k < num_basis_vectors; ++k) {
-                    sampled_row[k] = s_basis->item(f_bv_max_global.row, k);
-                }
-            }
-            MPI_Bcast(sampled_row.data(), num_basis_vectors, MPI_DOUBLE,
-                      f_bv_max_global.proc, MPI_COMM_WORLD);
-            // Now add the sampled row of the basis to tmp_fs.
-            for (int k = 0; k < num_basis_vectors; ++k) {
-                tmp_fs.item(ns+j, k) = sampled_row[k];
-            }
+            errorNorm2[s] = ErrorNorm2(s_basis->getData() + s * s_lda, c, t_gramian,
+                                       i, a);
         }
 
+        selector.selectRows(errorNorm2.data(), nsi);
+        for (int j = ns; j < ns + nsi; ++j)
+            AddToGramian(&tmp_fs, j, num_basis_vectors, s_sampled_gramian);
+
         ns += nsi;
     }
 
@@ -482,29 +325,8 @@ void SampleSpatialIndices(const Matrix* s_basis,
 
     // Fill f_sampled_row, and f_sampled_rows_per_proc.  Unscramble tmp_fs into
     // f_basis_sampled.
-    int idx = 0;
-    for (int i = 0; i < num_procs; ++i) {
-        std::set<int>& this_proc_sampled_f_row = proc_sampled_f_row[i];
-        std::map<int, int>& this_proc_f_row_to_tmp_fs_row =
-            proc_f_row_to_tmp_fs_row[i];
-        s_sampled_rows_per_proc[i] = this_proc_sampled_f_row.size();
-        for (std::set<int>::iterator j = this_proc_sampled_f_row.begin();
-                j != this_proc_sampled_f_row.end(); ++j) {
-            int this_f_row = *j;
-            s_sampled_row[idx] = this_f_row;
-            int tmp_fs_row = this_proc_f_row_to_tmp_fs_row[this_f_row];
-            for (int col = 0; col < num_f_basis_cols; ++col) {
-                f_basis_sampled.item(idx, col) = tmp_fs.item(tmp_fs_row, col);
-            }
-            ++idx;
-        }
-    }
-
-    CAROM_VERIFY(num_samples == idx);
-
-    // Free the MPI_Datatype and MPI_Op.
-    MPI_Type_free(&MaxRowType);
-    MPI_Op_free(&RowInfoOp);
+    selector.getSampledRows(s_sampled_row, s_sampled_rows_per_proc,
+                            f_basis_sampled);
 }
 
 void SpaceTimeSampling(const Matrix* s_basis,
@@ -557,24 +379,70 @@ void GetSampledSpaceTimeBasis(std::vector<int> const& t_samples,
     const int num_s_samples = s_basis_sampled.numRows();
     const int num_t_samples = t_samples.size();
 
-    // Set sampled space-time basis matrix and take its pseudo-inverse, in f_basis_sampled_inv.
+    // Set the transposed pseudo-inverse of the sampled space-time basis in
+    // f_basis_sampled_inv.
 
     CAROM_VERIFY(f_basis_sampled_inv.numRows() == num_t_samples * num_s_samples);
+    const int num_basis_vectors = f_basis_sampled_inv.numColumns();
 
+    if (num_t_samples * num_s_samples == num_basis_vectors)
+    {
+        // A square sampled basis is inverted directly.
+        for (int si=0; si<num_s_samples; ++si)
+        {
+            for (int ti=0; ti<num_t_samples; ++ti)
+            {
+                const int row = ti + (si*num_t_samples);
+                const int t = t_samples[ti];
+                for (int j=0; j<num_basis_vectors; ++j)
+                    f_basis_sampled_inv.item(row, j) = s_basis_sampled.item(si,
+                                                       j) * t_basis->item(t, j);
+            }
+        }
+        f_basis_sampled_inv.transposePseudoinverse();
+        return;
+    }
+
+    // Otherwise row (si, ti) of the result is the inverse of the Gramian of
+    // the sampled space-time basis times row (si, ti) of that basis, as in
+    // Matrix::transposePseudoinverse. The Gramian is formed from the Gramians
+    // of the sampled spatial and temporal bases.
+    Matrix s_sampled_gramian(num_basis_vectors, num_basis_vectors, false);
+    Matrix t_sampled_gramian(num_basis_vectors, num_basis_vectors, false);
+    s_sampled_gramian = 0.0;
+    t_sampled_gramian = 0.0;
+    for (int si=0; si<num_s_samples; ++si)
+        AddToGramian(&s_basis_sampled, si, num_basis_vectors, s_sampled_gramian);
+    for (int ti=0; ti<num_t_samples; ++ti)
+        AddToGramian(t_basis, t_samples[ti], num_basis_vectors, t_sampled_gramian);
+
+    Matrix AtA(num_basis_vectors, num_basis_vectors, false);
+    for (int j=0; j<num_basis_vectors; ++j)
+    {
+        for (int l=0; l<num_basis_vectors; ++l)
+            AtA.item(j, l) = s_sampled_gramian.item(j, l) * t_sampled_gramian.item(j, l);
+    }
+    AtA.inverse();
+
+    std::vector<double> phi(num_basis_vectors);
     for (int si=0; si<num_s_samples; ++si)
     {
         for (int ti=0; ti<num_t_samples; ++ti)
         {
             const int row = ti + (si*num_t_samples);
             const int t = t_samples[ti];
-            for (int j=0; j<f_basis_sampled_inv.numColumns(); ++j)
-                f_basis_sampled_inv.item(row, j) = s_basis_sampled.item(si,
-                                                   j) * t_basis->item(t, j);
+            for (int j=0; j<num_basis_vectors; ++j)
+                phi[j] = s_basis_sampled.item(si, j) * t_basis->item(t, j);
+
+            for (int j=0; j<num_basis_vectors; ++j)
+            {
+                double tmp = 0.0;
+                for (int l=0; l<num_basis_vectors; ++l)
+                    tmp += AtA.item(j, l) * phi[l];
+                f_basis_sampled_inv.item(row, j) = tmp;
+            }
         }
     }
-
-    // Compute the pseudo-inverse of f_basis_sampled_inv, storing its transpose.
-    f_basis_sampled_inv.transposePseudoinverse();
 }
 
 }
@@ -19,7 +19,8 @@ namespace CAROM {
  * @brief
  *
  * @param[in] s_basis The spatial basis vectors.
- * @param[in] t_basis The temporal basis vectors.
+ * @param[in] t_basis The temporal basis vectors, which are not distributed
+ *                    and are identical on all processes.
  * @param[in] num_f_basis_vectors_used The number of basis vectors in f_basis
  *                                     to use in the algorithm.
  * @param[out] t_samples Array of temporal samples.
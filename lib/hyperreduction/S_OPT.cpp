@@ -14,14 +14,21 @@
 #include "linalg/Matrix.h"
 #include "Utilities.h"
 #include "mpi.h"
+#include <algorithm>
 #include <cmath>
 #include <vector>
-#include <map>
-#include <set>
-#include <cfloat>
 
 #include "S_OPT.h"
 
+/* Use automatically detected Fortran name-mangling scheme */
+#define dgemm CAROM_FC_GLOBAL(dgemm, DGEMM)
+
+extern "C" {
+    // Matrix-matrix product.
+    void dgemm(char*, char*, int*, int*, int*, double*, double*, int*,
+               double*, int*, double*, double*, int*);
+}
+
 using namespace std;
 
 namespace CAROM {
@@ -43,44 +50,6 @@ S_OPT(const Matrix* f_basis,
     // processor that owns each sampled row, and fills f_basis_sampled_inv with
     // the inverse of the sampled rows of the basis.
 
-    // Create an MPI_Datatype for the RowInfo struct.
-    MPI_Datatype MaxRowType, oldtypes[2];
-    int blockcounts[2];
-    MPI_Aint offsets[2], extent, lower_bound;
-    MPI_Status stat;
-    offsets[0] = 0;
-    oldtypes[0] = MPI_DOUBLE;
-    blockcounts[0] = 1;
-
-    /*
-       MPI_Type_extent is deprecated in MPI-2 and removed in
-       MPI-3. MPI_Type_extent has been replaced by MPI_Type_get_extent.
-    */
-#if (MPI_VERSION == 1)
-    MPI_Type_extent(MPI_DOUBLE, &extent);
-#else
-    MPI_Type_get_extent(MPI_DOUBLE, &lower_bound, &extent);
-#endif
-
-    offsets[1] = extent;
-    oldtypes[1] = MPI_INT;
-    blockcounts[1] = 2;
-
-    /*
-      MPI_Type_struct is deprecated in MPI-2 and removed in
-      MPI-3. MPI_Type_struct has been replaced by MPI_Type_create_struct.
-     */
-#if (MPI_VERSION == 1)
-    MPI_Type_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#else
-    MPI_Type_create_struct(2, blockcounts, offsets, oldtypes, &MaxRowType);
-#endif
-    MPI_Type_commit(&MaxRowType);
-
-    // Create an MPI_Op for the RowInfoMax function.
-    MPI_Op RowInfoOp;
-    MPI_Op_create((MPI_User_function*)RowInfoMax, true, &RowInfoOp);
-
     // Get the number of basis vectors and the size of each basis vector.
     CAROM_VERIFY(0 < num_f_basis_vectors_used
                  && num_f_basis_vectors_used <= f_basis->numColumns());
@@ -121,405 +90,244 @@ S_OPT(const Matrix* f_basis,
         Vo = f_basis_truncated;
     }
 
-    int num_samples_obtained = 0;
-
-    // Scratch space used throughout the algorithm.
-    std::vector<double> c(num_basis_vectors);
+    // The selected rows of the basis, in the order they were selected, are
+    // V1.
+    GreedyRowSelector selector(Vo, num_basis_vectors, num_samples, myid,
+                               num_procs);
+    const Matrix& V1 = selector.getSampledBasis();
 
-    vector<set<int> > proc_sampled_f_row(num_procs);
-    vector<map<int, int> > proc_f_row_to_tmp_fs_row(num_procs);
-    int num_f_basis_cols = f_basis_sampled_inv.numColumns();
-    Matrix V1(num_samples,
-              num_basis_vectors,
-              false);
-
-    RowInfo f_bv_max_local, f_bv_max_global;
-
-    // Gather information about initial samples given as input.
-    const int num_init_samples = init_samples ? init_samples->size() : 0;
-    int total_num_init_samples = 0;
-    MPI_Allreduce(&num_init_samples, &total_num_init_samples, 1,
-                  MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    // The initial samples given as input are the first sampled rows.
+    const int total_num_init_samples = selector.selectGivenRows(init_samples);
     CAROM_VERIFY(num_samples >= total_num_init_samples);
-
-    int init_sample_offset = 0;
-    for (int i = 0; i < total_num_init_samples; i++)
-    {
-        f_bv_max_local.row_val = -DBL_MAX;
-        f_bv_max_local.proc = myid;
-        if (init_sample_offset < num_init_samples)
-        {
-            f_bv_max_local.row_val = 1.0;
-            f_bv_max_local.row = (*init_samples)[init_sample_offset];
-        }
-        MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                      MaxRowType, RowInfoOp, MPI_COMM_WORLD);
-        // Now get the first sampled row of the basis
-        if (f_bv_max_global.proc == myid) {
-            for (int j = 0; j < num_basis_vectors; ++j) {
-                c[j] = Vo->item(f_bv_max_global.row, j);
-            }
-            init_sample_offset++;
-        }
-        MPI_Bcast(c.data(), num_basis_vectors, MPI_DOUBLE,
-                  f_bv_max_global.proc, MPI_COMM_WORLD);
-        // Now add the first sampled row of the basis to tmp_fs.
-        for (int j = 0; j < num_basis_vectors; ++j) {
-            V1.item(num_samples_obtained, j) = c[j];
-        }
-        proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-        proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] =
-            num_samples_obtained;
-        num_samples_obtained++;
-    }
+    int num_samples_obtained = total_num_init_samples;
 
     if (num_samples_obtained == 0)
     {
-        f_bv_max_local.row_val = -DBL_MAX;
-        f_bv_max_local.proc = myid;
+        std::vector<double> f_bv_val(std::max(num_rows, 1));
         for (int i = 0; i < num_rows; ++i) {
-            double f_bv_val = fabs(Vo->item(i, 0));
-            if (f_bv_val > f_bv_max_local.row_val) {
-                f_bv_max_local.row_val = f_bv_val;
-                f_bv_max_local.row = i;
-            }
+            f_bv_val[i] = fabs(Vo->item(i, 0));
         }
-        MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                      MaxRowType, RowInfoOp, MPI_COMM_WORLD);
-        // Now get the first sampled row of the basis
-        if (f_bv_max_global.proc == myid) {
-            for (int j = 0; j < num_basis_vectors; ++j) {
-                c[j] = Vo->item(f_bv_max_global.row, j);
-            }
-        }
-        MPI_Bcast(c.data(), num_basis_vectors, MPI_DOUBLE,
-                  f_bv_max_global.proc, MPI_COMM_WORLD);
-        // Now add the first sampled row of the basis to tmp_fs.
-        for (int j = 0; j < num_basis_vectors; ++j) {
-            V1.item(0, j) = c[j];
-        }
-        proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-        proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] = 0;
+        selector.selectRows(f_bv_val.data(), 1);
         num_samples_obtained++;
     }
 
     if (num_samples_obtained < num_samples)
     {
-        Vector* A = new Vector(num_rows, f_basis->distributed());
-        Vector* noM = new Vector(num_rows, f_basis->distributed());
-
-        Matrix A0(num_basis_vectors - 1, num_basis_vectors - 1, false);
-        Matrix V1_last_col(num_basis_vectors - 1, 1, false);
-        Matrix tt(num_rows, num_basis_vectors - 1, f_basis->distributed());
-        Matrix tt1(num_rows, num_basis_vectors - 1, f_basis->distributed());
-        Matrix g1(tt.numRows(), tt.numColumns(), f_basis->distributed());
-        Matrix GG(tt1.numRows(), tt1.numColumns(), f_basis->distributed());
-        Vector ls_res_first_row(num_basis_vectors - 1, false);
-        Vector nV(num_basis_vectors, false);
-
-        int start_idx = 2;
-        if (total_num_init_samples > 1)
-        {
-            start_idx += (total_num_init_samples - 1);
-        }
-        for (int i = start_idx; i <= num_samples; i++)
+        int n = num_basis_vectors;
+        int Vo_lda = Vo->numColumns();
+
+        // With s sampled rows and c = min(s, n), Ginv is the inverse of the
+        // normal equation matrix V1(0:s, 0:c)^T V1(0:s, 0:c), stored with
+        // leading dimension n. It is updated as each row is sampled rather
+        // than being formed and inverted again.
+        std::vector<double> Ginv(n * n);
+        int c = std::min(num_samples_obtained, n);
         {
-            if (i <= num_basis_vectors)
+            Matrix G(c, c, false);
+            for (int k = 0; k < c; k++)
             {
-                A0.setSize(i - 1, i - 1);
-                V1_last_col.setSize(i - 1, 1);
-                for (int j = 0; j < num_samples_obtained; j++)
-                {
-                    for (int k = 0; k < i - 1; k++)
-                    {
-                        A0.item(j, k) = V1.item(j, k);
-                    }
-                    V1_last_col.item(j, 0) = V1.item(j, i - 1);
-                }
-
-                Matrix* atA0 = V1_last_col.transposeMult(A0);
-                tt.setSize(num_rows, i - 1);
-                tt1.setSize(num_rows, i - 1);
-
-                double ata = 0.0;
-                for (int j = 0; j < V1_last_col.numRows(); j++)
+                for (int l = 0; l < c; l++)
                 {
-                    for (int k = 0; k < V1_last_col.numColumns(); k++)
+                    double tmp = 0.0;
+                    for (int t = 0; t < num_samples_obtained; t++)
                     {
-                        ata += (V1_last_col.item(j, k) * V1_last_col.item(j, k));
+                        tmp += V1.item(t, k) * V1.item(t, l);
                     }
+                    G.item(k, l) = tmp;
                 }
-
-                Matrix* lhs = A0.transposeMult(A0);
-                lhs->inverse();
-                Matrix* rhs = NULL;
-                if (myid == 0)
+            }
+            G.inverse();
+            for (int k = 0; k < c; k++)
+            {
+                for (int l = 0; l < c; l++)
                 {
-                    rhs = new Matrix(num_rows + atA0->numRows(), i - 1, f_basis->distributed());
-                    for (int k = 0; k < rhs->numColumns(); k++)
-                    {
-                        rhs->item(0, k) = atA0->item(0, k);
-                    }
-                    for (int j = 1; j < rhs->numRows(); j++)
-                    {
-                        for (int k = 0; k < rhs->numColumns(); k++)
-                        {
-                            rhs->item(j, k) = Vo->item(j - 1, k);
-                        }
-                    }
+                    Ginv[k * n + l] = G.item(k, l);
                 }
-                else
-                {
-                    rhs = new Matrix(num_rows, i - 1, f_basis->distributed());
-                    for (int j = 0; j < rhs->numRows(); j++)
-                    {
-                        for (int k = 0; k < rhs->numColumns(); k++)
-                        {
-                            rhs->item(j, k) = Vo->item(j, k);
-                        }
-                    }
-                }
-
-                Matrix* ls_res = rhs->mult(lhs);
-                delete lhs;
-                delete rhs;
+            }
+        }
 
-                Matrix* c_T = NULL;
-                if (myid == 0)
-                {
-                    c_T = new Matrix(ls_res->getData() + ls_res->numColumns(),
-                                     ls_res->numRows() - 1, ls_res->numColumns(), f_basis->distributed(), true);
-                }
-                else
-                {
-                    c_T = new Matrix(ls_res->getData(),
-                                     ls_res->numRows(), ls_res->numColumns(), f_basis->distributed(), true);
-                }
-                Matrix* Vo_first_i_columns = Vo->getFirstNColumns(i - 1);
+        // nV holds the squared norms of the columns of V1.
+        std::vector<double> nV(n, 0.0);
+        for (int t = 0; t < num_samples_obtained; t++)
+        {
+            for (int k = 0; k < n; k++)
+            {
+                nV[k] += V1.item(t, k) * V1.item(t, k);
+            }
+        }
 
-                Vector* b = new Vector(num_rows, f_basis->distributed());
-                for (int j = 0; j < Vo_first_i_columns->numRows(); j++)
-                {
-                    double tmp = 1.0;
-                    for (int k = 0; k < Vo_first_i_columns->numColumns(); k++)
-                    {
-                        tmp += (Vo_first_i_columns->item(j, k) * c_T->item(j, k));
-                    }
-                    b->item(j) = tmp;
-                }
+        // Workspaces used throughout the algorithm.
+        std::vector<double> C(std::max(num_rows * n, 1));
+        std::vector<double> A(std::max(num_rows, 1));
+        std::vector<double> q(n), ls_res_first_row(n), Ginv_r(n);
 
-                delete Vo_first_i_columns;
+        for (int i = num_samples_obtained + 1; i <= num_samples; i++)
+        {
+            // The first c columns of the basis times Ginv, through the
+            // column major view of the row major data.
+            if (num_rows > 0)
+            {
+                char trans = 'N';
+                double one = 1.0, zero = 0.0;
+                dgemm(&trans, &trans, &c, &num_rows, &c, &one, Ginv.data(), &n,
+                      Vo->getData(), &Vo_lda, &zero, C.data(), &c);
+            }
 
-                for (int j = 0; j < num_rows; j++)
+            if (i <= num_basis_vectors)
+            {
+                // c = i - 1 here. a, the next column of the sampled rows,
+                // enters through ata = a^T a, q = A0^T a and
+                // ls_res_first_row = Ginv q. For row j of the basis, with v
+                // its first c entries and w the next, the score needs
+                // d = v^T Ginv v and e = v^T Ginv q.
+                double ata = 0.0;
+                for (int t = 0; t < num_samples_obtained; t++)
                 {
-                    for (int zz = 0; zz < i - 1; zz++)
-                    {
-                        tt.item(j, zz) = Vo->item(j, zz) * Vo->item(j, i - 1);
-                    }
+                    ata += V1.item(t, c) * V1.item(t, c);
                 }
-
-                g1.setSize(tt.numRows(), tt.numColumns());
-                for (int j = 0; j < g1.numRows(); j++)
+                for (int k = 0; k < c; k++)
                 {
-                    for (int k = 0; k < g1.numColumns(); k++)
+                    double tmp = 0.0;
+                    for (int t = 0; t < num_samples_obtained; t++)
                     {
-                        g1.item(j, k) = atA0->item(0, k) + tt.item(j, k);
+                        tmp += V1.item(t, k) * V1.item(t, c);
                     }
+                    q[k] = tmp;
                 }
-
-                delete atA0;
-
-                Vector* g3 = new Vector(num_rows, f_basis->distributed());
-                for (int j = 0; j < c_T->numRows(); j++)
+                double qs = 0.0;
+                for (int k = 0; k < c; k++)
                 {
                     double tmp = 0.0;
-                    for (int k = 0; k < c_T->numColumns(); k++)
+                    for (int l = 0; l < c; l++)
                     {
-                        tmp += c_T->item(j, k) * g1.item(j, k);
+                        tmp += Ginv[k * n + l] * q[l];
                     }
-                    g3->item(j) = tmp / b->item(j);
+                    ls_res_first_row[k] = tmp;
+                    qs += q[k] * tmp;
                 }
 
                 for (int j = 0; j < num_rows; j++)
                 {
-                    for (int zz = 0; zz < i - 1; zz++)
+                    const double* v = Vo->getData() + j * Vo_lda;
+                    const double* Cj = C.data() + j * c;
+                    const double w = v[c];
+                    double d = 0.0, e = 0.0, noM = 0.0;
+                    for (int k = 0; k < c; k++)
                     {
-                        tt1.item(j, zz) = c_T->item(j, zz) * (Vo->item(j, i - 1) - g3->item(j));
+                        d += v[k] * Cj[k];
+                        e += v[k] * ls_res_first_row[k];
+                        noM += std::log(nV[k] + v[k] * v[k]);
                     }
+                    noM += std::log(nV[c] + w * w);
+                    const double b = 1.0 + d;
+                    const double g3 = (e + w * d) / b;
+                    const double g1_GG = qs + w * e + (w - g3) * (e + w * d);
+                    const double Aj = std::max(0.0, ata + w * w - g1_GG);
+                    A[j] = std::log(fabs(Aj)) + std::log(b) - noM;
                 }
-
-                delete c_T;
-                delete g3;
-
-                ls_res_first_row.setSize(ls_res->numColumns());
-                if (myid == 0) {
-                    for (int j = 0; j < ls_res->numColumns(); ++j) {
-                        c[j] = ls_res->item(0, j);
-                    }
-                }
-                MPI_Bcast(c.data(), ls_res->numColumns(), MPI_DOUBLE,
-                          0, MPI_COMM_WORLD);
-                for (int j = 0; j < ls_res->numColumns(); ++j) {
-                    ls_res_first_row.item(j) = c[j];
-                }
-                GG.setSize(tt1.numRows(), tt1.numColumns());
-                for (int j = 0; j < GG.numRows(); j++)
+            }
+            else
+            {
+                for (int j = 0; j < num_rows; j++)
                 {
-                    for (int k = 0; k < GG.numColumns(); k++)
+                    const double* v = Vo->getData() + j * Vo_lda;
+                    const double* Cj = C.data() + j * n;
+                    double d = 0.0, noM = 0.0;
+                    for (int k = 0; k < n; k++)
                     {
-                        GG.item(j, k) = ls_res_first_row.item(k) + tt1.item(j, k);
+                        d += v[k] * Cj[k];
+                        noM += std::log(nV[k] + v[k] * v[k]);
                     }
+                    A[j] = std::log(1 + d) - noM;
                 }
+            }
 
-                delete ls_res;
+            selector.selectRows(A.data(), 1);
 
-                for (int j = 0; j < A->dim(); j++)
+            // Update Ginv and nV with the new sampled row r, which adds
+            // r r^T to the normal equation matrix by the Sherman-Morrison
+            // formula and, while c < n, a column by the bordered inverse.
+            const double* r = V1.getData() + num_samples_obtained * n;
+            if (i < num_samples)
+            {
+                double rGinvr = 0.0;
+                for (int k = 0; k < c; k++)
                 {
                     double tmp = 0.0;
-                    for (int k = 0; k < g1.numColumns(); k++)
+                    for (int l = 0; l < c; l++)
                     {
-                        tmp += g1.item(j, k) * GG.item(j, k);
+                        tmp += Ginv[k * n + l] * r[l];
                     }
-                    A->item(j) = std::max(0.0, ata + (Vo->item(j, i - 1) * Vo->item(j,
-                                                      i - 1)) - tmp);
+                    Ginv_r[k] = tmp;
+                    rGinvr += r[k] * tmp;
                 }
-
-                nV.setSize(i);
-                for (int j = 0; j < i; j++)
+                for (int k = 0; k < c; k++)
                 {
-                    nV.item(j) = 0.0;
-                    for (int k = 0; k < num_samples_obtained; k++)
+                    for (int l = 0; l < c; l++)
                     {
-                        nV.item(j) += (V1.item(k, j) * V1.item(k, j));
+                        Ginv[k * n + l] -= Ginv_r[k] * Ginv_r[l] / (1.0 + rGinvr);
                     }
                 }
 
-                for (int j = 0; j < noM->dim(); j++)
+                if (c < n)
                 {
-                    noM->item(j) = 0.0;
-                    for (int k = 0; k < i; k++)
+                    // The new column of the normal equation matrix is
+                    // u = V1(0:s+1, 0:c)^T V1(0:s+1, c), its new diagonal
+                    // entry is delta, and Ginv u is stored in Ginv_r.
+                    double delta = 0.0;
+                    for (int t = 0; t <= num_samples_obtained; t++)
                     {
-                        noM->item(j) += std::log(nV.item(k) + (Vo->item(j, k) * Vo->item(j, k)));
+                        delta += V1.item(t, c) * V1.item(t, c);
                     }
-                }
-
-                for (int j = 0; j < A->dim(); j++)
-                {
-                    A->item(j) = std::log(fabs(A->item(j))) + std::log(b->item(j)) - noM->item(j);
-                }
-
-                delete b;
-            }
-            else
-            {
-                Matrix* curr_V1 = new Matrix(V1.getData(), num_samples_obtained,
-                                             num_basis_vectors, false, true);
-                Matrix* lhs = curr_V1->transposeMult(curr_V1);
-                lhs->inverse();
-
-                delete curr_V1;
-
-                Matrix* ls_res = Vo->mult(lhs);
-                delete lhs;
-
-                nV.setSize(num_basis_vectors);
-                for (int j = 0; j < num_basis_vectors; j++)
-                {
-                    nV.item(j) = 0.0;
-                    for (int k = 0; k < num_samples_obtained; k++)
+                    for (int k = 0; k < c; k++)
                     {
-                        nV.item(j) += (V1.item(k, j) * V1.item(k, j));
+                        double tmp = 0.0;
+                        for (int t = 0; t <= num_samples_obtained; t++)
+                        {
+                            tmp += V1.item(t, k) * V1.item(t, c);
+                        }
+                        q[k] = tmp;
                     }
-                }
-
-                for (int j = 0; j < noM->dim(); j++)
-                {
-                    noM->item(j) = 0.0;
-                    for (int k = 0; k < num_basis_vectors; k++)
+                    double schur = delta;
+                    for (int k = 0; k < c; k++)
                     {
-                        noM->item(j) += std::log(nV.item(k) + (Vo->item(j, k) * Vo->item(j, k)));
+                        double tmp = 0.0;
+                        for (int l = 0; l < c; l++)
+                        {
+                            tmp += Ginv[k * n + l] * q[l];
+                        }
+                        Ginv_r[k] = tmp;
+                        schur -= q[k] * tmp;
                     }
-                }
-
-                for (int j = 0; j < A->dim(); j++)
-                {
-                    double tmp = 0.0;
-                    for (int k = 0; k < Vo->numColumns(); k++)
+                    for (int k = 0; k < c; k++)
                     {
-                        tmp += Vo->item(j, k) * ls_res->item(j, k);
-                    }
-                    A->item(j) = std::log(1 + tmp) - noM->item(j);
-                }
-
-                delete ls_res;
-            }
-
-            f_bv_max_local.row_val = -DBL_MAX;
-            f_bv_max_local.proc = myid;
-            for (int j = 0; j < num_rows; ++j) {
-                if (proc_f_row_to_tmp_fs_row[f_bv_max_local.proc].find(j) ==
-                        proc_f_row_to_tmp_fs_row[f_bv_max_local.proc].end())
-                {
-                    double f_bv_val = A->item(j);
-                    if (f_bv_val > f_bv_max_local.row_val) {
-                        f_bv_max_local.row_val = f_bv_val;
-                        f_bv_max_local.row = j;
+                        for (int l = 0; l < c; l++)
+                        {
+                            Ginv[k * n + l] += Ginv_r[k] * Ginv_r[l] / schur;
+                        }
+                        Ginv[k * n + c] = -Ginv_r[k] / schur;
+                        Ginv[c * n + k] = -Ginv_r[k] / schur;
                     }
+                    Ginv[c * n + c] = 1.0 / schur;
+                    c++;
                 }
             }
-            MPI_Allreduce(&f_bv_max_local, &f_bv_max_global, 1,
-                          MaxRowType, RowInfoOp, MPI_COMM_WORLD);
-            // Now get the first sampled row of the basis
-            if (f_bv_max_global.proc == myid) {
-                for (int j = 0; j < num_basis_vectors; ++j) {
-                    c[j] = Vo->item(f_bv_max_global.row, j);
-                }
-            }
-            MPI_Bcast(c.data(), num_basis_vectors, MPI_DOUBLE,
-                      f_bv_max_global.proc, MPI_COMM_WORLD);
-            // Now add the first sampled row of the basis to tmp_fs.
-            for (int j = 0; j < num_basis_vectors; ++j) {
-                V1.item(num_samples_obtained, j) = c[j];
+            for (int k = 0; k < n; k++)
+            {
+                nV[k] += r[k] * r[k];
             }
-            proc_sampled_f_row[f_bv_max_global.proc].insert(f_bv_max_global.row);
-            proc_f_row_to_tmp_fs_row[f_bv_max_global.proc][f_bv_max_global.row] =
-                num_samples_obtained;
             num_samples_obtained++;
         }
-
-        delete A;
-        delete noM;
     }
 
-    // Fill f_sampled_row, and f_sampled_rows_per_proc.  Unscramble tmp_fs into
+    // Fill f_sampled_row, and f_sampled_rows_per_proc.  Unscramble V1 into
     // f_basis_sampled_inv.
-    int idx = 0;
-    for (int i = 0; i < num_procs; ++i) {
-        set<int>& this_proc_sampled_f_row = proc_sampled_f_row[i];
-        map<int, int>& this_proc_f_row_to_tmp_fs_row =
-            proc_f_row_to_tmp_fs_row[i];
-        f_sampled_rows_per_proc[i] = this_proc_sampled_f_row.size();
-        for (set<int>::iterator j = this_proc_sampled_f_row.begin();
-                j != this_proc_sampled_f_row.end(); ++j) {
-            int this_f_row = *j;
-            f_sampled_row[idx] = this_f_row;
-            int tmp_fs_row = this_proc_f_row_to_tmp_fs_row[this_f_row];
-            for (int col = 0; col < num_f_basis_cols; ++col) {
-                f_basis_sampled_inv.item(idx, col) = V1.item(tmp_fs_row, col);
-            }
-            ++idx;
-        }
-    }
-
-    CAROM_ASSERT(num_samples == idx);
+    selector.getSampledRows(f_sampled_row.data(), f_sampled_rows_per_proc.data(),
+                            f_basis_sampled_inv);
 
     // Now invert f_basis_sampled_inv, storing its transpose.
     f_basis_sampled_inv.transposePseudoinverse();
 
-    // Free the MPI_Datatype and MPI_Op.
-    MPI_Type_free(&MaxRowType);
-    MPI_Op_free(&RowInfoOp);
-
     if (qr_factorize)
     {
         delete Vo;
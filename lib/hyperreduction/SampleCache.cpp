@@ -0,0 +1,254 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Implementation of the SampleCache class.
+
+#include "SampleCache.h"
+
+#include "linalg/Matrix.h"
+#include "utils/HDFDatabase.h"
+#include "utils/Utilities.h"
+#include "mpi.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace CAROM {
+
+namespace {
+
+// Bumped when the layout of the cache file changes.
+const int cache_version = 1;
+
+const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+const uint64_t fnv_prime = 1099511628211ULL;
+
+// FNV-1a hash of a byte range, continued from hash.
+uint64_t
+hashBytes(const void* data, size_t num_bytes, uint64_t hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < num_bytes; i++)
+    {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+}
+
+SampleCache::SampleCache(const std::string& file_name,
+                         const std::string& algorithm,
+                         const Matrix* f_basis,
+                         int num_f_basis_vectors_used,
+                         const std::vector<int>& parameters,
+                         int myid,
+                         int num_procs,
+                         const Matrix* t_basis) :
+    d_file_name(file_name),
+    d_myid(myid),
+    d_num_procs(num_procs)
+{
+    CAROM_VERIFY(!file_name.empty());
+    CAROM_VERIFY(f_basis != 0);
+    CAROM_VERIFY(0 < num_f_basis_vectors_used &&
+                 num_f_basis_vectors_used <= f_basis->numColumns());
+    CAROM_VERIFY(0 <= myid && myid < num_procs);
+
+    d_fingerprint.push_back(cache_version);
+    addHash(hashBytes(algorithm.data(), algorithm.size(), fnv_offset_basis));
+    d_fingerprint.push_back(num_procs);
+    d_fingerprint.push_back(num_f_basis_vectors_used);
+    addBasis(f_basis, num_f_basis_vectors_used);
+    if (t_basis != NULL)
+    {
+        CAROM_VERIFY(num_f_basis_vectors_used <= t_basis->numColumns());
+        addBasis(t_basis, num_f_basis_vectors_used);
+    }
+    d_fingerprint.push_back(parameters.size());
+    d_fingerprint.insert(d_fingerprint.end(), parameters.begin(),
+                         parameters.end());
+}
+
+void
+SampleCache::addHash(uint64_t hash)
+{
+    d_fingerprint.push_back(static_cast<int>(hash >> 32));
+    d_fingerprint.push_back(static_cast<int>(hash & 0xffffffffULL));
+}
+
+void
+SampleCache::addBasis(const Matrix* basis, int num_cols)
+{
+    // Hash the used part of the local rows, then hash the hashes of all the
+    // processes in rank order so that every process gets the same checksum.
+    const int num_rows = basis->numRows();
+    uint64_t local_hash = hashBytes(&num_rows, sizeof(num_rows),
+                                    fnv_offset_basis);
+    for (int i = 0; i < num_rows; i++)
+    {
+        local_hash = hashBytes(basis->getData() + i * basis->numColumns(),
+                               num_cols * sizeof(double), local_hash);
+    }
+
+    std::vector<uint64_t> hashes(d_num_procs);
+    if (basis->distributed() && d_num_procs > 1)
+    {
+        CAROM_VERIFY(MPI_Allgather(&local_hash, 1, MPI_UINT64_T, hashes.data(),
+                                   1, MPI_UINT64_T, MPI_COMM_WORLD) == MPI_SUCCESS);
+    }
+    else
+    {
+        hashes.assign(d_num_procs, local_hash);
+    }
+
+    d_fingerprint.push_back(basis->distributed() ? 1 : 0);
+    d_fingerprint.push_back(basis->numColumns());
+    addHash(hashBytes(hashes.data(), hashes.size() * sizeof(uint64_t),
+                      fnv_offset_basis));
+}
+
+bool
+SampleCache::load(std::vector<int>& f_sampled_row,
+                  std::vector<int>& f_sampled_rows_per_proc,
+                  Matrix& f_basis_sampled_inv,
+                  std::vector<int>* t_samples) const
+{
+    // The root process reads everything and broadcasts the sizes, then the
+    // integers and the sampled inverse.
+    // sizes = {hit, #sampled rows, #temporal samples, rows, columns}
+    int sizes[5] = {0, 0, 0, 0, 0};
+    std::vector<int> rows;
+    std::vector<int> rows_per_proc(d_num_procs);
+    std::vector<int> temporal;
+    if (d_myid == 0 && Utilities::file_exist(d_file_name))
+    {
+        HDFDatabase database;
+        database.open(d_file_name, "r");
+        int fingerprint_size;
+        database.getInteger("fingerprint_size", fingerprint_size);
+        std::vector<int> fingerprint(fingerprint_size);
+        if (fingerprint_size == static_cast<int>(d_fingerprint.size()))
+        {
+            database.getIntegerArray("fingerprint", fingerprint.data(),
+                                     fingerprint_size);
+        }
+        int num_temporal;
+        database.getInteger("num_t_samples", num_temporal);
+        if (fingerprint == d_fingerprint &&
+                (num_temporal > 0) == (t_samples != NULL))
+        {
+            sizes[0] = 1;
+            database.getInteger("num_sampled_rows", sizes[1]);
+            sizes[2] = num_temporal;
+            rows.resize(sizes[1]);
+            database.getIntegerArray("sampled_row", rows.data(), sizes[1]);
+            database.getIntegerArray("sampled_rows_per_proc",
+                                     rows_per_proc.data(), d_num_procs);
+            if (num_temporal > 0)
+            {
+                temporal.resize(num_temporal);
+                database.getIntegerArray("t_samples", temporal.data(),
+                                         num_temporal);
+            }
+            f_basis_sampled_inv.read(database, "sampled_inv_");
+            sizes[3] = f_basis_sampled_inv.numRows();
+            sizes[4] = f_basis_sampled_inv.numColumns();
+        }
+        database.close();
+    }
+
+    if (d_num_procs > 1)
+    {
+        CAROM_VERIFY(MPI_Bcast(sizes, 5, MPI_INT, 0, MPI_COMM_WORLD)
+                     == MPI_SUCCESS);
+    }
+    if (!sizes[0])
+    {
+        return false;
+    }
+
+    if (d_num_procs > 1)
+    {
+        rows.resize(sizes[1]);
+        temporal.resize(sizes[2]);
+        if (d_myid != 0)
+        {
+            f_basis_sampled_inv.setSize(sizes[3], sizes[4]);
+        }
+
+        // The integers go in one message: the rows, their counts and the
+        // temporal samples.
+        std::vector<int> ints(rows);
+        ints.insert(ints.end(), rows_per_proc.begin(), rows_per_proc.end());
+        ints.insert(ints.end(), temporal.begin(), temporal.end());
+        CAROM_VERIFY(MPI_Bcast(ints.data(), ints.size(), MPI_INT, 0,
+                               MPI_COMM_WORLD) == MPI_SUCCESS);
+        CAROM_VERIFY(MPI_Bcast(f_basis_sampled_inv.getData(),
+                               sizes[3] * sizes[4], MPI_DOUBLE, 0,
+                               MPI_COMM_WORLD) == MPI_SUCCESS);
+        std::copy(ints.begin(), ints.begin() + sizes[1], rows.begin());
+        std::copy(ints.begin() + sizes[1], ints.begin() + sizes[1] + d_num_procs,
+                  rows_per_proc.begin());
+        std::copy(ints.begin() + sizes[1] + d_num_procs, ints.end(),
+                  temporal.begin());
+    }
+
+    f_sampled_row = rows;
+    f_sampled_rows_per_proc = rows_per_proc;
+    if (t_samples != NULL)
+    {
+        *t_samples = temporal;
+    }
+    return true;
+}
+
+void
+SampleCache::save(const std::vector<int>& f_sampled_row,
+                  const std::vector<int>& f_sampled_rows_per_proc,
+                  const Matrix& f_basis_sampled_inv,
+                  const std::vector<int>* t_samples) const
+{
+    if (d_myid != 0)
+    {
+        return;
+    }
+    CAROM_VERIFY(!f_sampled_row.empty());
+    CAROM_VERIFY(static_cast<int>(f_sampled_rows_per_proc.size()) ==
+                 d_num_procs);
+    CAROM_VERIFY(t_samples == NULL || !t_samples->empty());
+
+    // Write to a temporary file and rename it, so that an interrupted save
+    // never leaves a cache file that looks valid.
+    const std::string tmp_file_name = d_file_name + ".tmp";
+    HDFDatabase database;
+    database.create(tmp_file_name);
+    database.putInteger("fingerprint_size", d_fingerprint.size());
+    database.putIntegerArray("fingerprint", d_fingerprint.data(),
+                             d_fingerprint.size());
+    database.putInteger("num_sampled_rows", f_sampled_row.size());
+    database.putIntegerArray("sampled_row", f_sampled_row.data(),
+                             f_sampled_row.size());
+    database.putIntegerArray("sampled_rows_per_proc",
+                             f_sampled_rows_per_proc.data(), d_num_procs);
+    database.putInteger("num_t_samples",
+                        t_samples == NULL ? 0 : t_samples->size());
+    if (t_samples != NULL)
+    {
+        database.putIntegerArray("t_samples", t_samples->data(),
+                                 t_samples->size());
+    }
+    f_basis_sampled_inv.write(database, "sampled_inv_");
+    database.close();
+    CAROM_VERIFY(std::rename(tmp_file_name.c_str(), d_file_name.c_str()) == 0);
+}
+
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: Persists the output of a sampling algorithm so that the online
+//              stage can skip the sampling when the basis has not changed.
+
+#ifndef included_SampleCache_h
+#define included_SampleCache_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CAROM {
+
+class Matrix;
+
+/**
+ * Class SampleCache saves the sampled rows, the number of sampled rows of
+ * each process and the sampled inverse computed by DEIM, QDEIM, GNAT, S_OPT
+ * or SpaceTimeSampling to a file, and loads them back when the file was
+ * written for the same inputs. The inputs are identified by a fingerprint
+ * made of the name of the algorithm, its integer parameters, the number of
+ * processes, the number of rows of the basis on each process, the number of
+ * basis vectors used and a checksum of their entries. Computing the
+ * fingerprint costs a single collective. Only the root process reads and
+ * writes the file, so the sampled inverse is saved as the root process holds
+ * it and loading gives every process the root's copy.
+ *
+ * A typical online stage is
+ *
+ *     SampleCache cache("samples", "DEIM", f_basis, num_f_basis_vectors_used,
+ *                       std::vector<int>(), myid, num_procs);
+ *     if (!cache.load(f_sampled_row, f_sampled_rows_per_proc,
+ *                     f_basis_sampled_inv))
+ *     {
+ *         DEIM(f_basis, num_f_basis_vectors_used, f_sampled_row,
+ *              f_sampled_rows_per_proc, f_basis_sampled_inv, myid, num_procs);
+ *         cache.save(f_sampled_row, f_sampled_rows_per_proc,
+ *                    f_basis_sampled_inv);
+ *     }
+ */
+class SampleCache
+{
+public:
+    /**
+     * @brief Constructor. Computes the fingerprint of the inputs of the
+     *        sampling algorithm, which is collective.
+     *
+     * @param[in] file_name  The name of the cache file.
+     * @param[in] algorithm  The name of the sampling algorithm.
+     * @param[in] f_basis    The distributed basis given to the algorithm.
+     * @param[in] num_f_basis_vectors_used The number of basis vectors in
+     *                       f_basis used by the algorithm.
+     * @param[in] parameters The other integer inputs of the algorithm, such
+     *                       as the number of samples requested or the initial
+     *                       samples.
+     * @param[in] myid       The rank of this process.
+     * @param[in] num_procs  The total number of processes.
+     * @param[in] t_basis    The temporal basis of SpaceTimeSampling, or NULL.
+     *                       Its first num_f_basis_vectors_used columns are
+     *                       part of the fingerprint.
+     */
+    SampleCache(const std::string& file_name,
+                const std::string& algorithm,
+                const Matrix* f_basis,
+                int num_f_basis_vectors_used,
+                const std::vector<int>& parameters,
+                int myid,
+                int num_procs,
+                const Matrix* t_basis = NULL);
+
+    /**
+     * @brief Load the samples if the cache file was written for the same
+     *        inputs. Collective.
+     *
+     * @param[out] f_sampled_row The local row ids of each sampled row.
+     * @param[out] f_sampled_rows_per_proc The number of sampled rows for each
+     *                           processor.
+     * @param[out] f_basis_sampled_inv The sampled inverse, or the sampled
+     *                           spatial basis of SpaceTimeSampling.
+     * @param[out] t_samples     The temporal samples of SpaceTimeSampling, or
+     *                           NULL.
+     *
+     * @return True if the samples were loaded. The outputs are left
+     *         untouched otherwise.
+     */
+    bool load(std::vector<int>& f_sampled_row,
+              std::vector<int>& f_sampled_rows_per_proc,
+              Matrix& f_basis_sampled_inv,
+              std::vector<int>* t_samples = NULL) const;
+
+    /**
+     * @brief Save the samples with the fingerprint of the inputs. Only the
+     *        arguments of the root process are used.
+     *
+     * @param[in] f_sampled_row The local row ids of each sampled row.
+     * @param[in] f_sampled_rows_per_proc The number of sampled rows for each
+     *                          processor.
+     * @param[in] f_basis_sampled_inv The sampled inverse, or the sampled
+     *                          spatial basis of SpaceTimeSampling.
+     * @param[in] t_samples     The temporal samples of SpaceTimeSampling, or
+     *                          NULL.
+     */
+    void save(const std::vector<int>& f_sampled_row,
+              const std::vector<int>& f_sampled_rows_per_proc,
+              const Matrix& f_basis_sampled_inv,
+              const std::vector<int>* t_samples = NULL) const;
+
+    /**
+     * @brief Returns the fingerprint of the inputs.
+     */
+    const std::vector<int>& getFingerprint() const
+    {
+        return d_fingerprint;
+    }
+
+private:
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    SampleCache();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    SampleCache(
+        const SampleCache& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    SampleCache&
+    operator = (
+        const SampleCache& rhs);
+
+    /**
+     * @brief Append the dimensions of the basis and a checksum of its first
+     *        num_cols columns on all processes to the fingerprint.
+     */
+    void addBasis(const Matrix* basis, int num_cols);
+
+    /**
+     * @brief Append a 64 bit value to the fingerprint as two integers.
+     */
+    void addHash(uint64_t hash);
+
+    /**
+     * @brief The name of the cache file.
+     */
+    std::string d_file_name;
+
+    /**
+     * @brief The fingerprint of the inputs of the sampling algorithm.
+     */
+    std::vector<int> d_fingerprint;
+
+    /**
+     * @brief The rank of this process.
+     */
+    int d_myid;
+
+    /**
+     * @brief The total number of processes.
+     */
+    int d_num_procs;
+};
+
+}
+
+#endif
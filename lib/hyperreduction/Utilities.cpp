@@ -12,17 +12,377 @@
 
 #include "Utilities.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
 namespace CAROM {
 
+namespace {
+
+// The reduction payload is the number of candidates and the number of basis
+// columns followed by the candidates, best first. A candidate is its score,
+// its rank, its row and then that row of the basis. An empty candidate has
+// rank -1.
+const int header_size = 2;
+const int candidate_header_size = 3;
+
+bool
+isBetterCandidate(const double* a, const double* b)
+{
+    if (a[1] < 0.0) {
+        return false;
+    }
+    if (b[1] < 0.0) {
+        return true;
+    }
+    if (a[0] != b[0]) {
+        return a[0] > b[0];
+    }
+    if (a[1] != b[1]) {
+        return a[1] < b[1];
+    }
+    return a[2] < b[2];
+}
+
+void
+MergeCandidates(double* a, double* b, int* len, MPI_Datatype* type)
+{
+    for (int n = 0; n < *len; ++n) {
+        const int num_candidates = static_cast<int>(b[0]);
+        const int candidate_size = candidate_header_size + static_cast<int>(b[1]);
+        std::vector<double> merged(num_candidates*candidate_size);
+        const double* a_candidates = a + header_size;
+        const double* b_candidates = b + header_size;
+        // A candidate given by both sides, as when every process passes the
+        // same rank, is kept once. Each side advances at most once per
+        // merged candidate, so neither runs out.
+        int ia = 0, ib = 0;
+        for (int k = 0; k < num_candidates; ++k) {
+            const double* a_next = a_candidates + ia*candidate_size;
+            const double* b_next = b_candidates + ib*candidate_size;
+            const double* best;
+            if (isBetterCandidate(a_next, b_next)) {
+                best = a_next;
+                ++ia;
+            }
+            else {
+                best = b_next;
+                ++ib;
+                if (!isBetterCandidate(b_next, a_next)) {
+                    ++ia;
+                }
+            }
+            std::copy(best, best + candidate_size, &merged[k*candidate_size]);
+        }
+        std::copy(merged.begin(), merged.end(), b + header_size);
+        a += header_size + num_candidates*candidate_size;
+        b += header_size + num_candidates*candidate_size;
+    }
+}
+
+// Gaussian elimination with partial pivoting on the rows of the row major
+// matrix a with num_cols columns, skipping the excluded rows. Returns the
+// first num_pivots pivot rows, which are excluded on return. The first of
+// equal pivots is taken, and a zero column still yields a pivot.
+std::vector<int>
+eliminate(std::vector<double>& a, int num_cols, std::vector<bool>& excluded,
+          int num_pivots)
+{
+    const int num_rows = excluded.size();
+    std::vector<int> pivots;
+    for (int j = 0; j < num_pivots; ++j) {
+        int pivot = -1;
+        for (int i = 0; i < num_rows; ++i) {
+            if (!excluded[i] && (pivot < 0 ||
+                                 fabs(a[i*num_cols + j]) > fabs(a[pivot*num_cols + j]))) {
+                pivot = i;
+            }
+        }
+        if (pivot < 0) {
+            break;
+        }
+        pivots.push_back(pivot);
+        excluded[pivot] = true;
+
+        const double* pivot_row = &a[pivot*num_cols];
+        if (pivot_row[j] == 0.0) {
+            continue;
+        }
+        for (int i = 0; i < num_rows; ++i) {
+            if (!excluded[i]) {
+                double* row = &a[i*num_cols];
+                const double factor = row[j]/pivot_row[j];
+                for (int col = j + 1; col < num_cols; ++col) {
+                    row[col] -= factor*pivot_row[col];
+                }
+            }
+        }
+    }
+    return pivots;
+}
+
+}
+
+GreedyRowSelector::GreedyRowSelector(const Matrix* basis,
+                                     int num_cols,
+                                     int num_samples,
+                                     int myid,
+                                     int num_procs) :
+    d_basis(basis),
+    d_num_cols(num_cols),
+    d_myid(myid),
+    d_num_procs(num_procs),
+    d_num_selected(0),
+    d_local_selected(basis->numRows(), false),
+    d_sampled_procs(num_samples),
+    d_sampled_rows(num_samples),
+    d_sampled_basis(num_samples, num_cols, false)
+{
+    CAROM_VERIFY(0 < num_cols && num_cols <= basis->numColumns());
+    MPI_Op_create((MPI_User_function*)MergeCandidates, true, &d_merge_op);
+}
+
+GreedyRowSelector::~GreedyRowSelector()
+{
+    MPI_Op_free(&d_merge_op);
+}
+
 void
-RowInfoMax(RowInfo* a, RowInfo* b, int* len, MPI_Datatype* type)
-{
-    for (int i = 0; i < *len; ++i) {
-        if (a[i].row_val > b[i].row_val || (a[i].row_val == b[i].row_val
-                                            && a[i].proc < b[i].proc)) {
-            b[i].row_val = a[i].row_val;
-            b[i].row = a[i].row;
-            b[i].proc = a[i].proc;
+GreedyRowSelector::selectRows(const double* scores, int num_rows)
+{
+    CAROM_VERIFY(d_num_selected + num_rows <= d_sampled_basis.numRows());
+    if (num_rows <= 0) {
+        return;
+    }
+
+    // Only the best num_rows local rows can be among the best overall. Rows
+    // scoring no more than -DBL_MAX, or NaN, are never selected.
+    std::vector<int> rows;
+    rows.reserve(d_basis->numRows());
+    for (int i = 0; i < d_basis->numRows(); ++i) {
+        if (!d_local_selected[i] && scores[i] > -DBL_MAX) {
+            rows.push_back(i);
+        }
+    }
+    const int num_candidates = std::min(num_rows, (int) rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + num_candidates, rows.end(),
+                      [scores](int i, int j)
+    {
+        return scores[i] > scores[j] || (scores[i] == scores[j] && i < j);
+    });
+
+    std::vector<double> candidate_scores(num_candidates);
+    rows.resize(num_candidates);
+    for (int k = 0; k < num_candidates; ++k) {
+        candidate_scores[k] = scores[rows[k]];
+    }
+    reduceCandidates(candidate_scores, rows, num_rows);
+}
+
+int
+GreedyRowSelector::selectGivenRows(const std::vector<int>* rows)
+{
+    const int num_local_rows = rows ? rows->size() : 0;
+    std::vector<int> all_num_rows(d_num_procs);
+    MPI_Allgather(&num_local_rows, 1, MPI_INT, all_num_rows.data(), 1,
+                  MPI_INT, MPI_COMM_WORLD);
+    int offset = 0, total_num_rows = 0;
+    for (int i = 0; i < d_num_procs; ++i) {
+        if (i < d_myid) {
+            offset += all_num_rows[i];
+        }
+        total_num_rows += all_num_rows[i];
+    }
+    if (total_num_rows == 0) {
+        return 0;
+    }
+
+    // Decreasing scores by global position select the rows in order.
+    std::vector<double> candidate_scores(num_local_rows);
+    std::vector<int> candidate_rows(num_local_rows);
+    for (int k = 0; k < num_local_rows; ++k) {
+        candidate_scores[k] = -(double) (offset + k);
+        candidate_rows[k] = (*rows)[k];
+        CAROM_VERIFY(0 <= candidate_rows[k]
+                     && candidate_rows[k] < d_basis->numRows()
+                     && !d_local_selected[candidate_rows[k]]);
+    }
+    reduceCandidates(candidate_scores, candidate_rows, total_num_rows);
+    return total_num_rows;
+}
+
+void
+GreedyRowSelector::reduceCandidates(const std::vector<double>&
+                                    candidate_scores,
+                                    const std::vector<int>& candidate_rows,
+                                    int num_rows)
+{
+    CAROM_VERIFY(d_num_selected + num_rows <= d_sampled_basis.numRows());
+    const int candidate_size = candidate_header_size + d_num_cols;
+    const int payload_size = header_size + num_rows*candidate_size;
+    std::vector<double> local(payload_size, 0.0), global(payload_size);
+    local[0] = num_rows;
+    local[1] = d_num_cols;
+    const int basis_cols = d_basis->numColumns();
+    const int num_candidates = candidate_rows.size();
+    for (int k = 0; k < num_rows; ++k) {
+        double* candidate = &local[header_size + k*candidate_size];
+        if (k < num_candidates) {
+            const double* basis_row = d_basis->getData() +
+                                      candidate_rows[k]*basis_cols;
+            candidate[0] = candidate_scores[k];
+            candidate[1] = d_myid;
+            candidate[2] = candidate_rows[k];
+            std::copy(basis_row, basis_row + d_num_cols,
+                      candidate + candidate_header_size);
+        }
+        else {
+            candidate[0] = -DBL_MAX;
+            candidate[1] = -1.0;
+            candidate[2] = -1.0;
+        }
+    }
+
+    MPI_Datatype payload_type;
+    MPI_Type_contiguous(payload_size, MPI_DOUBLE, &payload_type);
+    MPI_Type_commit(&payload_type);
+    MPI_Allreduce(local.data(), global.data(), 1, payload_type, d_merge_op,
+                  MPI_COMM_WORLD);
+    MPI_Type_free(&payload_type);
+
+    for (int k = 0; k < num_rows; ++k) {
+        const double* candidate = &global[header_size + k*candidate_size];
+        const int proc = static_cast<int>(candidate[1]);
+        const int row = static_cast<int>(candidate[2]);
+        CAROM_VERIFY(proc >= 0);
+        recordSelection(proc, row, candidate + candidate_header_size);
+    }
+}
+
+void
+GreedyRowSelector::selectPivotedRows(const double* residual,
+                                     int num_residual_cols,
+                                     int num_rows)
+{
+    CAROM_VERIFY(d_num_selected + num_rows <= d_sampled_basis.numRows());
+    CAROM_VERIFY(num_rows <= num_residual_cols);
+    if (num_rows <= 0) {
+        return;
+    }
+
+    // Nominate the local pivot rows, eliminating a copy of the unselected
+    // local rows of the residual.
+    std::vector<int> rows;
+    for (int i = 0; i < d_basis->numRows(); ++i) {
+        if (!d_local_selected[i]) {
+            rows.push_back(i);
+        }
+    }
+    const int num_unselected = rows.size();
+    std::vector<double> local_residual(num_unselected*num_residual_cols);
+    for (int k = 0; k < num_unselected; ++k) {
+        std::copy(residual + rows[k]*num_residual_cols,
+                  residual + (rows[k] + 1)*num_residual_cols,
+                  &local_residual[k*num_residual_cols]);
+    }
+    std::vector<bool> eliminated(num_unselected, false);
+    const std::vector<int> local_pivots =
+        eliminate(local_residual, num_residual_cols, eliminated,
+                  std::min(num_rows, num_unselected));
+    const int num_local_pivots = local_pivots.size();
+
+    // Gather the nominees with their original residual and basis rows. A
+    // nominee is its rank, its row, that row of the residual and then that
+    // row of the basis. An empty nominee has rank -1.
+    const int nominee_size = 2 + num_residual_cols + d_num_cols;
+    const int basis_cols = d_basis->numColumns();
+    std::vector<double> local(num_rows*nominee_size, -1.0);
+    for (int k = 0; k < num_local_pivots; ++k) {
+        const int row = rows[local_pivots[k]];
+        double* nominee = &local[k*nominee_size];
+        nominee[0] = d_myid;
+        nominee[1] = row;
+        std::copy(residual + row*num_residual_cols,
+                  residual + (row + 1)*num_residual_cols, nominee + 2);
+        std::copy(d_basis->getData() + row*basis_cols,
+                  d_basis->getData() + row*basis_cols + d_num_cols,
+                  nominee + 2 + num_residual_cols);
+    }
+    std::vector<double> nominees(d_num_procs*num_rows*nominee_size);
+    MPI_Allgather(local.data(), local.size(), MPI_DOUBLE, nominees.data(),
+                  local.size(), MPI_DOUBLE, MPI_COMM_WORLD);
+
+    // Eliminate the nominees the same way on every process. They are in rank
+    // order, so the first of equal pivots has the lowest rank. A row given
+    // by several processes, as when every process passes the same rank, is
+    // kept once.
+    const int num_nominees = d_num_procs*num_rows;
+    std::vector<double> nominee_residual(num_nominees*num_residual_cols);
+    std::vector<bool> excluded(num_nominees);
+    for (int c = 0; c < num_nominees; ++c) {
+        const double* nominee = &nominees[c*nominee_size];
+        excluded[c] = nominee[0] < 0.0;
+        for (int d = 0; d < c && !excluded[c]; ++d) {
+            excluded[c] = nominee[0] == nominees[d*nominee_size] &&
+                          nominee[1] == nominees[d*nominee_size + 1];
+        }
+        std::copy(nominee + 2, nominee + 2 + num_residual_cols,
+                  &nominee_residual[c*num_residual_cols]);
+    }
+    const std::vector<int> pivots =
+        eliminate(nominee_residual, num_residual_cols, excluded, num_rows);
+    CAROM_VERIFY(static_cast<int>(pivots.size()) == num_rows);
+    for (int k = 0; k < num_rows; ++k) {
+        const double* nominee = &nominees[pivots[k]*nominee_size];
+        recordSelection(static_cast<int>(nominee[0]),
+                        static_cast<int>(nominee[1]),
+                        nominee + 2 + num_residual_cols);
+    }
+}
+
+void
+GreedyRowSelector::recordSelection(int proc, int row, const double* basis_row)
+{
+    d_sampled_procs[d_num_selected] = proc;
+    d_sampled_rows[d_num_selected] = row;
+    if (proc == d_myid) {
+        d_local_selected[row] = true;
+    }
+    for (int j = 0; j < d_num_cols; ++j) {
+        d_sampled_basis.item(d_num_selected, j) = basis_row[j];
+    }
+    ++d_num_selected;
+}
+
+void
+GreedyRowSelector::getSampledRows(int* sampled_row,
+                                  int* sampled_rows_per_proc,
+                                  Matrix& sampled_basis) const
+{
+    CAROM_VERIFY(sampled_basis.numRows() == d_num_selected
+                 && sampled_basis.numColumns() == d_num_cols);
+
+    std::vector<int> order(d_num_selected);
+    for (int i = 0; i < d_num_selected; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](int i, int j)
+    {
+        return d_sampled_procs[i] < d_sampled_procs[j] ||
+               (d_sampled_procs[i] == d_sampled_procs[j] &&
+                d_sampled_rows[i] < d_sampled_rows[j]);
+    });
+
+    for (int i = 0; i < d_num_procs; ++i) {
+        sampled_rows_per_proc[i] = 0;
+    }
+    for (int idx = 0; idx < d_num_selected; ++idx) {
+        const int i = order[idx];
+        sampled_row[idx] = d_sampled_rows[i];
+        ++sampled_rows_per_proc[d_sampled_procs[i]];
+        for (int col = 0; col < d_num_cols; ++col) {
+            sampled_basis.item(idx, col) = d_sampled_basis.item(i, col);
         }
     }
 }
@@ -13,31 +13,197 @@
 #ifndef included_Utilities_h
 #define included_Utilities_h
 
+#include "linalg/Matrix.h"
 #include "mpi.h"
+#include <vector>
 
 namespace CAROM {
 
-#ifndef DOXYGEN_IGNORE
-
 /**
- * @brief Struct to hold the local maximum absolute value of a basis vector,
- *        the row it is in, and the processor that owns it. We will reduce this
- *        to find the global row containing the maximum of a basis vector.
+ * Class GreedyRowSelector performs the row selection shared by the greedy
+ * sampling algorithms. In each round the caller scores the local rows of a
+ * distributed basis and the selector picks the rows with the highest scores
+ * over all processes. The selected rows of the basis are carried inside the
+ * reduction that finds them, so a round costs a single collective however
+ * many rows it selects.
  */
-typedef struct
+class GreedyRowSelector
 {
-    double row_val;
-    int row;
-    int proc;
-} RowInfo;
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] basis       The distributed basis whose rows are selected.
+     * @param[in] num_cols    The number of leading columns of the basis kept
+     *                        for each selected row.
+     * @param[in] num_samples The total number of rows to be selected.
+     * @param[in] myid        The rank of this process.
+     * @param[in] num_procs   The total number of processes.
+     */
+    GreedyRowSelector(const Matrix* basis,
+                      int num_cols,
+                      int num_samples,
+                      int myid,
+                      int num_procs);
 
-/**
- * @brief The function to use as an MPI_Op in the reduction to determine the row
- *        and processor owning the row of the absolute maximum of a basis vector.
- */
-void RowInfoMax(RowInfo* a, RowInfo* b, int* len, MPI_Datatype* type);
+    /**
+     * @brief Destructor.
+     */
+    ~GreedyRowSelector();
+
+    /**
+     * @brief Select the num_rows rows with the highest scores among the
+     *        rows not selected yet. Ties go to the lower rank, then to the
+     *        lower row. Must be called by every process with the same
+     *        num_rows.
+     *
+     * @param[in] scores   The score of each local row of the basis.
+     * @param[in] num_rows The number of rows to select.
+     */
+    void selectRows(const double* scores, int num_rows);
+
+    /**
+     * @brief Select the rows given by every process, in rank order and then
+     *        in the given order. Must be called by every process.
+     *
+     * @param[in] rows The local rows given by this process, or NULL.
+     *
+     * @return The total number of rows given by all processes.
+     */
+    int selectGivenRows(const std::vector<int>* rows);
+
+    /**
+     * @brief Select num_rows rows by Gaussian elimination with partial
+     *        pivoting on the rows of a residual not selected yet, column by
+     *        column. Each process nominates its pivot rows by eliminating
+     *        its local rows and the pivots over all processes are chosen
+     *        among the gathered nominees in the same way, so a call costs a
+     *        single collective. Equal pivots go to the lower rank. Must be
+     *        called by every process with the same num_rows.
+     *
+     * @param[in] residual          The local rows of the residual, row major.
+     * @param[in] num_residual_cols The number of columns of the residual.
+     * @param[in] num_rows          The number of rows to select, at most
+     *                              num_residual_cols.
+     */
+    void selectPivotedRows(const double* residual, int num_residual_cols,
+                           int num_rows);
+
+    /**
+     * @brief Returns the number of rows selected so far.
+     */
+    int numSelected() const
+    {
+        return d_num_selected;
+    }
+
+    /**
+     * @brief Returns the selected rows of the basis in the order they were
+     *        selected. Only the first numSelected() rows are set.
+     */
+    const Matrix& getSampledBasis() const
+    {
+        return d_sampled_basis;
+    }
+
+    /**
+     * @brief Fill the selected rows ordered by owning process and then by
+     *        row, the number of them owned by each process and the matching
+     *        rows of the basis.
+     *
+     * @param[out] sampled_row           The local index of each selected
+     *                                   row.
+     * @param[out] sampled_rows_per_proc The number of selected rows owned by
+     *                                   each process.
+     * @param[out] sampled_basis         The selected rows of the basis.
+     */
+    void getSampledRows(int* sampled_row,
+                        int* sampled_rows_per_proc,
+                        Matrix& sampled_basis) const;
+
+private:
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    GreedyRowSelector();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    GreedyRowSelector(
+        const GreedyRowSelector& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    GreedyRowSelector&
+    operator = (
+        const GreedyRowSelector& rhs);
+
+    /**
+     * @brief Reduce the num_rows best local candidates, given by their
+     *        scores and rows, to the num_rows best over all processes and
+     *        record them as selected.
+     */
+    void reduceCandidates(const std::vector<double>& candidate_scores,
+                          const std::vector<int>& candidate_rows,
+                          int num_rows);
+
+    /**
+     * @brief Record a row as the next selected row.
+     */
+    void recordSelection(int proc, int row, const double* basis_row);
+
+    /**
+     * @brief The distributed basis whose rows are selected.
+     */
+    const Matrix* d_basis;
+
+    /**
+     * @brief The number of leading columns kept for each selected row.
+     */
+    int d_num_cols;
+
+    /**
+     * @brief The rank of this process.
+     */
+    int d_myid;
+
+    /**
+     * @brief The total number of processes.
+     */
+    int d_num_procs;
+
+    /**
+     * @brief The number of rows selected so far.
+     */
+    int d_num_selected;
+
+    /**
+     * @brief Whether each local row of the basis has been selected.
+     */
+    std::vector<bool> d_local_selected;
+
+    /**
+     * @brief The rank owning each selected row, in selection order.
+     */
+    std::vector<int> d_sampled_procs;
+
+    /**
+     * @brief The local index of each selected row, in selection order.
+     */
+    std::vector<int> d_sampled_rows;
+
+    /**
+     * @brief The selected rows of the basis, in selection order.
+     */
+    Matrix d_sampled_basis;
 
-#endif /* DOXYGEN_IGNORE */
+    /**
+     * @brief The reduction merging the candidates of two processes.
+     */
+    MPI_Op d_merge_op;
+};
 
 }
 
@@ -19,6 +19,8 @@
 #include "algo/DMD.h"
 #include "algo/AdaptiveDMD.h"
 #include "algo/NonuniformDMD.h"
+#include "algo/OnlineDMD.h"
+#include "algo/WindowedDMD.h"
 #include "algo/ParametricDMD.h"
 #include "algo/DifferentialEvolution.h"
 #include "algo/greedy/GreedyCustomSampler.h"
@@ -29,6 +31,7 @@
 #include "hyperreduction/GNAT.h"
 #include "hyperreduction/QDEIM.h"
 #include "hyperreduction/S_OPT.h"
+#include "hyperreduction/SampleCache.h"
 #include "hyperreduction/STSampling.h"
 #ifdef USEMFEM
 #include "mfem/SampleMesh.hpp"
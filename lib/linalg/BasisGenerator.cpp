@@ -38,6 +38,7 @@ BasisGenerator::BasisGenerator(
     CAROM_VERIFY(options.max_time_intervals == -1
                  || options.max_time_intervals > 0);
     CAROM_VERIFY(options.max_basis_dimension > 0);
+    CAROM_VERIFY(options.max_pending_writes > 0);
     if (incremental)
     {
         CAROM_VERIFY(options.linearity_tol > 0.0);
@@ -52,7 +53,9 @@ BasisGenerator::BasisGenerator(
     }
 
     if (!basis_file_name.empty()) {
-        d_basis_writer = new BasisWriter(this, basis_file_name, file_format);
+        d_basis_writer = new BasisWriter(this, basis_file_name, file_format,
+                                         options.async_write,
+                                         options.max_pending_writes);
     }
     d_update_right_SV = options.update_right_SV;
     if (incremental)
@@ -93,12 +96,14 @@ BasisGenerator::BasisGenerator(
         if (options.randomized) {
             d_svd.reset(
                 new RandomizedSVD(
-                    options));
+                    options,
+                    basis_file_name));
         }
         else {
             d_svd.reset(
                 new StaticSVD(
-                    options));
+                    options,
+                    basis_file_name));
         }
     }
 }
@@ -151,6 +156,13 @@ BasisGenerator::takeSample(
     return d_svd->takeSample(u_in, time, add_without_increase);
 }
 
+void
+BasisGenerator::saveState()
+{
+    CAROM_VERIFY(!d_incremental);
+    static_cast<StaticSVD*>(d_svd.get())->saveState();
+}
+
 void
 BasisGenerator::loadSamples(const std::string& base_file_name,
                             const std::string& kind,
@@ -179,19 +191,24 @@ BasisGenerator::loadSamples(const std::string& base_file_name,
     int num_cols = mat->numColumns();
     int max_cols = num_cols;
     if (cut_off < num_cols) max_cols = cut_off;
+    const Vector* scale = kind == "basis" ? singular_vals : nullptr;
+
+    if (!d_incremental) {
+        // Feed the whole block to the sample matrix in one redistribution.
+        static_cast<StaticSVD*>(d_svd.get())->takeSamples(*mat, max_cols,
+                scale, time);
+        return;
+    }
 
+    std::vector<double> u_in(num_rows);
     for (int j = 0; j < max_cols; j++) {
-        double* u_in = new double[num_rows];
         for (int i = 0; i < num_rows; i++) {
-            if (kind == "basis") {
-                u_in[i] = mat->item(i,j) * singular_vals->item(j);
-            }
-            else {
-                u_in[i] = mat->item(i,j);
+            u_in[i] = mat->item(i,j);
+            if (scale) {
+                u_in[i] *= scale->item(j);
             }
         }
-        d_svd->takeSample(u_in, time, false);
-        delete[] u_in;
+        d_svd->takeSample(u_in.data(), time, false);
     }
 }
 
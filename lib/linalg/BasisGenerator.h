@@ -118,7 +118,8 @@ public:
         bool add_without_increase = false);
 
     /**
-     * @brief Signal that the final sample has been taken.
+     * @brief Signal that the final sample has been taken. Any asynchronous
+     *        writes are completed before returning.
      *
      * @param[in] kind A string equal to "basis" or "snapshot", representing
      *                 which one will be written.
@@ -128,9 +129,45 @@ public:
     {
         if (d_basis_writer) {
             d_basis_writer->writeBasis(kind);
+            d_basis_writer->flush();
         }
     }
 
+    /**
+     * @brief Blocks until all pending asynchronous writes of bases or
+     *        snapshots have completed.
+     */
+    void
+    flush()
+    {
+        if (d_basis_writer) {
+            d_basis_writer->flush();
+        }
+    }
+
+    /**
+     * @brief Returns true if the bases and snapshots are written in a
+     *        background thread. Asynchronous writes are requested with
+     *        Options::setAsyncWrite and require a thread-safe HDF5 library.
+     */
+    bool
+    isAsyncWrite() const
+    {
+        return d_basis_writer && d_basis_writer->isAsync();
+    }
+
+    /**
+     * @brief Checkpoint the samples taken so far so that sampling may be
+     *        resumed by a BasisGenerator constructed with restore_state.
+     *
+     * Only the static and randomized SVD support checkpointing during
+     * sampling; the incremental SVD saves its state on destruction.
+     *
+     * @pre The BasisGenerator was constructed with a basis file name.
+     */
+    void
+    saveState();
+
     /**
      * @brief Write current snapshot matrix.
      */
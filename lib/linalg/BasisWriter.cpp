@@ -16,6 +16,7 @@
 #include "Vector.h"
 #include "BasisGenerator.h"
 #include "utils/Utilities.h"
+#include "utils/WriteQueue.h"
 
 #include "mpi.h"
 
@@ -24,17 +25,22 @@ namespace CAROM {
 BasisWriter::BasisWriter(
     BasisGenerator* basis_generator,
     const std::string& base_file_name,
-    Database::formats db_format) :
+    Database::formats db_format,
+    bool async,
+    int max_pending_writes) :
     d_basis_generator(basis_generator),
     d_num_intervals_written(0),
     full_file_name(""),
     snap_file_name(""),
     db_format_(db_format),
     d_database(NULL),
-    d_snap_database(NULL)
+    d_snap_database(NULL),
+    d_async(async),
+    d_write_queue(NULL)
 {
     CAROM_ASSERT(basis_generator != 0);
     CAROM_ASSERT(!base_file_name.empty());
+    CAROM_VERIFY(max_pending_writes > 0);
 
     int mpi_init;
     MPI_Initialized(&mpi_init);
@@ -53,10 +59,31 @@ BasisWriter::BasisWriter(
     char tmp2[100];
     sprintf(tmp2, "_snapshot.%06d", rank);
     snap_file_name = base_file_name + tmp2;
+
+    // The background thread calls HDF5 while the application may be calling
+    // it as well, which is only safe with a thread-safe HDF5 library.
+    // Otherwise the writes are done synchronously.
+    if (d_async && db_format_ == Database::HDF5) {
+        hbool_t is_threadsafe = 0;
+        CAROM_VERIFY(H5is_library_threadsafe(&is_threadsafe) >= 0);
+        if (!is_threadsafe) {
+            if (rank == 0) {
+                std::cout << "WARNING: HDF5 is not thread-safe, so the basis "
+                          << "is written synchronously." << std::endl;
+            }
+            d_async = false;
+        }
+    }
+
+    if (d_async) {
+        d_write_queue = new WriteQueue(max_pending_writes);
+    }
 }
 
 BasisWriter::~BasisWriter()
 {
+    // Completes the pending writes before the databases are closed.
+    delete d_write_queue;
     if (d_database) {
         d_database->putInteger("num_time_intervals", d_num_intervals_written);
         d_database->close();
@@ -75,73 +102,137 @@ BasisWriter::writeBasis(const std::string& kind)
 
     CAROM_ASSERT(kind == "basis" || kind == "snapshot");
 
-    char tmp[100];
-    double time_interval_start_time =
+    WriteRequest request;
+    request.kind = kind;
+    request.interval = d_num_intervals_written;
+    request.start_time =
         d_basis_generator->getBasisIntervalStartTime(d_num_intervals_written);
-    sprintf(tmp, "time_%06d", d_num_intervals_written);
+    request.basis = NULL;
+    request.temporal_basis = NULL;
+    request.singular_values = NULL;
+    request.snapshots = NULL;
 
+    // The SVD is computed here, on the calling thread, since it may require
+    // communication.
     if (kind == "basis") {
+        request.basis = d_basis_generator->getSpatialBasis();
+        if(d_basis_generator->updateRightSV()) {
+            request.temporal_basis = d_basis_generator->getTemporalBasis();
+        }
+        request.singular_values = d_basis_generator->getSingularValues();
+        ++d_num_intervals_written;
+    }
+
+    if (kind == "snapshot") {
+        request.snapshots = d_basis_generator->getSnapshotMatrix();
+    }
+
+    if (!d_async) {
+        writeRequest(request);
+        return;
+    }
 
-        // create and open basis database
-        if (db_format_ == Database::HDF5) {
-            d_database = new HDFDatabase();
+    // Copy the data, since the generator may overwrite it once the next
+    // time interval starts.
+    if (request.basis) request.basis = new Matrix(*request.basis);
+    if (request.temporal_basis) {
+        request.temporal_basis = new Matrix(*request.temporal_basis);
+    }
+    if (request.singular_values) {
+        request.singular_values = new Vector(*request.singular_values);
+    }
+    if (request.snapshots) request.snapshots = new Matrix(*request.snapshots);
+
+    d_write_queue->push([this, request] {
+        writeRequest(request);
+        delete request.basis;
+        delete request.temporal_basis;
+        delete request.singular_values;
+        delete request.snapshots;
+    });
+}
+
+void
+BasisWriter::flush()
+{
+    if (d_write_queue) {
+        d_write_queue->flush();
+    }
+}
+
+void
+BasisWriter::writeRequest(
+    const WriteRequest& request)
+{
+    char tmp[100];
+    sprintf(tmp, "time_%06d", request.interval);
+
+    if (request.kind == "basis") {
+
+        // create and open basis database on the first write; later time
+        // intervals are added to the same file
+        if (!d_database) {
+            if (db_format_ == Database::HDF5) {
+                d_database = new HDFDatabase();
+            }
+            std::cout << "Creating file: " << full_file_name << std::endl;
+            d_database->create(full_file_name);
         }
-        std::cout << "Creating file: " << full_file_name << std::endl;
-        d_database->create(full_file_name);
 
-        d_database->putDouble(tmp, time_interval_start_time);
+        d_database->putDouble(tmp, request.start_time);
 
-        const Matrix* basis = d_basis_generator->getSpatialBasis();
+        const Matrix* basis = request.basis;
         int num_rows = basis->numRows();
-        sprintf(tmp, "spatial_basis_num_rows_%06d", d_num_intervals_written);
+        sprintf(tmp, "spatial_basis_num_rows_%06d", request.interval);
         d_database->putInteger(tmp, num_rows);
         int num_cols = basis->numColumns();
-        sprintf(tmp, "spatial_basis_num_cols_%06d", d_num_intervals_written);
+        sprintf(tmp, "spatial_basis_num_cols_%06d", request.interval);
         d_database->putInteger(tmp, num_cols);
-        sprintf(tmp, "spatial_basis_%06d", d_num_intervals_written);
+        sprintf(tmp, "spatial_basis_%06d", request.interval);
         d_database->putDoubleArray(tmp, &basis->item(0, 0), num_rows*num_cols);
 
-        if(d_basis_generator->updateRightSV()) {
-            const Matrix* tbasis = d_basis_generator->getTemporalBasis();
+        if(request.temporal_basis) {
+            const Matrix* tbasis = request.temporal_basis;
             num_rows = tbasis->numRows();
-            sprintf(tmp, "temporal_basis_num_rows_%06d", d_num_intervals_written);
+            sprintf(tmp, "temporal_basis_num_rows_%06d", request.interval);
             d_database->putInteger(tmp, num_rows);
             num_cols = tbasis->numColumns();
-            sprintf(tmp, "temporal_basis_num_cols_%06d", d_num_intervals_written);
+            sprintf(tmp, "temporal_basis_num_cols_%06d", request.interval);
             d_database->putInteger(tmp, num_cols);
-            sprintf(tmp, "temporal_basis_%06d", d_num_intervals_written);
+            sprintf(tmp, "temporal_basis_%06d", request.interval);
             d_database->putDoubleArray(tmp, &tbasis->item(0, 0), num_rows*num_cols);
         }
 
-        const Vector* sv = d_basis_generator->getSingularValues();
+        const Vector* sv = request.singular_values;
         int sv_dim = sv->dim();
-        sprintf(tmp, "singular_value_size_%06d", d_num_intervals_written);
+        sprintf(tmp, "singular_value_size_%06d", request.interval);
         d_database->putInteger(tmp, sv_dim);
-        sprintf(tmp, "singular_value_%06d", d_num_intervals_written);
+        sprintf(tmp, "singular_value_%06d", request.interval);
         d_database->putDoubleArray(tmp, &sv->item(0), sv_dim);
 
-        ++d_num_intervals_written;
-
     }
 
-    if (kind == "snapshot") {
-        // create and open snapshot database
-        if (db_format_ == Database::HDF5) {
-            d_snap_database = new HDFDatabase();
+    if (request.kind == "snapshot") {
+        // create and open snapshot database on the first write; later time
+        // intervals are added to the same file
+        if (!d_snap_database) {
+            if (db_format_ == Database::HDF5) {
+                d_snap_database = new HDFDatabase();
+            }
+            std::cout << "Creating file: " << snap_file_name << std::endl;
+            d_snap_database->create(snap_file_name);
         }
-        std::cout << "Creating file: " << snap_file_name << std::endl;
-        d_snap_database->create(snap_file_name);
 
-        d_snap_database->putDouble(tmp, time_interval_start_time);
+        d_snap_database->putDouble(tmp, request.start_time);
 
-        const Matrix* snapshots = d_basis_generator->getSnapshotMatrix();
+        const Matrix* snapshots = request.snapshots;
         int num_rows = snapshots->numRows(); // d_dim
-        sprintf(tmp, "snapshot_matrix_num_rows_%06d", d_num_intervals_written);
+        sprintf(tmp, "snapshot_matrix_num_rows_%06d", request.interval);
         d_snap_database->putInteger(tmp, num_rows);
         int num_cols = snapshots->numColumns(); // d_num_samples
-        sprintf(tmp, "snapshot_matrix_num_cols_%06d", d_num_intervals_written);
+        sprintf(tmp, "snapshot_matrix_num_cols_%06d", request.interval);
         d_snap_database->putInteger(tmp, num_cols);
-        sprintf(tmp, "snapshot_matrix_%06d", d_num_intervals_written);
+        sprintf(tmp, "snapshot_matrix_%06d", request.interval);
         d_snap_database->putDoubleArray(tmp, &snapshots->item(0,0), num_rows*num_cols);
     }
 
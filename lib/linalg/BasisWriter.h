@@ -19,9 +19,20 @@
 namespace CAROM {
 
 class BasisGenerator;
+class Matrix;
+class Vector;
+class WriteQueue;
 
 /**
  * Class BasisWriter writes the basis vectors created by an BasisGenerator.
+ *
+ * In asynchronous mode the data of each write is copied and handed to a
+ * background thread, so that the file I/O overlaps with the simulation. At
+ * most max_pending_writes copies are held at any time; a further write blocks
+ * until the oldest pending write has completed. Since the background thread
+ * calls HDF5 concurrently with the application, asynchronous mode requires a
+ * thread-safe HDF5 library; this is checked at construction, and the writes
+ * fall back to synchronous mode if it is not.
  */
 class BasisWriter {
 public:
@@ -38,11 +49,17 @@ public:
      * @param[in] db_format Format of the file to read.
      *                      One of the implemented file formats defined in
      *                      Database.
+     * @param[in] async Whether to write in a background thread. Ignored if
+     *                  the HDF5 library is not thread-safe.
+     * @param[in] max_pending_writes The maximum number of writes that may be
+     *                               queued in asynchronous mode.
      */
     BasisWriter(
         BasisGenerator* basis_generator,
         const std::string& base_file_name,
-        Database::formats db_format = Database::HDF5);
+        Database::formats db_format = Database::HDF5,
+        bool async = false,
+        int max_pending_writes = 1);
 
     /**
      * @brief Destructor.
@@ -55,6 +72,24 @@ public:
     void
     writeBasis(const std::string& kind = "basis");
 
+    /**
+     * @brief Blocks until all pending asynchronous writes have completed.
+     *        Does nothing in synchronous mode.
+     */
+    void
+    flush();
+
+    /**
+     * @brief Returns true if the writes are done in a background thread,
+     *        which requires that asynchronous mode was requested and that
+     *        the HDF5 library is thread-safe.
+     */
+    bool
+    isAsync() const
+    {
+        return d_async;
+    }
+
 private:
     /**
      * @brief Unimplemented default constructor.
@@ -74,6 +109,29 @@ private:
     operator = (
         const BasisWriter& rhs);
 
+    /**
+     * @brief The data of a single call to writeBasis.
+     */
+    struct WriteRequest
+    {
+        std::string kind;
+        int interval;
+        double start_time;
+        const Matrix* basis;
+        const Matrix* temporal_basis;
+        const Vector* singular_values;
+        const Matrix* snapshots;
+    };
+
+    /**
+     * @brief Writes the data of a request to the basis or snapshot database.
+     *
+     * @param[in] request The data to be written.
+     */
+    void
+    writeRequest(
+        const WriteRequest& request);
+
     /**
      * @brief Basis generator whose basis vectors are being written.
      */
@@ -105,6 +163,17 @@ private:
      * written.
      */
     int d_num_intervals_written;
+
+    /**
+     * @brief Whether writes are done in a background thread.
+     */
+    bool d_async;
+
+    /**
+     * @brief Queue of the asynchronous writes, if writes are done in a
+     *        background thread.
+     */
+    WriteQueue* d_write_queue;
 };
 
 }
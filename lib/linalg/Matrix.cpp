@@ -17,6 +17,7 @@
 
 #include "mpi.h"
 #include <string.h>
+#include <algorithm>
 #include <vector>
 #include <random>
 
@@ -59,6 +60,86 @@ extern "C" {
 
 namespace CAROM {
 
+namespace {
+
+// The payload of the tournament pivoting reduction is the number of
+// candidates and the row length n, followed by the candidates, each its
+// global row index (-1 for none) and that row of the matrix.
+const int tournament_header_size = 2;
+
+// Keep the first num_pivots pivots of a QRCP of the transpose of the
+// num_candidates valid candidates of size 1 + n in candidates, in pivot
+// order, in selected. The remaining entries of selected are set to none.
+void
+selectTournamentPivots(const double* candidates, int num_candidates, int n,
+                       int num_pivots, double* selected)
+{
+    const int candidate_size = 1 + n;
+    std::vector<const double*> valid;
+    for (int i = 0; i < num_candidates; i++)
+    {
+        if (candidates[i*candidate_size] >= 0.0)
+        {
+            valid.push_back(candidates + i*candidate_size);
+        }
+    }
+
+    // Column j of the column major n-by-m matrix is candidate j.
+    int m = valid.size();
+    std::vector<double> scratch(std::max(n*m, 1));
+    for (int j = 0; j < m; j++)
+    {
+        std::copy(valid[j] + 1, valid[j] + candidate_size, &scratch[j*n]);
+    }
+
+    int num_selected = std::min(num_pivots, m);
+    if (m > 0)
+    {
+        int lwork = 20 * m + 1;
+        std::vector<double> work(lwork);
+        std::vector<double> tau(std::min(n, m));
+        std::vector<int> pivot(m, 0);
+        int info;
+        dgeqp3(&n, &m, scratch.data(), &n, pivot.data(), tau.data(),
+               work.data(), &lwork, &info);
+        CAROM_VERIFY(info == 0);
+        for (int i = 0; i < num_selected; i++)
+        {
+            const double* winner = valid[pivot[i] - 1];
+            std::copy(winner, winner + candidate_size,
+                      selected + i*candidate_size);
+        }
+    }
+    for (int i = num_selected; i < num_pivots; i++)
+    {
+        selected[i*candidate_size] = -1.0;
+    }
+}
+
+// Play the candidates of a lower rank, a, against those of a higher rank,
+// b, and keep the winners in b.
+void
+TournamentPivots(double* a, double* b, int* len, MPI_Datatype* type)
+{
+    for (int l = 0; l < *len; l++)
+    {
+        const int num_pivots = static_cast<int>(b[0]);
+        const int n = static_cast<int>(b[1]);
+        const int size = num_pivots * (1 + n);
+        std::vector<double> candidates(2 * size);
+        std::copy(a + tournament_header_size, a + tournament_header_size + size,
+                  candidates.begin());
+        std::copy(b + tournament_header_size, b + tournament_header_size + size,
+                  candidates.begin() + size);
+        selectTournamentPivots(candidates.data(), 2 * num_pivots, n, num_pivots,
+                               b + tournament_header_size);
+        a += tournament_header_size + size;
+        b += tournament_header_size + size;
+    }
+}
+
+}
+
 Matrix::Matrix() :
     d_mat(NULL),
     d_alloc_size(0),
@@ -934,15 +1015,7 @@ Matrix::write(const std::string& base_file_name) const
     std::string full_file_name = base_file_name + tmp;
     HDFDatabase database;
     database.create(full_file_name);
-
-    sprintf(tmp, "distributed");
-    database.putInteger(tmp, d_distributed);
-    sprintf(tmp, "num_rows");
-    database.putInteger(tmp, d_num_rows);
-    sprintf(tmp, "num_cols");
-    database.putInteger(tmp, d_num_cols);
-    sprintf(tmp, "data");
-    database.putDoubleArray(tmp, d_mat, d_num_rows*d_num_cols);
+    write(database, "");
     database.close();
 }
 
@@ -956,11 +1029,9 @@ Matrix::read(const std::string& base_file_name)
     int rank;
     if (mpi_init) {
         MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-        MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
     }
     else {
         rank = 0;
-        d_num_procs = 1;
     }
 
     char tmp[100];
@@ -968,22 +1039,41 @@ Matrix::read(const std::string& base_file_name)
     std::string full_file_name = base_file_name + tmp;
     HDFDatabase database;
     database.open(full_file_name, "r");
+    read(database, "");
+    database.close();
+}
+
+void
+Matrix::write(Database& database, const std::string& prefix) const
+{
+    database.putInteger(prefix + "distributed", d_distributed);
+    database.putInteger(prefix + "num_rows", d_num_rows);
+    database.putInteger(prefix + "num_cols", d_num_cols);
+    database.putDoubleArray(prefix + "data", d_mat, d_num_rows*d_num_cols);
+}
+
+void
+Matrix::read(Database& database, const std::string& prefix)
+{
+    int mpi_init;
+    MPI_Initialized(&mpi_init);
+    if (mpi_init) {
+        MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
+    }
+    else {
+        d_num_procs = 1;
+    }
 
-    sprintf(tmp, "distributed");
     int distributed;
-    database.getInteger(tmp, distributed);
+    database.getInteger(prefix + "distributed", distributed);
     d_distributed = bool(distributed);
     int num_rows;
-    sprintf(tmp, "num_rows");
-    database.getInteger(tmp, num_rows);
+    database.getInteger(prefix + "num_rows", num_rows);
     int num_cols;
-    sprintf(tmp, "num_cols");
-    database.getInteger(tmp, num_cols);
+    database.getInteger(prefix + "num_cols", num_cols);
     setSize(num_rows,num_cols);
-    sprintf(tmp, "data");
-    database.getDoubleArray(tmp, d_mat, d_alloc_size);
+    database.getDoubleArray(prefix + "data", d_mat, num_rows*num_cols);
     d_owns_data = true;
-    database.close();
 }
 
 void
@@ -1232,134 +1322,73 @@ const
     return qrcp_pivots_transpose_distributed_elemental
            (row_pivot, row_pivot_owner, pivots_requested);
 #else
-    qrcp_pivots_transpose_distributed_scalapack
+    qrcp_pivots_transpose_distributed_tournament
     (row_pivot, row_pivot_owner, pivots_requested);
 #endif
 }
 
 void
-Matrix::qrcp_pivots_transpose_distributed_scalapack
+Matrix::qrcp_pivots_transpose_distributed_tournament
 (int* row_pivot, int* row_pivot_owner, int pivots_requested) const
 {
     // Check if distributed; otherwise, use serial implementation
     CAROM_VERIFY(distributed());
-
-    int num_total_rows = d_num_rows;
-    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE,
-                               &num_total_rows,
-                               1,
-                               MPI_INT,
-                               MPI_SUM,
-                               MPI_COMM_WORLD) == MPI_SUCCESS);
-
-    int *row_offset = new int[d_num_procs + 1];
-    row_offset[d_num_procs] = num_total_rows;
+    CAROM_VERIFY(0 < pivots_requested && pivots_requested <= d_num_cols);
 
     int my_rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
 
-    row_offset[my_rank] = d_num_rows;
-
-    CAROM_VERIFY(MPI_Allgather(MPI_IN_PLACE,
-                               1,
-                               MPI_INT,
-                               row_offset,
-                               1,
-                               MPI_INT,
-                               MPI_COMM_WORLD) == MPI_SUCCESS);
-
-    for (int i = d_num_procs - 1; i >= 0; i--) {
-        row_offset[i] = row_offset[i + 1] - row_offset[i];
-    }
-    CAROM_VERIFY(row_offset[0] == 0);
-
-    SLPK_Matrix slpk;
-    int blocksize = row_offset[d_num_procs] / d_num_procs;
-    if (row_offset[d_num_procs] % d_num_procs != 0) blocksize += 1;
-
-    initialize_matrix(&slpk, d_num_cols, row_offset[d_num_procs], 1, d_num_procs, 1,
-                      blocksize);  // transposed
-
-    CAROM_VERIFY(d_num_cols <=
-                 pivots_requested); // Otherwise, take a submatrix for the QR (not implemented).
-
-    for (int rank = 0; rank < d_num_procs; ++rank) {
-        // Take the row-major data in d_mat and put it in a transposed column-major array in slpk
-        scatter_block(&slpk, 1, row_offset[rank]+1,
-                      d_mat,
-                      d_num_cols, row_offset[rank+1] - row_offset[rank],
-                      rank);
-    }
-
-    QRManager QRmgr;
-    qr_init(&QRmgr, &slpk);
-    qrfactorize(&QRmgr);
-
-    // Just gather the pivots to root and discard the factorization
-    CAROM_VERIFY(0 < pivots_requested && pivots_requested <= QRmgr.ipivSize);
-    CAROM_VERIFY(pivots_requested <= std::max(d_num_rows, d_num_cols));
-
-    const int scount = std::max(0, std::min(pivots_requested,
-                                            row_offset[my_rank+1]) - row_offset[my_rank]);
-    int *mypivots = (scount > 0) ? new int[scount] : NULL;
-
-    for (int i=0; i<scount; ++i)
-        mypivots[i] = QRmgr.ipiv[i]-1;  // Make it 0-based
-
-    int *rcount = (my_rank == 0) ? new int[d_num_procs] : NULL;
-    int *rdisp = (my_rank == 0) ? new int[d_num_procs] : NULL;
-
-    MPI_Gather(&scount, 1, MPI_INT, rcount, 1, MPI_INT, 0, MPI_COMM_WORLD);
-
-    if (my_rank == 0)
-    {
-        rdisp[0] = 0;
-        for (int i = 1; i<d_num_procs; ++i)
-            rdisp[i] = rdisp[i-1] + rcount[i-1];
-
-        CAROM_VERIFY(rdisp[d_num_procs-1] + rcount[d_num_procs-1] == pivots_requested);
-    }
-
-    MPI_Gatherv(mypivots, scount, MPI_INT, row_pivot, rcount, rdisp, MPI_INT, 0,
-                MPI_COMM_WORLD);
-
-    delete [] mypivots;
+    std::vector<int> row_offset(d_num_procs + 1, 0);
+    CAROM_VERIFY(MPI_Allgather(&d_num_rows, 1, MPI_INT, row_offset.data() + 1,
+                               1, MPI_INT, MPI_COMM_WORLD) == MPI_SUCCESS);
+    for (int i = 0; i < d_num_procs; i++) {
+        row_offset[i + 1] += row_offset[i];
+    }
+    CAROM_VERIFY(pivots_requested <= row_offset[d_num_procs]);
+
+    // Each process nominates the pivots of a QRCP of the transpose of its
+    // own rows. The nominees of two processes are then played against each
+    // other with a QRCP of the transpose of their rows, and the winners go
+    // on up the reduction tree to the root.
+    const int candidate_size = 1 + d_num_cols;
+    const int payload_size = tournament_header_size +
+                             pivots_requested * candidate_size;
+    std::vector<double> local_rows(d_num_rows * candidate_size);
+    for (int i = 0; i < d_num_rows; i++) {
+        local_rows[i * candidate_size] = row_offset[my_rank] + i;
+        std::copy(d_mat + i * d_num_cols, d_mat + (i + 1) * d_num_cols,
+                  &local_rows[i * candidate_size + 1]);
+    }
+    std::vector<double> local(payload_size), global(payload_size);
+    local[0] = pivots_requested;
+    local[1] = d_num_cols;
+    selectTournamentPivots(local_rows.data(), d_num_rows, d_num_cols,
+                           pivots_requested,
+                           local.data() + tournament_header_size);
+
+    MPI_Datatype payload_type;
+    MPI_Type_contiguous(payload_size, MPI_DOUBLE, &payload_type);
+    MPI_Type_commit(&payload_type);
+    MPI_Op tournament_op;
+    MPI_Op_create((MPI_User_function*)TournamentPivots, false, &tournament_op);
+    MPI_Reduce(local.data(), global.data(), 1, payload_type, tournament_op, 0,
+               MPI_COMM_WORLD);
+    MPI_Op_free(&tournament_op);
+    MPI_Type_free(&payload_type);
 
     if (my_rank == 0)
     {
-        for (int i=0; i<pivots_requested; ++i)
+        for (int i = 0; i < pivots_requested; ++i)
         {
-            row_pivot_owner[i] = -1;
-            for (int j=d_num_procs-1; j>=0; --j)
-            {
-                if (row_offset[j] <= row_pivot[i])
-                {
-                    row_pivot_owner[i] = j;
-                    break;
-                }
-            }
+            row_pivot[i] = static_cast<int>(global[tournament_header_size +
+                                                   i * candidate_size]);
+            CAROM_VERIFY(row_pivot[i] >= 0);
 
             // Note that row_pivot[i] is a global index.
-            CAROM_VERIFY(row_pivot_owner[i] >= 0);
-            CAROM_VERIFY(row_offset[row_pivot_owner[i]] <= row_pivot[i]
-                         && row_pivot[i] < row_offset[row_pivot_owner[i]+1]);
+            row_pivot_owner[i] = std::upper_bound(row_offset.begin(),
+                                                  row_offset.end(), row_pivot[i]) - row_offset.begin() - 1;
         }
     }
-    else
-    {
-        for (int i=0; i<scount; ++i)
-            row_pivot[i] = QRmgr.ipiv[i]-1;  // Make it 0-based
-    }
-
-    free_matrix_data(&slpk);
-    release_context(&slpk);
-
-    free(QRmgr.tau);
-    free(QRmgr.ipiv);
-
-    delete [] rcount;
-    delete [] rdisp;
-    delete [] row_offset;
 }
 
 void
@@ -22,6 +22,8 @@
 
 namespace CAROM {
 
+class Database;
+
 /**
  * Class Matrix is a simple matrix class in which the rows may be distributed
  * across multiple processes. This class supports only the basic operations that
@@ -1046,6 +1048,26 @@ public:
      */
     void read(const std::string& base_file_name);
 
+    /**
+     * @brief write Matrix into an open database, with the keys of its
+     *        entries prefixed by prefix.
+     *
+     * @param[in] database The database to write to.
+     * @param[in] prefix The prefix of the keys of the Matrix entries.
+     *
+     */
+    void write(Database& database, const std::string& prefix) const;
+
+    /**
+     * @brief read Matrix from an open database, with the keys of its
+     *        entries prefixed by prefix.
+     *
+     * @param[in] database The database to read from.
+     * @param[in] prefix The prefix of the keys of the Matrix entries.
+     *
+     */
+    void read(Database& database, const std::string& prefix);
+
     /**
      * @brief read a single rank of a distributed Matrix into (a) HDF file(s).
      *
@@ -1110,8 +1132,27 @@ private:
                                       int* row_pivot_owner,
                                       int  pivots_requested) const;
 
+    /**
+     * @brief Compute the leading column pivots from a QR
+     * decomposition with column pivots (QRCP) of the transpose of
+     * this Matrix by tournament pivoting. Each process selects
+     * candidates by a local QRCP of its rows, and the candidates are
+     * merged by further QRCPs up a reduction tree, so choosing the
+     * pivots takes O(log P) messages.
+     *
+     * @pre distributed()
+     *
+     * @param[out] row_pivot Array of leading column pivots
+     * from QRCP of transpose of this Matrix, has length pivots_requested.
+     * Set on the root process only.
+     * @param[out] row_pivot_owner Array of process rank that owns
+     * each pivot on the communicator owned by this Matrix. Set on the root
+     * process only.
+     * @param[in]  number of pivots requested, must be less than or equal
+     * to the number of columns of this Matrix.
+     */
     void
-    qrcp_pivots_transpose_distributed_scalapack(int* row_pivot,
+    qrcp_pivots_transpose_distributed_tournament(int* row_pivot,
             int* row_pivot_owner,
             int  pivots_requested) const;
 
@@ -65,7 +65,14 @@ NNLSSolver::NNLSSolver(double const_tol, int min_nnz, int max_nnz,
       zero_tol_(zero_tol), n_outer_(n_outer), n_inner_(n_inner),
       n_proc_max_for_partial_matrix_(15),
       NNLS_qrres_on_(false),
-      qr_residual_mode_(QRresidualMode::hybrid)
+      qr_residual_mode_(QRresidualMode::hybrid),
+      warm_start_(false),
+      exit_flag_(1),
+      n_outer_iter_(0),
+      n_inner_iter_(0),
+      ictxt_(-1),
+      n_proc_(0),
+      blacs_initialized_(false)
 {
     MPI_Comm_rank(MPI_COMM_WORLD, &d_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
@@ -74,7 +81,13 @@ NNLSSolver::NNLSSolver(double const_tol, int min_nnz, int max_nnz,
 }
 
 NNLSSolver::~NNLSSolver()
-{}
+{
+    int mpi_finalized;
+    MPI_Finalized(&mpi_finalized);
+    if (blacs_initialized_ && !mpi_finalized && d_rank < n_proc_) {
+        blacs_gridexit_(&ictxt_);
+    }
+}
 
 void NNLSSolver::set_verbosity(const int verbosity_in)
 {
@@ -89,6 +102,11 @@ void NNLSSolver::set_qrresidual_mode(const QRresidualMode qr_residual_mode)
     }
 }
 
+void NNLSSolver::set_warm_start(const bool warm_start)
+{
+    warm_start_ = warm_start;
+}
+
 void NNLSSolver::normalize_constraints(Matrix& matTrans, Vector& rhs_lb,
                                        Vector& rhs_ub)
 {
@@ -153,18 +171,22 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
     int izero = 0;
     int ione = 1;
     double fone = 1.0;
-    int ictxt;
     char lside = 'L';
     char trans = 'T';
     char notrans = 'N';
     char layout = 'R';
 
-    int n_proc = std::min(n_proc_max_for_partial_matrix_,d_num_procs);
     int nb = 3; // block column size
 
-    // initialize blacs process grid
-    blacs_get_(&izero, &izero, &ictxt);
-    blacs_gridinit_(&ictxt, &layout, &ione, &n_proc);
+    // initialize blacs process grid on the first solve; later solves reuse it
+    if (!blacs_initialized_) {
+        n_proc_ = std::min(n_proc_max_for_partial_matrix_,d_num_procs);
+        blacs_get_(&izero, &izero, &ictxt_);
+        blacs_gridinit_(&ictxt_, &layout, &ione, &n_proc_);
+        blacs_initialized_ = true;
+    }
+    int ictxt = ictxt_;
+    int n_proc = n_proc_;
 
     int n_dist_loc_max = 0; // maximum number of columns in distributed matrix
     if (d_rank < n_proc) {
@@ -172,7 +194,6 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
         n_dist_loc_max = ((m/nb + 1)/n_proc + 1)*nb;
     }
 
-    std::vector<double> mu_max_array(d_num_procs);
     std::vector<unsigned int> proc_index;
     std::vector<unsigned int> nz_ind(m);
     Vector res_glob(m, false);
@@ -194,12 +215,16 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
     Vector soln_nz_glob;
     Vector soln_nz_glob_up;
 
-    // The following matrices are stored in column-major format as Vectors
-    Vector mat_0_data(m * n_dist_loc_max, false);
-    Vector mat_qr_data(m * n_dist_loc_max, false);
+    // The following matrices are stored in column-major format as Vectors.
+    // Their storage is kept by the solver and only grows across solves.
+    Vector& mat_0_data = mat_0_data_;
+    Vector& mat_qr_data = mat_qr_data_;
+    mat_0_data.setSize(m * n_dist_loc_max);
+    mat_qr_data.setSize(m * n_dist_loc_max);
 
     int mat_qr_desc[9];
-    Vector tau(n_dist_loc_max, false);
+    Vector& tau = tau_;
+    tau.setSize(n_dist_loc_max);
     Vector vec1;
     int vec1_desc[9];
 
@@ -252,11 +277,127 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
 
     MPI_Allreduce(MPI_IN_PLACE, &mu_tol, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
 
-    double mumax_glob;
+    double mumax_glob = 0.0;
     double rmax;
 
+    // maximum of mu over all processors and the lowest rank holding it
+    struct {
+        double value;
+        int rank;
+    } mumax_loc;
+    // the send of the column selected in the previous outer iteration
+    MPI_Request column_send = MPI_REQUEST_NULL;
+
+    // With a warm start, the support of the input solution is the initial
+    // set of nonzero entries and its entries are the initial feasible
+    // solution. Its columns are moved into the cyclic QR layout at once, and
+    // the first outer iteration solves on them instead of adding a column.
+    bool warm_start_pending = false;
+    if (warm_start_) {
+        std::vector<int> support;
+        for (int i = 0; i < n; ++i) {
+            if (soln(i) > zero_tol_) {
+                support.push_back(i);
+            }
+        }
+        int n_support = support.size();
+        std::vector<int> support_counts(d_num_procs);
+        MPI_Allgather(&n_support, 1, MPI_INT, support_counts.data(), 1, MPI_INT,
+                      MPI_COMM_WORLD);
+        std::vector<int> support_offsets(d_num_procs + 1, 0);
+        for (int i = 0; i < d_num_procs; ++i) {
+            support_offsets[i + 1] = support_offsets[i] + support_counts[i];
+        }
+        int n_support_glob = support_offsets[d_num_procs];
+
+        // A support with as many columns as constraints is not a least
+        // squares problem; start from scratch instead.
+        if (n_support_glob > 0 && n_support_glob < m) {
+            warm_start_pending = true;
+
+            // The support columns are ordered by processor, then by local
+            // index. Column g of the global matrix goes to processor
+            // (g/nb) % n_proc.
+            std::vector<MPI_Request> requests;
+            for (int k = 0; k < n_support; ++k) {
+                nz_ind[k] = support[k];
+                int g = support_offsets[d_rank] + k;
+                int proc_to_recv = (g/nb) % n_proc;
+                if (proc_to_recv == d_rank) {
+                    int n_orig = numroc_(&g, &nb, &d_rank, &izero, &n_proc);
+                    for (int i=0; i<m; ++i)
+                        mat_0_data(i + (n_orig*m)) = matTrans(support[k],i);
+                } else {
+                    requests.push_back(MPI_REQUEST_NULL);
+                    MPI_Isend(matTrans.getData() + m*support[k], m, MPI_DOUBLE,
+                              proc_to_recv, 190, MPI_COMM_WORLD, &requests.back());
+                }
+            }
+            n_nz_ind = n_support;
+
+            if (d_rank < n_proc) {
+                int proc = 0;
+                for (int g = 0; g < n_support_glob; ++g) {
+                    while (g >= support_offsets[proc + 1]) {
+                        ++proc;
+                    }
+                    if ((g/nb) % n_proc == d_rank && proc != d_rank) {
+                        int n_orig = numroc_(&g, &nb, &d_rank, &izero, &n_proc);
+                        requests.push_back(MPI_REQUEST_NULL);
+                        MPI_Irecv(mat_0_data.getData() + m*n_orig, m, MPI_DOUBLE, proc,
+                                  190, MPI_COMM_WORLD, &requests.back());
+                    }
+                }
+            }
+            MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+            if (d_rank < n_proc) {
+                int n_loc = numroc_(&n_support_glob, &nb, &d_rank, &izero, &n_proc);
+                for (int i=0; i<m*n_loc; ++i)
+                    mat_qr_data(i) = mat_0_data(i);
+            }
+
+            // the root process holds the owner and the value of each column
+            std::vector<double> support_values(std::max(n_support, 1));
+            for (int k = 0; k < n_support; ++k) {
+                support_values[k] = soln(support[k]);
+            }
+            MPI_Gatherv(support_values.data(), n_support, MPI_DOUBLE,
+                        soln_nz_glob.getData(), support_counts.data(),
+                        support_offsets.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            if (d_rank == 0) {
+                for (int i = 0; i < d_num_procs; ++i) {
+                    for (int g = support_offsets[i]; g < support_offsets[i + 1]; ++g) {
+                        proc_index[g] = i;
+                    }
+                }
+            }
+            n_glob = n_support_glob;
+
+            // The first outer iteration checks the residual of the warm start
+            // solution, not that of the zero solution.
+            if (d_rank < n_proc) {
+                descinit_(mat_qr_desc, &m, &n_glob, &m, &nb, &izero, &izero, &ictxt, &m, &info);
+                CAROM_VERIFY(info == 0); // mat_qr descriptor initialization failed
+                double fmone = -1.0;
+                pdgemv_( &notrans, &m, &n_glob, &fmone,
+                         mat_0_data.getData(), &ione, &ione, mat_qr_desc,
+                         soln_nz_glob.getData(), &ione, &ione, vec1_desc, &ione, &fone,
+                         res_glob.getData(), &ione, &ione, vec1_desc, &ione);
+            }
+            MPI_Bcast(res_glob.getData(), m, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+            if (d_rank == 0 && verbosity_ > 1) {
+                printf("warm start with %d nonzero entries\n", n_glob);
+                fflush(stdout);
+            }
+        }
+    }
+
     for (unsigned int oiter = 0; oiter < n_outer_; ++oiter) {
         stalledFlag = 0;
+        const bool warm_iter = warm_start_pending;
+        warm_start_pending = false;
 
         rmax = fabs(res_glob(0)) - rhs_halfgap_glob(0);
         for (int i=1; i<m; ++i)
@@ -270,7 +411,7 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
                    m, n_tot, n_glob, rmax, l2_res_hist(oiter));
             fflush(stdout);
         }
-        if (rmax <= const_tol_ && n_glob >= min_nnz_cap) {
+        if (!warm_iter && rmax <= const_tol_ && n_glob >= min_nnz_cap) {
             if (d_rank == 0 && verbosity_ > 1) {
                 printf("target tolerance met\n");
                 fflush(stdout);
@@ -279,7 +420,7 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
             break;
         }
 
-        if (n_glob >= max_nnz_) {
+        if (!warm_iter && n_glob >= max_nnz_) {
             if (d_rank == 0 && verbosity_ > 1) {
                 printf("target nnz met\n");
                 fflush(stdout);
@@ -288,7 +429,7 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
             break;
         }
 
-        if (n_glob >= m) {
+        if (!warm_iter && n_glob >= m) {
             if (d_rank == 0 && verbosity_ > 1) {
                 printf("system is square... exiting\n");
                 fflush(stdout);
@@ -319,138 +460,132 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
             }
         }
 
-        // find the next index
-        //mu = mat.t()*res_glob;
-        //mat.transposeMult(res_glob, mu);
-        matTrans.mult(res_glob, mu);
-
-        for (int i = 0; i < n_nz_ind; ++i) {
-            mu(nz_ind[i]) = 0.0;
-        }
-        for (unsigned int i = 0; i < stalled_indices.size(); ++i) {
-            mu(stalled_indices[i]) = 0.0;
-        }
+        int imax = 0;
+        int imax_proc = -1; // processor to which the next index belongs
+        if (warm_iter) {
+            // solve on the whole warm start support
+            i_qr_start = 0;
+        } else {
+            // find the next index
+            //mu = mat.t()*res_glob;
+            //mat.transposeMult(res_glob, mu);
+            matTrans.mult(res_glob, mu);
 
-        //double mumax = (mu.n_elem > 0) ? arma::max(mu) : 0.0;
-        double mumax = mu(0);
-        for (int i=1; i<n; ++i)
-            mumax = std::max(mumax, mu(i));
+            for (int i = 0; i < n_nz_ind; ++i) {
+                mu(nz_ind[i]) = 0.0;
+            }
+            for (unsigned int i = 0; i < stalled_indices.size(); ++i) {
+                mu(stalled_indices[i]) = 0.0;
+            }
 
-        mumax_glob = mumax;
+            //double mumax = (mu.n_elem > 0) ? arma::max(mu) : 0.0;
+            double mumax = mu(0);
+            for (int i=1; i<n; ++i)
+                mumax = std::max(mumax, mu(i));
 
-        MPI_Allreduce(MPI_IN_PLACE, &mumax_glob, 1, MPI_DOUBLE, MPI_MAX,
-                      MPI_COMM_WORLD);
-        if (mumax_glob < mu_tol) {
-            num_stalled = stalled_indices.size();
-            MPI_Allreduce(&num_stalled, &num_stalled_glob, 1, MPI_INT, MPI_SUM,
+            // A single reduction gives both the maximum and its processor.
+            // Ties go to the lowest rank.
+            mumax_loc.value = mumax;
+            mumax_loc.rank = d_rank;
+            MPI_Allreduce(MPI_IN_PLACE, &mumax_loc, 1, MPI_DOUBLE_INT, MPI_MAXLOC,
                           MPI_COMM_WORLD);
-            if (num_stalled_glob > 0) {
-                if (verbosity_ > 0 && d_rank == 0) {
-                    std::cout << "Lagrange multiplier is below the minimum threshold: mumax = " <<
-                              mumax_glob << ", mutol = " << mu_tol << "\n" <<
-                              " Resetting stalled indices vector of size " << num_stalled_glob << "\n";
-                }
-                stalled_indices.resize(0);
+            mumax_glob = mumax_loc.value;
+            if (mumax_glob < mu_tol) {
+                num_stalled = stalled_indices.size();
+                MPI_Allreduce(&num_stalled, &num_stalled_glob, 1, MPI_INT, MPI_SUM,
+                              MPI_COMM_WORLD);
+                if (num_stalled_glob > 0) {
+                    if (verbosity_ > 0 && d_rank == 0) {
+                        std::cout << "Lagrange multiplier is below the minimum threshold: mumax = " <<
+                                  mumax_glob << ", mutol = " << mu_tol << "\n" <<
+                                  " Resetting stalled indices vector of size " << num_stalled_glob << "\n";
+                    }
+                    stalled_indices.resize(0);
 
-                //mat.transposeMult(res_glob, mu);
-                matTrans.mult(res_glob, mu);
+                    //mat.transposeMult(res_glob, mu);
+                    matTrans.mult(res_glob, mu);
 
-                for (int i = 0; i < n_nz_ind; ++i) {
-                    mu(nz_ind[i]) = 0.0;
-                }
+                    for (int i = 0; i < n_nz_ind; ++i) {
+                        mu(nz_ind[i]) = 0.0;
+                    }
 
-                //mumax = (mu.n_elem > 0) ? arma::max(mu) : 0.0;
-                mumax = mu(0);
-                for (int i=1; i<n; ++i)
-                    mumax = std::max(mumax, mu(i));
+                    //mumax = (mu.n_elem > 0) ? arma::max(mu) : 0.0;
+                    mumax = mu(0);
+                    for (int i=1; i<n; ++i)
+                        mumax = std::max(mumax, mu(i));
 
-                mumax_glob = mumax;
-                MPI_Allreduce(MPI_IN_PLACE, &mumax_glob, 1, MPI_DOUBLE, MPI_MAX,
-                              MPI_COMM_WORLD);
-            }
-        }
-
-        int imax = 0;
-        {
-            double tmax = mu(0);
-            for (int i=1; i<n; ++i)
-            {
-                if (mu(i) > tmax)
-                {
-                    tmax = mu(i);
-                    imax = i;
+                    mumax_loc.value = mumax;
+                    mumax_loc.rank = d_rank;
+                    MPI_Allreduce(MPI_IN_PLACE, &mumax_loc, 1, MPI_DOUBLE_INT, MPI_MAXLOC,
+                                  MPI_COMM_WORLD);
+                    mumax_glob = mumax_loc.value;
                 }
             }
-        }
+            imax_proc = mumax_loc.rank;
 
-        //int imax = (mu.n_elem > 0) ? arma::index_max(mu) : -1;
-        MPI_Gather(&mumax, 1, MPI_DOUBLE, mu_max_array.data(), 1, MPI_DOUBLE, 0,
-                   MPI_COMM_WORLD);
-        int imax_proc; // processor to which the next index belongs
-        if (d_rank == 0) {
-            //imax_proc = arma::index_max(mu_max_array);
-            imax_proc = 0;
-            double tmax = mu_max_array[0];
-            for (int i=1; i<d_num_procs; ++i)
-            {
-                if (tmax < mu_max_array[i])
+            if (imax_proc == d_rank) {
+                double tmax = mu(0);
+                for (int i=1; i<n; ++i)
                 {
-                    tmax = mu_max_array[i];
-                    imax_proc = i;
+                    if (mu(i) > tmax)
+                    {
+                        tmax = mu(i);
+                        imax = i;
+                    }
                 }
-            }
 
-            proc_index[n_glob] = imax_proc;
-        }
-        MPI_Bcast(&imax_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-        if (imax_proc == d_rank) {
-            // record the local value of the next index
-            nz_ind[n_nz_ind] = imax;
-            ++n_nz_ind;
-            // previous info
-        }
+                // record the local value of the next index
+                nz_ind[n_nz_ind] = imax;
+                ++n_nz_ind;
+            }
+            if (d_rank == 0) {
+                proc_index[n_glob] = imax_proc;
+            }
 
-        if (d_rank == imax_proc && verbosity_ > 2) {
-            printf("found next index: %d %d %.15e\n", imax_proc, imax, mumax);
-            fflush(stdout);
-        }
+            if (d_rank == imax_proc && verbosity_ > 2) {
+                printf("found next index: %d %d %.15e\n", imax_proc, imax, mumax);
+                fflush(stdout);
+            }
 
-        // send and recv the next column
-        // recall that mat_0 and mat_qr are distributed using the cyclic format
-        int proc_to_recv = (n_glob/nb) % n_proc; // proc to receive the new column
-        if (proc_to_recv == imax_proc) {
-            if (imax_proc == d_rank) {
-                // local copy
-                int n_orig = numroc_(&n_glob, &nb, &d_rank, &izero, &n_proc);
-                for (int i=0; i<m; ++i)
-                {
-                    //mat_0_data(i + (n_orig*m)) = mat(i,imax);
-                    mat_0_data(i + (n_orig*m)) = matTrans(imax,i);
-                    mat_qr_data(i + (n_orig*m)) = mat_0_data(i + (n_orig*m));
+            // send and recv the next column
+            // recall that mat_0 and mat_qr are distributed using the cyclic format
+            int proc_to_recv = (n_glob/nb) % n_proc; // proc to receive the new column
+            if (proc_to_recv == imax_proc) {
+                if (imax_proc == d_rank) {
+                    // local copy
+                    int n_orig = numroc_(&n_glob, &nb, &d_rank, &izero, &n_proc);
+                    for (int i=0; i<m; ++i)
+                    {
+                        //mat_0_data(i + (n_orig*m)) = mat(i,imax);
+                        mat_0_data(i + (n_orig*m)) = matTrans(imax,i);
+                        mat_qr_data(i + (n_orig*m)) = mat_0_data(i + (n_orig*m));
+                    }
+                }
+            } else {
+                // exchange data
+                if (imax_proc == d_rank) {
+                    // The column is read-only, so the send is completed only
+                    // before the next one and overlaps the QR update.
+                    MPI_Wait(&column_send, MPI_STATUS_IGNORE);
+                    MPI_Isend(matTrans.getData() + m*imax, m, MPI_DOUBLE, proc_to_recv, 189,
+                              MPI_COMM_WORLD, &column_send);
+                }
+                if (proc_to_recv == d_rank) {
+                    // recieve the matrix entry
+                    MPI_Status mpi_stat;
+                    int n_orig = numroc_(&n_glob, &nb, &d_rank, &izero, &n_proc);
+                    MPI_Recv(mat_0_data.getData() + m*n_orig, m, MPI_DOUBLE, imax_proc, 189,
+                             MPI_COMM_WORLD, &mpi_stat);
+                    // copy the entry to the qr matrix
+                    //mat_qr.col(n_orig) = mat_0.col(n_orig);
+                    for (int i=0; i<m; ++i)
+                        mat_qr_data(i + (n_orig*m)) = mat_0_data(i + (n_orig*m));
                 }
             }
-        } else {
-            // exchange data
-            if (proc_to_recv == d_rank) {
-                // recieve the matrix entry
-                MPI_Status mpi_stat;
-                int n_orig = numroc_(&n_glob, &nb, &d_rank, &izero, &n_proc);
-                MPI_Recv(mat_0_data.getData() + m*n_orig, m, MPI_DOUBLE, imax_proc, 189,
-                         MPI_COMM_WORLD, &mpi_stat);
-                // copy the entry to the qr matrix
-                //mat_qr.col(n_orig) = mat_0.col(n_orig);
-                for (int i=0; i<m; ++i)
-                    mat_qr_data(i + (n_orig*m)) = mat_0_data(i + (n_orig*m));
-            }
-            if (imax_proc == d_rank) {
-                // send the partial matrix
-                MPI_Send(matTrans.getData() + m*imax, m, MPI_DOUBLE, proc_to_recv, 189,
-                         MPI_COMM_WORLD);
-            }
-        }
 
-        i_qr_start = n_glob;
-        ++n_glob; // increment the size of the global matrix
+            i_qr_start = n_glob;
+            ++n_glob; // increment the size of the global matrix
+        }
 
         if (d_rank == 0 && verbosity_ > 2) {
             printf("updated matrix with new index\n");
@@ -527,18 +662,19 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
                     fflush(stdout);
                 }
 
-                // apply householder reflectors to compute Q^T b
+                // apply the householder reflectors of the new columns, which
+                // are all the support columns on a warm start, to compute Q^T b
                 if (incremental_update && iiter == 0) {
                     lwork = -1;
                     work.resize(10);
-                    pdormqr_(&lside, &trans, &m_update, &ione, &ione,
+                    pdormqr_(&lside, &trans, &m_update, &ione, &n_update,
                              mat_qr_data.getData(), &i_qr_start_f, &i_qr_start_f, mat_qr_desc, tau.getData(),
                              qt_rhs_glob.getData(), &i_qr_start_f, &ione, vec1_desc,
                              work.data(), &lwork, &info);
                     CAROM_VERIFY(info == 0); // H_last y work calculation failed
                     lwork = static_cast<int>(work[0]);
                     work.resize(lwork);
-                    pdormqr_(&lside, &trans, &m_update, &ione, &ione,
+                    pdormqr_(&lside, &trans, &m_update, &ione, &n_update,
                              mat_qr_data.getData(), &i_qr_start_f, &i_qr_start_f, mat_qr_desc, tau.getData(),
                              qt_rhs_glob.getData(), &i_qr_start_f, &ione, vec1_desc,
                              work.data(), &lwork, &info);
@@ -613,7 +749,7 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
             }
 
             if (d_rank == 0) {
-                if (soln_nz_glob_up(n_glob - 1) <= zero_tol_) {
+                if (!warm_iter && soln_nz_glob_up(n_glob - 1) <= zero_tol_) {
                     stalledFlag = 1;
                     if (verbosity_ > 2) {
                         if (qr_residual_mode_ == QRresidualMode::hybrid) {
@@ -834,6 +970,7 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
 
         ++n_outer_iter;
     } // end of outer loop
+    MPI_Wait(&column_send, MPI_STATUS_IGNORE);
 
     /* TODO (skipping this for now, as it's just verbose output)
     if (d_rank == 0 && verbosity_ > 1) {
@@ -885,9 +1022,9 @@ void NNLSSolver::solve_parallel_with_scalapack(const Matrix& matTrans,
 
     blacs_freebuff_(&ictxt, &ione);
 
-    if (d_rank < n_proc) {
-        blacs_gridexit_(&ictxt);
-    }
+    exit_flag_ = exit_flag;
+    n_outer_iter_ = n_outer_iter;
+    n_inner_iter_ = n_total_inner_iter;
 
     if (d_rank == 0 && verbosity_ > 0) {
         printf("NNLS solver: m = %d, n = %d, outer_iter = %d, inner_iter = %d", m,
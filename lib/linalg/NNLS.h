@@ -63,6 +63,14 @@ public:
      */
     void set_qrresidual_mode(const QRresidualMode qr_residual_mode);
 
+    /**
+     * Set whether solve_parallel_with_scalapack is warm started. If true, the
+     * active-set iterations start from the entries of the input soln greater
+     * than the zero tolerance, typically the solution of a previous, closely
+     * related problem, instead of from an empty set. The default is false.
+     */
+    void set_warm_start(const bool warm_start);
+
     /**
      * Solve the NNLS problem. Specifically, we find a vector soln, such that
      * rhs_lb < mat*soln < rhs_ub is satisfied. The matrix should hold a column
@@ -96,6 +104,29 @@ public:
         return d_num_procs;
     };
 
+    /**
+     * Get the exit flag of the last solve: 0 if it converged, 1 if it reached
+     * the maximum number of iterations, 2 if it stalled and 3 if it selected
+     * as many columns as there are constraints.
+     */
+    inline int getExitFlag() const {
+        return exit_flag_;
+    };
+
+    /**
+     * Get the number of outer iterations of the last solve.
+     */
+    inline int getNumOuterIterations() const {
+        return n_outer_iter_;
+    };
+
+    /**
+     * Get the total number of inner iterations of the last solve.
+     */
+    inline int getNumInnerIterations() const {
+        return n_inner_iter_;
+    };
+
 private:
     unsigned int n_outer_;
     unsigned int n_inner_;
@@ -122,6 +153,38 @@ private:
     bool NNLS_qrres_on_;
     QRresidualMode qr_residual_mode_;
 
+    bool warm_start_;
+
+    /**
+     * @brief Exit flag and numbers of outer and inner iterations of the last
+     * solve.
+     */
+    int exit_flag_;
+    int n_outer_iter_;
+    int n_inner_iter_;
+
+    /**
+     * @brief BLACS context of the process grid, created by the first solve
+     * and reused by the later ones.
+     */
+    int ictxt_;
+
+    /**
+     * @brief Number of processors in the BLACS process grid.
+     */
+    int n_proc_;
+
+    bool blacs_initialized_;
+
+    /**
+     * @brief Block cyclic column distributed matrix of the selected columns,
+     * its QR factorization and the Householder scalars, stored in
+     * column-major format and kept across solves.
+     */
+    Vector mat_0_data_;
+    Vector mat_qr_data_;
+    Vector tau_;
+
     int d_num_procs;
     int d_rank;
 };
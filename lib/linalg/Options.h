@@ -159,13 +159,15 @@ public:
     }
 
     /**
-     * @brief Sets the state IO parameters of the incremental SVD algorithm.
+     * @brief Sets the state IO parameters of the SVD algorithm.
      *
      * @param[in] save_state_ If true the state of the SVD will be written to
-     *                       disk when the object is deleted.  If there are
-     *                       multiple time intervals then the state will not
-     *                       be saved as restoring such a state makes no
-     *                       sense.
+     *                       disk when the object is deleted.  For the
+     *                       incremental SVD, if there are multiple time
+     *                       intervals then the state will not be saved as
+     *                       restoring such a state makes no sense.  For the
+     *                       static and randomized SVD, the samples of the
+     *                       current time interval are saved.
      * @param[in] restore_state_ If true the state of the SVD will be restored
      *                          when the object is created.
      */
@@ -208,6 +210,30 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets whether the basis and snapshot files are written
+     *        asynchronously.
+     *
+     * @pre max_pending_writes_ > 0
+     *
+     * @param[in] async_write_ If true, the data written at the start of a new
+     *                         time interval is handed to a background thread
+     *                         so that the writes overlap with the simulation.
+     *                         Requires a thread-safe HDF5 library; the
+     *                         writes are synchronous otherwise.
+     * @param[in] max_pending_writes_ The maximum number of writes whose data
+     *                                is held in memory at any time.
+     */
+    Options setAsyncWrite(
+        bool async_write_,
+        int max_pending_writes_ = 1
+    )
+    {
+        async_write = async_write_;
+        max_pending_writes = max_pending_writes_;
+        return *this;
+    }
+
     /**
      * @brief The dimension of the system on this processor.
      */
@@ -233,6 +259,16 @@ public:
      */
     bool write_snapshots = false;
 
+    /**
+     * @brief Whether to write bases or snapshots in a background thread.
+     */
+    bool async_write = false;
+
+    /**
+     * @brief The maximum number of asynchronous writes held in memory.
+     */
+    int max_pending_writes = 1;
+
     /**
      * @brief The maximum dimension of the basis.
      */
@@ -306,16 +342,16 @@ public:
     bool skip_linearly_dependent = false;
 
     /**
-     * @brief If true the state of the incremental SVD will be written to
-     *        disk when the object is deleted.  If there are
-     *        multiple time intervals then the state will not
+     * @brief If true the state of the SVD will be written to
+     *        disk when the object is deleted.  For the incremental SVD, if
+     *        there are multiple time intervals then the state will not
      *        be saved as restoring such a state makes no
      *        sense.
      */
     bool save_state = false;
 
     /**
-     * @brief If true the state of the incremental SVD will be restored when the
+     * @brief If true the state of the SVD will be restored when the
      *        object is created.
      */
     bool restore_state = false;
@@ -462,16 +462,18 @@ Vector::write(const std::string& base_file_name)
     std::string full_file_name = base_file_name + tmp;
     HDFDatabase database;
     database.create(full_file_name);
-
-    sprintf(tmp, "distributed");
-    database.putInteger(tmp, d_distributed);
-    sprintf(tmp, "dim");
-    database.putInteger(tmp, d_dim);
-    sprintf(tmp, "data");
-    database.putDoubleArray(tmp, d_vec, d_dim);
+    write(database, "");
     database.close();
 }
 
+void
+Vector::write(Database& database, const std::string& prefix) const
+{
+    database.putInteger(prefix + "distributed", d_distributed);
+    database.putInteger(prefix + "dim", d_dim);
+    database.putDoubleArray(prefix + "data", d_vec, d_dim);
+}
+
 void
 Vector::print(const char * prefix)
 {
@@ -508,25 +510,30 @@ Vector::read(const std::string& base_file_name)
     std::string full_file_name = base_file_name + tmp;
     HDFDatabase database;
     database.open(full_file_name, "r");
+    read(database, "");
+    database.close();
+}
 
-    sprintf(tmp, "distributed");
+void
+Vector::read(Database& database, const std::string& prefix)
+{
     int distributed;
-    database.getInteger(tmp, distributed);
+    database.getInteger(prefix + "distributed", distributed);
     d_distributed = bool(distributed);
     int dim;
-    sprintf(tmp, "dim");
-    database.getInteger(tmp, dim);
+    database.getInteger(prefix + "dim", dim);
     setSize(dim);
-    sprintf(tmp, "data");
-    database.getDoubleArray(tmp, d_vec, d_alloc_size);
+    database.getDoubleArray(prefix + "data", d_vec, dim);
     d_owns_data = true;
+
+    int mpi_init;
+    MPI_Initialized(&mpi_init);
     if (mpi_init) {
         MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
     }
     else {
         d_num_procs = 1;
     }
-    database.close();
 }
 
 void
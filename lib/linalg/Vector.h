@@ -21,6 +21,8 @@
 
 namespace CAROM {
 
+class Database;
+
 /**
  * Class Vector is a simple vector class in which the dimensions may be
  * distributed across multiple processes.  This class supports only the basic
@@ -733,6 +735,26 @@ public:
      */
     void read(const std::string& base_file_name);
 
+    /**
+     * @brief write Vector into an open database, with the keys of its
+     *        entries prefixed by prefix.
+     *
+     * @param[in] database The database to write to.
+     * @param[in] prefix The prefix of the keys of the Vector entries.
+     *
+     */
+    void write(Database& database, const std::string& prefix) const;
+
+    /**
+     * @brief read Vector from an open database, with the keys of its
+     *        entries prefixed by prefix.
+     *
+     * @param[in] database The database to read from.
+     * @param[in] prefix The prefix of the keys of the Vector entries.
+     *
+     */
+    void read(Database& database, const std::string& prefix);
+
     /**
      * @brief read read a single rank of a distributed Vector from (a) HDF file(s).
      *
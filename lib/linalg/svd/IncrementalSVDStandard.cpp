@@ -70,12 +70,11 @@ IncrementalSVDStandard::buildInitialSVD(
     // We have a new time interval.
 
     // If this is not the first time interval then write the basis vectors for
-    // the just completed interval.  Delete d_basis and d_S of the just
-    // completed time interval.
+    // the just completed interval.  Delete d_S of the just completed time
+    // interval; d_basis is replaced by computeBasis.
     int num_time_intervals =
         static_cast<int>(d_time_interval_start_times.size());
     if (num_time_intervals > 0) {
-        delete d_basis;
         delete d_U;
         delete d_S;
         delete d_W;
@@ -106,6 +105,7 @@ IncrementalSVDStandard::buildInitialSVD(
 
     // We now have the first sample for the new time interval.
     d_num_samples = 1;
+    d_num_rows_of_W = 1;
 }
 
 void
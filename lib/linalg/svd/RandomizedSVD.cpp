@@ -26,8 +26,9 @@
 namespace CAROM {
 
 RandomizedSVD::RandomizedSVD(
-    Options options) :
-    StaticSVD(options),
+    Options options,
+    const std::string& basis_file_name) :
+    StaticSVD(options, basis_file_name),
     d_subspace_dim(options.randomized_subspace_dim) {
     srand(options.random_seed);
 }
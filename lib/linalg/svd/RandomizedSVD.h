@@ -40,9 +40,12 @@ private:
      *
      * @param[in] options The struct containing the options for this SVD
      *                    implementation.
+     * @param[in] basis_file_name The base part of the name of the file
+     *                            containing the basis vectors.
      */
     RandomizedSVD(
-        Options options
+        Options options,
+        const std::string& basis_file_name = ""
     );
 
     /**
@@ -15,8 +15,14 @@
 
 #include "mpi.h"
 #include "linalg/scalapack_wrapper.h"
+#include "utils/HDFDatabase.h"
+#include "utils/Utilities.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
 #include <limits.h>
+#include <sstream>
 
 #include <stdio.h>
 #include <string.h>
@@ -33,12 +39,14 @@ extern "C" {
 namespace CAROM {
 
 StaticSVD::StaticSVD(
-    Options options) :
+    Options options,
+    const std::string& basis_file_name) :
     SVD(options),
     d_samples(new SLPK_Matrix), d_factorizer(new SVDManager),
     d_this_interval_basis_current(false),
     d_max_basis_dimension(options.max_basis_dimension),
-    d_singular_value_tol(options.singular_value_tol)
+    d_singular_value_tol(options.singular_value_tol),
+    d_save_state(options.save_state)
 {
     // Get the rank of this process, and the number of processors.
     int mpi_init;
@@ -62,10 +70,26 @@ StaticSVD::StaticSVD(
     initialize_matrix(d_samples.get(), d_total_dim, d_samples_per_time_interval,
                       d_nprow, d_npcol, d_blocksize, d_blocksize);  // TODO: should nb = 1?
     d_factorizer->A = nullptr;
+
+    if (!basis_file_name.empty()) {
+        std::ostringstream tmp;
+        tmp << basis_file_name << ".state." <<
+            std::setw(6) << std::setfill('0') << d_rank;
+        d_state_file_name = tmp.str();
+    }
+    if (options.restore_state) {
+        CAROM_VERIFY(!d_state_file_name.empty());
+        restoreState();
+    }
 }
 
 StaticSVD::~StaticSVD()
 {
+    // Save the samples of the last time interval if requested.  The bases of
+    // the earlier time intervals have already been written.
+    if (d_save_state && d_num_samples > 0 && !d_state_file_name.empty()) {
+        saveState();
+    }
     delete_samples();
     delete_factorizer();
 }
@@ -113,32 +137,7 @@ StaticSVD::takeSample(
     }
 
     if (isNewTimeInterval()) {
-        // We have a new time interval.
-        delete_factorizer();
-        int num_time_intervals =
-            static_cast<int>(d_time_interval_start_times.size());
-        if (num_time_intervals > 0) {
-            delete d_basis;
-            d_basis = nullptr;
-            delete d_basis_right;
-            d_basis_right = nullptr;
-            delete d_U;
-            d_U = nullptr;
-            delete d_S;
-            d_S = nullptr;
-            delete d_W;
-            d_W = nullptr;
-            delete d_snapshots;
-            d_snapshots = nullptr;
-        }
-        d_num_samples = 0;
-        increaseTimeInterval();
-        d_time_interval_start_times[static_cast<unsigned>(num_time_intervals)] =
-            time;
-        d_basis = nullptr;
-        d_basis_right = nullptr;
-        // Set the N in the global matrix so BLACS won't complain.
-        d_samples->n = d_samples_per_time_interval;
+        startTimeInterval(time);
     }
     broadcast_sample(u_in);
     ++d_num_samples;
@@ -156,6 +155,73 @@ StaticSVD::takeSample(
     return true;
 }
 
+int
+StaticSVD::takeSamples(
+    const Matrix& samples,
+    int num_samples,
+    const Vector* scale,
+    double time)
+{
+    CAROM_VERIFY(samples.numRows() == d_dim);
+    CAROM_VERIFY(0 <= num_samples && num_samples <= samples.numColumns());
+    CAROM_VERIFY(scale == nullptr || scale->dim() >= num_samples);
+    CAROM_VERIFY(time >= 0.0);
+
+    // Transpose the local rows into a column major block, scaling each
+    // column as it is copied, and accumulate the squared column norms.
+    std::vector<double> block(static_cast<size_t>(d_dim)*num_samples);
+    std::vector<double> norms(static_cast<size_t>(num_samples), 0.0);
+    for (int i = 0; i < d_dim; ++i) {
+        for (int j = 0; j < num_samples; ++j) {
+            double value = samples.item(i, j);
+            if (scale != nullptr) {
+                value *= scale->item(j);
+            }
+            block[static_cast<size_t>(j)*d_dim + i] = value;
+            norms[j] += value*value;
+        }
+    }
+    if (num_samples > 0) {
+        CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, norms.data(), num_samples,
+                                   MPI_DOUBLE, MPI_SUM,
+                                   MPI_COMM_WORLD) == MPI_SUCCESS);
+    }
+
+    // Drop the zero columns, which takeSample would reject.
+    int num_taken = 0;
+    for (int j = 0; j < num_samples; ++j) {
+        if (norms[j] == 0.0) {
+            continue;
+        }
+        if (num_taken != j) {
+            std::copy(block.begin() + static_cast<size_t>(j)*d_dim,
+                      block.begin() + static_cast<size_t>(j+1)*d_dim,
+                      block.begin() + static_cast<size_t>(num_taken)*d_dim);
+        }
+        ++num_taken;
+    }
+
+    // Scatter as many columns as fit in the current time interval at once.
+    int offset = 0;
+    while (offset < num_taken) {
+        if (isNewTimeInterval()) {
+            startTimeInterval(time);
+        }
+        int num_cols = std::min(num_taken - offset,
+                                d_samples_per_time_interval - d_num_samples);
+        const double* cols = block.data() + static_cast<size_t>(offset)*d_dim;
+        for (int rank = 0; rank < d_num_procs; ++rank) {
+            scatter_block(d_samples.get(), d_istarts[static_cast<unsigned>(rank)]+1,
+                          d_num_samples+1, cols,
+                          d_dims[static_cast<unsigned>(rank)], num_cols, rank);
+        }
+        d_num_samples += num_cols;
+        offset += num_cols;
+        d_this_interval_basis_current = false;
+    }
+    return num_taken;
+}
+
 const Matrix*
 StaticSVD::getSpatialBasis()
 {
@@ -326,6 +392,36 @@ StaticSVD::computeSVD()
     }
 }
 
+void
+StaticSVD::startTimeInterval(double time)
+{
+    delete_factorizer();
+    int num_time_intervals =
+        static_cast<int>(d_time_interval_start_times.size());
+    if (num_time_intervals > 0) {
+        delete d_basis;
+        d_basis = nullptr;
+        delete d_basis_right;
+        d_basis_right = nullptr;
+        delete d_U;
+        d_U = nullptr;
+        delete d_S;
+        d_S = nullptr;
+        delete d_W;
+        d_W = nullptr;
+        delete d_snapshots;
+        d_snapshots = nullptr;
+    }
+    d_num_samples = 0;
+    increaseTimeInterval();
+    d_time_interval_start_times[static_cast<unsigned>(num_time_intervals)] =
+        time;
+    d_basis = nullptr;
+    d_basis_right = nullptr;
+    // Set the N in the global matrix so BLACS won't complain.
+    d_samples->n = d_samples_per_time_interval;
+}
+
 void
 StaticSVD::broadcast_sample(const double* u_in)
 {
@@ -336,6 +432,93 @@ StaticSVD::broadcast_sample(const double* u_in)
     }
 }
 
+void
+StaticSVD::saveState()
+{
+    CAROM_VERIFY(!d_state_file_name.empty());
+
+    // Write to a temporary file first so that a failure during the write
+    // cannot destroy the last good checkpoint.
+    std::string tmp_file_name = d_state_file_name + ".tmp";
+    HDFDatabase database;
+    database.create(tmp_file_name);
+
+    // Save the layout of the sample matrix so that a restart with a
+    // different decomposition can be detected.
+    database.putInteger("num_procs", d_num_procs);
+    database.putInteger("total_dim", d_total_dim);
+    database.putInteger("blocksize", d_blocksize);
+    database.putInteger("local_rows", d_samples->mm);
+
+    // Save the time interval start times.
+    int num_time_intervals = getNumBasisTimeIntervals();
+    database.putInteger("num_time_intervals", num_time_intervals);
+    if (num_time_intervals > 0) {
+        database.putDoubleArray("time_interval_start_times",
+                                d_time_interval_start_times.data(),
+                                num_time_intervals);
+    }
+
+    // Save the local part of the sample matrix.  It is stored column major
+    // with leading dimension mm, so the columns holding samples are
+    // contiguous.
+    database.putInteger("num_samples", d_num_samples);
+    if (d_num_samples > 0 && d_samples->mm > 0) {
+        database.putDoubleArray("samples", d_samples->mdata,
+                                d_samples->mm*d_num_samples);
+    }
+    database.close();
+
+    CAROM_VERIFY(std::rename(tmp_file_name.c_str(),
+                             d_state_file_name.c_str()) == 0);
+}
+
+void
+StaticSVD::restoreState()
+{
+    // Only restore if every process has a state file consistent with the
+    // current layout of the sample matrix.
+    HDFDatabase database;
+    int num_samples = 0;
+    int is_good = Utilities::file_exist(d_state_file_name) ? 1 : 0;
+    if (is_good) {
+        database.open(d_state_file_name, "r");
+        int num_procs, total_dim, blocksize, local_rows;
+        database.getInteger("num_procs", num_procs);
+        database.getInteger("total_dim", total_dim);
+        database.getInteger("blocksize", blocksize);
+        database.getInteger("local_rows", local_rows);
+        database.getInteger("num_samples", num_samples);
+        is_good = num_procs == d_num_procs && total_dim == d_total_dim &&
+                  blocksize == d_blocksize && local_rows == d_samples->mm &&
+                  num_samples > 0 &&
+                  num_samples <= d_samples_per_time_interval;
+    }
+    CAROM_VERIFY(MPI_Allreduce(MPI_IN_PLACE, &is_good, 1, MPI_INT, MPI_MIN,
+                               MPI_COMM_WORLD) == MPI_SUCCESS);
+    if (!is_good) {
+        database.close();
+        return;
+    }
+
+    int num_time_intervals;
+    database.getInteger("num_time_intervals", num_time_intervals);
+    d_time_interval_start_times.resize(
+        static_cast<unsigned>(num_time_intervals));
+    database.getDoubleArray("time_interval_start_times",
+                            d_time_interval_start_times.data(),
+                            num_time_intervals);
+
+    if (d_samples->mm > 0) {
+        database.getDoubleArray("samples", d_samples->mdata,
+                                d_samples->mm*num_samples);
+    }
+    database.close();
+
+    d_num_samples = num_samples;
+    d_this_interval_basis_current = false;
+}
+
 void
 StaticSVD::get_global_info()
 {
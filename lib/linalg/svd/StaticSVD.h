@@ -20,6 +20,7 @@
 
 #include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace CAROM {
@@ -56,6 +57,34 @@ public:
         double time,
         bool add_without_increase = false);
 
+    /**
+     * @brief Collect a block of samples at the supplied time.
+     *
+     * The block is redistributed into the sample matrix with one scatter per
+     * process rather than one per process and sample.  Samples with zero
+     * norm are skipped, as in takeSample.  A new time interval is started
+     * whenever the current one is full.
+     *
+     * @pre samples.numRows() == getDim()
+     * @pre 0 <= num_samples <= samples.numColumns()
+     * @pre scale == nullptr || scale->dim() >= num_samples
+     * @pre time >= 0.0
+     *
+     * @param[in] samples The local rows of the samples, one per column.
+     * @param[in] num_samples The number of leading columns of samples to
+     *                        collect.
+     * @param[in] scale If not null, column j is scaled by scale->item(j).
+     * @param[in] time The simulation time of the samples.
+     *
+     * @return The number of samples collected.
+     */
+    int
+    takeSamples(
+        const Matrix& samples,
+        int num_samples,
+        const Vector* scale,
+        double time);
+
     /**
      * @brief Returns the basis vectors for the current time interval as a
      *        Matrix.
@@ -100,6 +129,19 @@ public:
     const Matrix*
     getSnapshotMatrix();
 
+    /**
+     * @brief Write the samples accumulated in the current time interval to
+     *        the state file so that sampling may be resumed after a restart.
+     *
+     * Each process writes only the part of the distributed sample matrix it
+     * owns, so no communication is required. The state file is replaced
+     * atomically, so an interrupted checkpoint leaves the previous one intact.
+     *
+     * @pre !d_state_file_name.empty()
+     */
+    void
+    saveState();
+
 protected:
 
     /**
@@ -107,10 +149,15 @@ protected:
       *
       * @param[in] options The struct containing the options for this SVD
       *                    implementation.
+      * @param[in] basis_file_name The base part of the name of the file
+      *                            containing the basis vectors.  Each process
+      *                            will append its process ID to this base
+      *                            name to form the name of its state file.
       * @see Options
       */
     StaticSVD(
-        Options options
+        Options options,
+        const std::string& basis_file_name = ""
     );
 
     /**
@@ -218,11 +265,36 @@ protected:
      */
     void delete_factorizer();
 
+    /**
+     * @brief Start a new time interval at the supplied time, discarding the
+     *        samples and basis of the previous one.
+     */
+    void startTimeInterval(double time);
+
     /**
      * @brief Broadcast the sample to all processors.
      */
     void broadcast_sample(const double* u_in);
 
+    /**
+     * @brief Restore the samples of the current time interval from the state
+     *        file, directly into the local part of the sample matrix.
+     *
+     * The restore happens on all processes or on none of them.
+     */
+    void restoreState();
+
+    /**
+     * @brief If true the accumulated samples are written to the state file
+     *        when the object is deleted.
+     */
+    bool d_save_state;
+
+    /**
+     * @brief Name of the state file of this process.
+     */
+    std::string d_state_file_name;
+
 private:
 
     friend class BasisGenerator;
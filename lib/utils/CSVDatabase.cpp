@@ -15,6 +15,10 @@
 #include <vector>
 #include <complex>
 #include <iomanip>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
 
 namespace CAROM {
 
@@ -57,12 +61,15 @@ CSVDatabase::putIntegerArray(
     CAROM_VERIFY(data != 0);
     CAROM_VERIFY(nelements > 0);
 
-    std::ofstream d_fs(file_name.c_str());
+    std::string buffer;
+    buffer.reserve(12 * nelements);
+    char entry[32];
     for (int i = 0; i < nelements; ++i)
     {
-        d_fs << data[i] << std::endl;
+        int len = snprintf(entry, sizeof(entry), "%d\n", data[i]);
+        buffer.append(entry, len);
     }
-    d_fs.close();
+    writeFile(file_name, buffer);
 }
 
 void
@@ -75,13 +82,18 @@ CSVDatabase::putDoubleArray(
     CAROM_VERIFY(data != 0);
     CAROM_VERIFY(nelements > 0);
 
-    std::ofstream d_fs(file_name.c_str());
-    d_fs << std::setprecision(10) << std::fixed;
+    // Write with enough significant digits for the values to be read back
+    // exactly.
+    const int precision = std::numeric_limits<double>::max_digits10;
+    std::string buffer;
+    buffer.reserve(25 * nelements);
+    char entry[32];
     for (int i = 0; i < nelements; ++i)
     {
-        d_fs << data[i] << std::endl;
+        int len = snprintf(entry, sizeof(entry), "%.*g\n", precision, data[i]);
+        buffer.append(entry, len);
     }
-    d_fs.close();
+    writeFile(file_name, buffer);
 }
 
 void
@@ -95,13 +107,13 @@ CSVDatabase::putDoubleVector(
     CAROM_VERIFY(nelements > 0);
     CAROM_VERIFY(data.size() == nelements);
 
-    std::ofstream d_fs(file_name.c_str());
-    d_fs << std::setprecision(precision) << std::fixed;
+    std::ostringstream d_ss;
+    d_ss << std::setprecision(precision) << std::fixed;
     for (int i = 0; i < nelements; ++i)
     {
-        d_fs << data[i] << std::endl;
+        d_ss << data[i] << '\n';
     }
-    d_fs.close();
+    writeFile(file_name, d_ss.str());
 }
 
 void
@@ -115,13 +127,13 @@ CSVDatabase::putComplexVector(
     CAROM_VERIFY(nelements > 0);
     CAROM_VERIFY(data.size() == nelements);
 
-    std::ofstream d_fs(file_name.c_str());
-    d_fs << std::setprecision(precision) << std::fixed;
+    std::ostringstream d_ss;
+    d_ss << std::setprecision(precision) << std::fixed;
     for (int i = 0; i < nelements; ++i)
     {
-        d_fs << std::real(data[i]) << "," << std::imag(data[i]) << std::endl;
+        d_ss << std::real(data[i]) << "," << std::imag(data[i]) << '\n';
     }
-    d_fs.close();
+    writeFile(file_name, d_ss.str());
 }
 
 void
@@ -134,12 +146,13 @@ CSVDatabase::putStringVector(
     CAROM_VERIFY(nelements > 0);
     CAROM_ASSERT(data != 0);
 
-    std::ofstream d_fs(file_name.c_str());
+    std::string buffer;
     for (int i = 0; i < nelements; ++i)
     {
-        d_fs << data[i] << std::endl;
+        buffer += data[i];
+        buffer += '\n';
     }
-    d_fs.close();
+    writeFile(file_name, buffer);
 }
 
 void
@@ -194,15 +207,7 @@ CSVDatabase::getDoubleArray(
     CAROM_NULL_USE(nelements);
 #endif
 
-    std::ifstream d_fs(file_name.c_str());
-    CAROM_VERIFY(!d_fs.fail());
-    double data_entry = 0.0;
-    for (int i = 0; i < nelements; ++i)
-    {
-        d_fs >> data_entry;
-        data[i] = data_entry;
-    }
-    d_fs.close();
+    parseDoubleArray(file_name, data, nelements, std::vector<int>());
 }
 
 void
@@ -217,31 +222,7 @@ CSVDatabase::getDoubleArray(
     CAROM_NULL_USE(nelements);
 #endif
 
-    if (idx.size() == 0)
-    {
-        getDoubleArray(file_name, data, nelements);
-    }
-    else
-    {
-        std::ifstream d_fs(file_name.c_str());
-        CAROM_VERIFY(!d_fs.fail());
-        int k = 0;
-        double data_entry = 0.0;
-        for (int i = 0; i < nelements; ++i)
-        {
-            d_fs >> data_entry;
-            if (idx[k] == i)
-            {
-                data[k++] = data_entry;
-            }
-            if (k == idx.size())
-            {
-                break;
-            }
-        }
-        CAROM_VERIFY(k == idx.size());
-        d_fs.close();
-    }
+    parseDoubleArray(file_name, data, nelements, idx);
 }
 
 void
@@ -258,33 +239,39 @@ CSVDatabase::getDoubleArray(
     CAROM_NULL_USE(nelements);
 #endif
 
-    std::ifstream d_fs(file_name.c_str());
-    CAROM_VERIFY(!d_fs.fail());
-    std::string line, data_entry;
+    readFile(file_name, d_buffer);
+    const char* pos = d_buffer.data();
     int count = 0;
     int curr_block_remaining = block_size;
-    while (count < nelements && d_fs >> line)
+    while (count < nelements)
     {
-        std::stringstream d_ss(line);
-        while (std::getline(d_ss, data_entry, ','))
+        while (*pos == ',' || std::isspace(static_cast<unsigned char>(*pos)))
         {
-            if (offset > 0)
-            {
-                offset--;
-            }
-            else
+            ++pos;
+        }
+        if (*pos == '\0')
+        {
+            break;
+        }
+        char* end;
+        const double data_entry = std::strtod(pos, &end);
+        CAROM_VERIFY(end != pos);
+        pos = end;
+        if (offset > 0)
+        {
+            offset--;
+        }
+        else
+        {
+            data[count++] = data_entry;
+            curr_block_remaining--;
+            if (curr_block_remaining == 0)
             {
-                data[count++] = std::stod(data_entry);
-                curr_block_remaining--;
-                if (curr_block_remaining == 0)
-                {
-                    offset = stride - 1;
-                    curr_block_remaining = block_size;
-                }
+                offset = stride - 1;
+                curr_block_remaining = block_size;
             }
         }
     }
-    d_fs.close();
 }
 
 void
@@ -325,6 +312,47 @@ CSVDatabase::getStringVector(
     d_fs.close();
 }
 
+void
+CSVDatabase::getDoubleArrays(
+    const std::vector<std::string>& file_names,
+    double* data,
+    int nelements,
+    const std::vector<int>& idx,
+    MPI_Comm comm)
+{
+    const int num_files = file_names.size();
+    CAROM_VERIFY(data != 0 || num_files == 0);
+    const int array_size = idx.empty() ? nelements : idx.size();
+
+    int rank, num_procs;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_procs);
+
+    // Split the files into contiguous blocks, one per process, so that the
+    // arrays parsed on each process end up contiguous in data.
+    std::vector<int> counts(num_procs), displs(num_procs);
+    for (int p = 0; p < num_procs; ++p)
+    {
+        const int first = (p * num_files) / num_procs;
+        const int last = ((p + 1) * num_files) / num_procs;
+        counts[p] = (last - first) * array_size;
+        displs[p] = first * array_size;
+    }
+
+    const int first_file = (rank * num_files) / num_procs;
+    const int last_file = ((rank + 1) * num_files) / num_procs;
+    for (int i = first_file; i < last_file; ++i)
+    {
+        parseDoubleArray(file_names[i], data + i * array_size, nelements, idx);
+    }
+
+    if (num_procs > 1)
+    {
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                       data, counts.data(), displs.data(), MPI_DOUBLE, comm);
+    }
+}
+
 int
 CSVDatabase::getLineCount(
     const std::string& file_name)
@@ -341,4 +369,73 @@ CSVDatabase::getLineCount(
     return count;
 }
 
+void
+CSVDatabase::readFile(
+    const std::string& file_name,
+    std::vector<char>& buffer)
+{
+    std::ifstream d_fs(file_name.c_str(), std::ios::in | std::ios::binary);
+    CAROM_VERIFY(!d_fs.fail());
+    d_fs.seekg(0, std::ios::end);
+    const std::streamoff size = d_fs.tellg();
+    d_fs.seekg(0, std::ios::beg);
+    buffer.resize(size + 1);
+    d_fs.read(buffer.data(), size);
+    buffer[size] = '\0';
+    d_fs.close();
+}
+
+void
+CSVDatabase::writeFile(
+    const std::string& file_name,
+    const std::string& buffer)
+{
+    std::ofstream d_fs(file_name.c_str(), std::ios::out | std::ios::binary);
+    d_fs.write(buffer.data(), buffer.size());
+    d_fs.close();
+}
+
+void
+CSVDatabase::parseDoubleArray(
+    const std::string& file_name,
+    double* data,
+    int nelements,
+    const std::vector<int>& idx)
+{
+    readFile(file_name, d_buffer);
+    const char* pos = d_buffer.data();
+    const bool read_all = idx.empty();
+    const int num_entries = read_all ? nelements : idx.size();
+    int k = 0;
+    for (int i = 0; i < nelements && k < num_entries; ++i)
+    {
+        while (*pos == ',' || std::isspace(static_cast<unsigned char>(*pos)))
+        {
+            ++pos;
+        }
+        if (*pos == '\0')
+        {
+            break;
+        }
+        if (read_all || idx[k] == i)
+        {
+            char* end;
+            data[k++] = std::strtod(pos, &end);
+            CAROM_VERIFY(end != pos);
+            pos = end;
+        }
+        else
+        {
+            // Skip over entries that are not requested without converting
+            // them.
+            while (*pos != '\0' && *pos != ',' &&
+                    !std::isspace(static_cast<unsigned char>(*pos)))
+            {
+                ++pos;
+            }
+        }
+    }
+    CAROM_VERIFY(k == num_entries);
+}
+
 }
@@ -14,6 +14,7 @@
 #define included_CSVDatabase_h
 
 #include "Database.h"
+#include "mpi.h"
 #include <string>
 #include <fstream>
 #include <vector>
@@ -269,6 +270,34 @@ public:
         int block_size,
         int stride);
 
+    /**
+     * @brief Reads the arrays of doubles associated with a list of filenames,
+     *        splitting the files among the processes of a communicator.
+     *
+     * Each process parses a contiguous block of the files, after which the
+     * arrays are exchanged so that every process holds all of them.
+     *
+     * @pre data != 0 || file_names.empty()
+     *
+     * @param[in] file_names The filenames associated with the arrays of
+     *                       values to be read.
+     * @param[out] data The allocated array of double values to be read, of
+     *                  size file_names.size() times the number of values
+     *                  read per file. The values of file i are stored
+     *                  contiguously starting at the i-th such block.
+     * @param[in] nelements The number of doubles in each full array.
+     * @param[in] idx The set of indices in the sub-array to read from each
+     *                file. If empty, the full array is read.
+     * @param[in] comm The MPI communicator over which the files are split.
+     */
+    void
+    getDoubleArrays(
+        const std::vector<std::string>& file_names,
+        double* data,
+        int nelements,
+        const std::vector<int>& idx,
+        MPI_Comm comm = MPI_COMM_WORLD);
+
     /**
      * @brief Reads a vector of doubles associated with the supplied filename.
      *
@@ -327,6 +356,50 @@ private:
     operator = (
         const CSVDatabase& rhs);
 
+    /**
+     * @brief Reads the whole content of a file in a single bulk read.
+     *
+     * @param[in] file_name Name of the file to be read.
+     * @param[out] buffer The content of the file, terminated by '\0'.
+     */
+    void
+    readFile(
+        const std::string& file_name,
+        std::vector<char>& buffer);
+
+    /**
+     * @brief Writes a buffer to a file in a single bulk write.
+     *
+     * @param[in] file_name Name of the file to be written.
+     * @param[in] buffer The content to be written.
+     */
+    void
+    writeFile(
+        const std::string& file_name,
+        const std::string& buffer);
+
+    /**
+     * @brief Parses the (sub-)array of doubles stored in a file.
+     *
+     * @param[in] file_name Name of the file to be parsed.
+     * @param[out] data The allocated (sub-)array of double values to be read.
+     * @param[in] nelements The number of doubles in the full array.
+     * @param[in] idx The sorted set of indices in the sub-array. If empty,
+     *                the full array is read.
+     */
+    void
+    parseDoubleArray(
+        const std::string& file_name,
+        double* data,
+        int nelements,
+        const std::vector<int>& idx);
+
+    /**
+     * @brief Buffer holding the content of the last file read, reused
+     *        across reads to avoid reallocation.
+     */
+    std::vector<char> d_buffer;
+
 };
 
 }
@@ -343,6 +343,16 @@ HDFDatabase::getDoubleArray(
 #endif
 }
 
+bool
+HDFDatabase::exists(
+    const std::string& key)
+{
+    CAROM_VERIFY(!key.empty());
+    htri_t result = H5Lexists(d_group_id, key.c_str(), H5P_DEFAULT);
+    CAROM_VERIFY(result >= 0);
+    return result > 0;
+}
+
 bool
 HDFDatabase::isInteger(
     const std::string& key)
@@ -174,6 +174,18 @@ public:
         int block_size,
         int stride);
 
+    /**
+     * @brief Returns true if an entry with the supplied key exists in the
+     *        currently open HDF5 database file.
+     *
+     * @param[in] key The key of the entry.
+     *
+     * @return True if the entry exists.
+     */
+    bool
+    exists(
+        const std::string& key);
+
 private:
     /**
      * @brief Unimplemented copy constructor.
@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: A bounded queue of writes performed in order by a background
+//              thread.
+
+#include "WriteQueue.h"
+#include "Utilities.h"
+
+namespace CAROM {
+
+WriteQueue::WriteQueue(
+    int max_pending_writes) :
+    d_max_pending_writes(max_pending_writes),
+    d_stop_writing(false)
+{
+    CAROM_VERIFY(max_pending_writes > 0);
+    d_write_thread = std::thread(&WriteQueue::processWrites, this);
+}
+
+WriteQueue::~WriteQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(d_write_mutex);
+        d_stop_writing = true;
+    }
+    d_write_cv.notify_all();
+    d_write_thread.join();
+}
+
+void
+WriteQueue::push(
+    const std::function<void()>& write)
+{
+    {
+        std::unique_lock<std::mutex> lock(d_write_mutex);
+        d_write_cv.wait(lock, [this] {
+            return static_cast<int>(d_pending_writes.size()) < d_max_pending_writes;
+        });
+        d_pending_writes.push_back(write);
+    }
+    d_write_cv.notify_all();
+}
+
+void
+WriteQueue::flush()
+{
+    std::unique_lock<std::mutex> lock(d_write_mutex);
+    d_write_cv.wait(lock, [this] { return d_pending_writes.empty(); });
+}
+
+int
+WriteQueue::numPending()
+{
+    std::lock_guard<std::mutex> lock(d_write_mutex);
+    return static_cast<int>(d_pending_writes.size());
+}
+
+void
+WriteQueue::processWrites()
+{
+    std::unique_lock<std::mutex> lock(d_write_mutex);
+    while (true) {
+        d_write_cv.wait(lock, [this] {
+            return d_stop_writing || !d_pending_writes.empty();
+        });
+        if (d_pending_writes.empty()) {
+            break;
+        }
+
+        // Keep the write in the queue while it is performed so that it counts
+        // against d_max_pending_writes and flush waits for it.
+        std::function<void()> write = d_pending_writes.front();
+        lock.unlock();
+        write();
+        lock.lock();
+        d_pending_writes.pop_front();
+        d_write_cv.notify_all();
+    }
+}
+
+}
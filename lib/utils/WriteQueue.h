@@ -0,0 +1,136 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: A bounded queue of writes performed in order by a background
+//              thread.
+
+#ifndef included_WriteQueue_h
+#define included_WriteQueue_h
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace CAROM {
+
+/**
+ * Class WriteQueue performs writes in a background thread, in the order in
+ * which they were pushed. At most max_pending_writes writes are queued at any
+ * time, counting the one in progress; a further push blocks until the oldest
+ * pending write has completed. The destructor completes all pending writes.
+ */
+class WriteQueue
+{
+public:
+    /**
+     * @brief Constructor. Starts the background thread.
+     *
+     * @pre max_pending_writes > 0
+     *
+     * @param[in] max_pending_writes The maximum number of queued writes.
+     */
+    explicit WriteQueue(
+        int max_pending_writes);
+
+    /**
+     * @brief Destructor. Completes all pending writes and stops the
+     *        background thread.
+     */
+    ~WriteQueue();
+
+    /**
+     * @brief Queues a write, blocking while max_pending_writes writes are
+     *        pending.
+     *
+     * @param[in] write The write to be performed by the background thread.
+     */
+    void
+    push(
+        const std::function<void()>& write);
+
+    /**
+     * @brief Blocks until all pending writes have completed.
+     */
+    void
+    flush();
+
+    /**
+     * @brief Returns the number of pending writes, including the one in
+     *        progress.
+     *
+     * @return The number of pending writes.
+     */
+    int
+    numPending();
+
+private:
+    /**
+     * @brief Unimplemented default constructor.
+     */
+    WriteQueue();
+
+    /**
+     * @brief Unimplemented copy constructor.
+     */
+    WriteQueue(
+        const WriteQueue& other);
+
+    /**
+     * @brief Unimplemented assignment operator.
+     */
+    WriteQueue&
+    operator = (
+        const WriteQueue& rhs);
+
+    /**
+     * @brief Main loop of the background thread, performing the queued
+     *        writes in order.
+     */
+    void
+    processWrites();
+
+    /**
+     * @brief The maximum number of queued writes.
+     */
+    int d_max_pending_writes;
+
+    /**
+     * @brief Queue of writes. The front write is the one being performed by
+     *        the background thread.
+     */
+    std::deque<std::function<void()> > d_pending_writes;
+
+    /**
+     * @brief Mutex protecting d_pending_writes and d_stop_writing.
+     */
+    std::mutex d_write_mutex;
+
+    /**
+     * @brief Signals changes of d_pending_writes and d_stop_writing.
+     */
+    std::condition_variable d_write_cv;
+
+    /**
+     * @brief Whether the background thread should exit once the queue is
+     *        empty.
+     */
+    bool d_stop_writing;
+
+    /**
+     * @brief Background thread performing the writes.
+     */
+    std::thread d_write_thread;
+};
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::BasisWriter class.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "linalg/BasisGenerator.h"
+#include "linalg/BasisReader.h"
+#include "linalg/Matrix.h"
+#include "linalg/Options.h"
+#include "linalg/Vector.h"
+#include "utils/WriteQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+const int num_local_rows = 6;
+const int samples_per_time_interval = 2;
+const int num_samples = 7;
+
+/**
+ * Takes the same samples with a synchronous or an asynchronous writer. A new
+ * time interval starts every samples_per_time_interval samples, so all but
+ * the last interval are written while sampling goes on. Returns whether the
+ * writes were actually asynchronous.
+ */
+bool generateBasis(const std::string& base_file_name, bool async, int myid)
+{
+    CAROM::Options options(num_local_rows, samples_per_time_interval);
+    options.setIncrementalSVD(1.0e-7, 1.0, 1.0e-1, 1.0);
+    options.setAsyncWrite(async);
+    CAROM::BasisGenerator generator(options, true, base_file_name);
+
+    std::vector<double> sample(num_local_rows);
+    for (int s = 0; s < num_samples; s++)
+    {
+        for (int i = 0; i < num_local_rows; i++)
+        {
+            int row = myid * num_local_rows + i;
+            sample[i] = std::sin(0.3 * (row + 1) * (s + 1)) + 0.1 * s;
+        }
+        EXPECT_TRUE(generator.takeSample(sample.data(), s, 1.0));
+    }
+    generator.endSamples();
+    return generator.isAsyncWrite();
+}
+
+/**
+ * Removes the basis file of this process.
+ */
+void removeBasisFile(const std::string& base_file_name, int myid)
+{
+    char suffix[100];
+    sprintf(suffix, ".%06d", myid);
+    std::remove((base_file_name + suffix).c_str());
+}
+
+TEST(BasisWriterTest, Test_AsyncWrite)
+{
+    int myid;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    const std::string sync_file_name = "test_BasisWriter_sync";
+    const std::string async_file_name = "test_BasisWriter_async";
+
+    EXPECT_FALSE(generateBasis(sync_file_name, false, myid));
+    if (!generateBasis(async_file_name, true, myid))
+    {
+        removeBasisFile(sync_file_name, myid);
+        removeBasisFile(async_file_name, myid);
+        GTEST_SKIP() << "HDF5 is not thread-safe, so asynchronous writes are "
+                     << "not available.";
+    }
+
+    // Both files hold the same bases for every time interval.
+    CAROM::BasisReader sync_reader(sync_file_name);
+    CAROM::BasisReader async_reader(async_file_name);
+    for (int s = 0; s < num_samples; s += samples_per_time_interval)
+    {
+        CAROM::Matrix* sync_basis = sync_reader.getSpatialBasis(s);
+        CAROM::Matrix* async_basis = async_reader.getSpatialBasis(s);
+        EXPECT_EQ(async_basis->numRows(), num_local_rows);
+        EXPECT_EQ(async_basis->numRows(), sync_basis->numRows());
+        EXPECT_EQ(async_basis->numColumns(), sync_basis->numColumns());
+        for (int i = 0; i < sync_basis->numRows(); i++)
+        {
+            for (int j = 0; j < sync_basis->numColumns(); j++)
+            {
+                EXPECT_EQ(async_basis->item(i, j), sync_basis->item(i, j));
+            }
+        }
+
+        CAROM::Vector* sync_sv = sync_reader.getSingularValues(s);
+        CAROM::Vector* async_sv = async_reader.getSingularValues(s);
+        EXPECT_EQ(async_sv->dim(), sync_sv->dim());
+        for (int i = 0; i < sync_sv->dim(); i++)
+        {
+            EXPECT_EQ(async_sv->item(i), sync_sv->item(i));
+        }
+
+        delete sync_basis;
+        delete async_basis;
+        delete sync_sv;
+        delete async_sv;
+    }
+
+    removeBasisFile(sync_file_name, myid);
+    removeBasisFile(async_file_name, myid);
+}
+
+TEST(WriteQueueTest, Test_OrderAndBound)
+{
+    std::vector<int> written;
+    std::mutex gate_mutex;
+    std::condition_variable gate_cv;
+    bool gate_open = false;
+
+    CAROM::WriteQueue queue(2);
+    queue.push([&] {
+        std::unique_lock<std::mutex> lock(gate_mutex);
+        gate_cv.wait(lock, [&] { return gate_open; });
+        written.push_back(0);
+    });
+    queue.push([&] { written.push_back(1); });
+    EXPECT_EQ(queue.numPending(), 2);
+
+    // The queue is full while the first write waits at the gate, so a third
+    // push blocks until the first write has completed.
+    std::atomic<bool> pushed(false);
+    std::thread pusher([&] {
+        queue.push([&] { written.push_back(2); });
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+    EXPECT_EQ(queue.numPending(), 2);
+
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex);
+        gate_open = true;
+    }
+    gate_cv.notify_all();
+    pusher.join();
+    EXPECT_TRUE(pushed);
+
+    queue.flush();
+    EXPECT_EQ(queue.numPending(), 0);
+    ASSERT_EQ(static_cast<int>(written.size()), 3);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(written[i], i);
+    }
+}
+
+TEST(WriteQueueTest, Test_DestructorCompletesWrites)
+{
+    const int num_writes = 5;
+    int num_written = 0;
+    {
+        CAROM::WriteQueue queue(1);
+        queue.flush();
+        for (int i = 0; i < num_writes; i++)
+        {
+            queue.push([&num_written] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                num_written++;
+            });
+        }
+    }
+    EXPECT_EQ(num_written, num_writes);
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
@@ -0,0 +1,202 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::CSVDatabase class.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "utils/CSVDatabase.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+/**
+ * Doubles that are not exactly representable in decimal, the extremes of the
+ * range, denormals and signed zeros.
+ */
+std::vector<double> createValues()
+{
+    std::vector<double> values;
+    values.push_back(0.1);
+    values.push_back(-0.1);
+    values.push_back(1.0 / 3.0);
+    values.push_back(2.0 / 3.0);
+    values.push_back(M_PI * 1.0e300);
+    values.push_back(-M_E * 1.0e-300);
+    values.push_back(0.0);
+    values.push_back(-0.0);
+    values.push_back(std::numeric_limits<double>::max());
+    values.push_back(-std::numeric_limits<double>::max());
+    values.push_back(std::numeric_limits<double>::min());
+    values.push_back(std::numeric_limits<double>::denorm_min());
+    values.push_back(-3.0 * std::numeric_limits<double>::denorm_min());
+    values.push_back(0.5 * std::numeric_limits<double>::min() + 1.0e-320);
+    values.push_back(std::numeric_limits<double>::epsilon());
+    values.push_back(1.0 + std::numeric_limits<double>::epsilon());
+    for (int i = 1; i <= 20; i++)
+    {
+        values.push_back(std::sin(1.7 * i) * std::pow(10.0, 7 * i - 70));
+    }
+    return values;
+}
+
+/**
+ * Compares the bit patterns, so that -0.0 and 0.0 differ.
+ */
+void expectBitExact(const double* actual, const double* expected, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        EXPECT_EQ(std::memcmp(&actual[i], &expected[i], sizeof(double)), 0)
+                << "entry " << i << ": " << actual[i] << " != " << expected[i];
+    }
+}
+
+TEST(CSVDatabaseSerialTest, Test_RoundTrip)
+{
+    int myid;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    const std::string file_name = "test_CSVDatabase_" + std::to_string(myid)
+                                  + ".csv";
+    std::vector<double> values = createValues();
+    const int n = values.size();
+
+    CAROM::CSVDatabase database;
+    database.putDoubleArray(file_name, values.data(), n);
+
+    std::vector<double> read(n);
+    database.getDoubleArray(file_name, read.data(), n);
+    expectBitExact(read.data(), values.data(), n);
+
+    // An indexed read converts only the requested entries.
+    std::vector<int> idx;
+    for (int i = 1; i < n; i += 3)
+    {
+        idx.push_back(i);
+    }
+    const int num_idx = idx.size();
+    std::vector<double> read_idx(num_idx);
+    database.getDoubleArray(file_name, read_idx.data(), n, idx);
+    for (int k = 0; k < num_idx; k++)
+    {
+        expectBitExact(&read_idx[k], &values[idx[k]], 1);
+    }
+
+    // A strided read of blocks of two entries, each followed by stride - 1
+    // skipped entries, after an offset.
+    const int offset = 2;
+    const int block_size = 2;
+    const int stride = 4;
+    std::vector<double> expected;
+    for (int i = offset; i < n; i += block_size + stride - 1)
+    {
+        for (int j = i; j < i + block_size && j < n; j++)
+        {
+            expected.push_back(values[j]);
+        }
+    }
+    std::vector<double> read_strided(expected.size());
+    database.getDoubleArray(file_name, read_strided.data(), expected.size(),
+                            offset, block_size, stride);
+    expectBitExact(read_strided.data(), expected.data(), expected.size());
+
+    std::remove(file_name.c_str());
+}
+
+TEST(CSVDatabaseParallelTest, Test_getDoubleArrays)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    std::vector<double> values = createValues();
+    const int n = values.size();
+
+    // More files than processes, so that some processes parse several.
+    const int num_files = 2 * num_procs + 1;
+    std::vector<std::string> file_names;
+    std::vector<double> expected;
+    CAROM::CSVDatabase database;
+    for (int f = 0; f < num_files; f++)
+    {
+        file_names.push_back("test_CSVDatabase_file_" + std::to_string(f)
+                             + ".csv");
+        std::vector<double> file_values(values);
+        for (int i = 0; i < n; i++)
+        {
+            file_values[i] *= (f + 1);
+        }
+        if (myid == 0)
+        {
+            database.putDoubleArray(file_names[f], file_values.data(), n);
+        }
+        expected.insert(expected.end(), file_values.begin(), file_values.end());
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    std::vector<double> read(num_files * n);
+    database.getDoubleArrays(file_names, read.data(), n, std::vector<int>());
+    expectBitExact(read.data(), expected.data(), num_files * n);
+
+    std::vector<int> idx;
+    idx.push_back(0);
+    idx.push_back(11);
+    idx.push_back(n - 1);
+    const int num_idx = idx.size();
+    std::vector<double> read_idx(num_files * num_idx);
+    database.getDoubleArrays(file_names, read_idx.data(), n, idx);
+    for (int f = 0; f < num_files; f++)
+    {
+        for (int k = 0; k < num_idx; k++)
+        {
+            expectBitExact(&read_idx[f * num_idx + k],
+                           &expected[f * n + idx[k]], 1);
+        }
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (myid == 0)
+    {
+        for (int f = 0; f < num_files; f++)
+        {
+            std::remove(file_names[f].c_str());
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
@@ -18,6 +18,9 @@
 #include <mpi.h>
 #include "hyperreduction/DEIM.h"
 #include "linalg/Matrix.h"
+#include "linalg/Vector.h"
+#include <algorithm>
+#include <vector>
 #define _USE_MATH_DEFINES
 #include <cmath>
 
@@ -142,11 +145,164 @@ TEST(DEIMSerialTest, Test_DEIM_decreased_used_basis_vectors)
     EXPECT_TRUE(l2_norm_diff < 1e-5);
 }
 
+TEST(DEIMSerialTest, Test_BlockDEIM)
+{
+
+    // Orthonormal input matrix to DEIM
+    double* orthonormal_mat = new double[50] {
+        -0.1067,   -0.4723,   -0.4552,    0.1104,   -0.2337,
+        0.1462,    0.6922,   -0.2716,    0.1663,    0.3569,
+        0.4087,   -0.3437,    0.4952,   -0.3356,    0.3246,
+        0.2817,   -0.0067,   -0.0582,   -0.0034,    0.0674,
+        0.5147,    0.1552,   -0.1635,   -0.3440,   -0.3045,
+        -0.4628,    0.0141,   -0.1988,   -0.5766,    0.0150,
+        -0.2203,    0.3283,    0.2876,   -0.4597,   -0.1284,
+        -0.0275,    0.1202,   -0.0924,   -0.2290,   -0.3808,
+        0.4387,   -0.0199,   -0.3338,   -0.1711,   -0.2220,
+        0.0101,    0.1807,    0.4488,    0.3219,   -0.6359
+    };
+
+    int num_cols = 5;
+    int num_rows = 10;
+
+    CAROM::Matrix* u = new CAROM::Matrix(orthonormal_mat, num_rows, num_cols,
+                                         false);
+    std::vector<int> f_sampled_row(num_cols, 0);
+    std::vector<int> f_sampled_rows_per_proc(1, 0);
+    CAROM::Matrix f_basis_sampled_inv = CAROM::Matrix(num_cols, num_cols, false);
+    CAROM::DEIM(u, num_cols, f_sampled_row, f_sampled_rows_per_proc,
+                f_basis_sampled_inv, 0, 1);
+
+    // The error bound constant of DEIM is the 2-norm of its sampled inverse.
+    CAROM::Matrix U, V;
+    CAROM::Vector S;
+    CAROM::SerialSVD(&f_basis_sampled_inv, &U, &S, &V);
+    double DEIM_bound = S(0);
+
+    for (int block_size = 1; block_size <= num_cols; block_size++) {
+        std::vector<int> block_sampled_row(num_cols, 0);
+        std::vector<int> block_sampled_rows_per_proc(1, 0);
+        CAROM::Matrix block_sampled_inv = CAROM::Matrix(num_cols, num_cols, false);
+        double bound = CAROM::BlockDEIM(u, num_cols, block_sampled_row,
+                                        block_sampled_rows_per_proc,
+                                        block_sampled_inv, 0, 1, block_size);
+
+        // DEIM is Gaussian elimination with partial pivoting on the basis,
+        // so on one process every block size selects the rows of DEIM.
+        EXPECT_EQ(block_sampled_row, f_sampled_row);
+        EXPECT_EQ(block_sampled_rows_per_proc[0], num_cols);
+        EXPECT_NEAR(bound, DEIM_bound, 1e-10);
+        for (int i = 0; i < num_cols; i++) {
+            for (int j = 0; j < num_cols; j++) {
+                EXPECT_NEAR(block_sampled_inv(i, j), f_basis_sampled_inv(i, j),
+                            1e-10);
+            }
+        }
+    }
+}
+
+TEST(DEIMParallelTest, Test_BlockDEIM_distributed)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // An orthonormal basis, by modified Gram-Schmidt on every process.
+    const int num_rows = 97;
+    const int num_cols = 7;
+    std::vector<double> basis(num_rows * num_cols);
+    for (int i = 0; i < num_rows; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            basis[i * num_cols + j] = std::sin(0.37 * (i + 1) * (j + 1))
+                                      + std::cos(1.1 * i + 0.3 * j * j);
+        }
+    }
+    for (int j = 0; j < num_cols; j++) {
+        for (int k = 0; k < j; k++) {
+            double dot = 0.0;
+            for (int i = 0; i < num_rows; i++) {
+                dot += basis[i * num_cols + k] * basis[i * num_cols + j];
+            }
+            for (int i = 0; i < num_rows; i++) {
+                basis[i * num_cols + j] -= dot * basis[i * num_cols + k];
+            }
+        }
+        double norm = 0.0;
+        for (int i = 0; i < num_rows; i++) {
+            norm += basis[i * num_cols + j] * basis[i * num_cols + j];
+        }
+        for (int i = 0; i < num_rows; i++) {
+            basis[i * num_cols + j] /= std::sqrt(norm);
+        }
+    }
+
+    std::vector<int> row_offset(num_procs + 1, 0);
+    for (int p = 0; p < num_procs; p++) {
+        row_offset[p + 1] = row_offset[p] + num_rows / num_procs
+                            + (p < num_rows % num_procs ? 1 : 0);
+    }
+    const int num_local_rows = row_offset[myid + 1] - row_offset[myid];
+    CAROM::Matrix u(&basis[row_offset[myid] * num_cols], num_local_rows,
+                    num_cols, true, true);
+
+    // The a priori bound of Chaturantabut and Sorensen on the DEIM error
+    // bound constant.
+    double max_u1 = 0.0;
+    for (int i = 0; i < num_rows; i++) {
+        max_u1 = std::max(max_u1, std::abs(basis[i * num_cols]));
+    }
+    const double a_priori_bound = std::pow(1.0 + std::sqrt(2.0 * num_rows),
+                                           num_cols - 1) / max_u1;
+
+    for (int block_size = 1; block_size <= num_cols; block_size++) {
+        std::vector<int> f_sampled_row(num_cols, 0);
+        std::vector<int> f_sampled_rows_per_proc(num_procs, 0);
+        CAROM::Matrix f_basis_sampled_inv(num_cols, num_cols, false);
+        double bound = CAROM::BlockDEIM(&u, num_cols, f_sampled_row,
+                                        f_sampled_rows_per_proc,
+                                        f_basis_sampled_inv, myid, num_procs,
+                                        block_size);
+
+        // The selection may depend on the number of processes, but it is
+        // num_cols distinct rows ordered by process and then by local row.
+        std::vector<int> global_rows;
+        int k = 0;
+        for (int p = 0; p < num_procs; p++) {
+            for (int i = 0; i < f_sampled_rows_per_proc[p]; i++, k++) {
+                EXPECT_TRUE(0 <= f_sampled_row[k] && f_sampled_row[k] <
+                            row_offset[p + 1] - row_offset[p]);
+                global_rows.push_back(row_offset[p] + f_sampled_row[k]);
+            }
+        }
+        ASSERT_EQ(k, num_cols);
+        for (int i = 1; i < num_cols; i++) {
+            EXPECT_LT(global_rows[i - 1], global_rows[i]);
+        }
+
+        // The returned constant is that of the rows it selected, and is
+        // within the a priori bound.
+        CAROM::Matrix sampled_basis(num_cols, num_cols, false);
+        for (int i = 0; i < num_cols; i++) {
+            for (int j = 0; j < num_cols; j++) {
+                sampled_basis(i, j) = basis[global_rows[i] * num_cols + j];
+            }
+        }
+        CAROM::Matrix U, V;
+        CAROM::Vector S;
+        CAROM::SerialSVD(&sampled_basis, &U, &S, &V);
+        EXPECT_NEAR(bound, 1.0 / S(num_cols - 1), 1e-8 * bound);
+        EXPECT_GE(bound, 1.0 - 1e-12);
+        EXPECT_LE(bound, a_priori_bound);
+    }
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
     MPI_Init(&argc, &argv);
-    return RUN_ALL_TESTS();
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
 }
 #else // #ifndef CAROM_HAS_GTEST
 int main()
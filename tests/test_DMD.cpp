@@ -19,7 +19,11 @@
 #include<gtest/gtest.h>
 #include <mpi.h>
 #include "algo/DMD.h"
+#include "algo/OnlineDMD.h"
+#include "algo/WindowedDMD.h"
 #include "linalg/Vector.h"
+#include <algorithm>
+#include <vector>
 #define _USE_MATH_DEFINES
 #include <cmath>
 
@@ -30,6 +34,43 @@ TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
     SUCCEED();
 }
 
+const int num_sample_rows = 5;
+const double sample_values[3][num_sample_rows] = {
+    {0.5377, 1.8339, -2.2588, 0.8622, 0.3188},
+    {-1.3077, -0.4336, 0.3426, 3.5784, 2.7694},
+    {-1.3499, 3.0349, 0.7254, -0.0631, 0.7147}
+};
+const double predicted_values[num_sample_rows] = {
+    -0.0847, 0.0805, 0.0338, 0.1146, 0.1125
+};
+
+/**
+ * Returns the rows of the three samples of Test_DMD owned by this process,
+ * with the rows distributed over the processes as evenly as possible. Sets
+ * row_offset to the global index of the first row of this process.
+ */
+static std::vector<std::vector<double>> getLocalSamples(int& row_offset)
+{
+    int d_rank, d_num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &d_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
+
+    int d_num_rows = num_sample_rows / d_num_procs;
+    int remainder = num_sample_rows % d_num_procs;
+    row_offset = d_rank * d_num_rows + std::min(d_rank, remainder);
+    if (d_rank < remainder) {
+        d_num_rows++;
+    }
+
+    std::vector<std::vector<double>> local_samples;
+    for (int j = 0; j < 3; j++) {
+        local_samples.push_back(std::vector<double>(
+                                    sample_values[j] + row_offset,
+                                    sample_values[j] + row_offset + d_num_rows));
+    }
+    return local_samples;
+}
+
 TEST(DMDTest, Test_DMD)
 {
     // Get the rank of this process, and the number of processors.
@@ -90,6 +131,238 @@ TEST(DMDTest, Test_DMD)
     }
 }
 
+TEST(DMDTest, Test_DMDPredictTimes)
+{
+    int row_offset;
+    std::vector<std::vector<double>> local_samples = getLocalSamples(row_offset);
+    const int d_num_rows = local_samples[0].size();
+
+    CAROM::DMD dmd(d_num_rows, 1.0);
+    for (int j = 0; j < 3; j++) {
+        dmd.takeSample(local_samples[j].data(), j);
+    }
+    dmd.train(2);
+
+    // The batched prediction matches the prediction at each time.
+    std::vector<double> times {0.0, 1.0, 3.0};
+    CAROM::Matrix* result_batch = dmd.predict(times);
+    EXPECT_EQ(result_batch->numRows(), d_num_rows);
+    EXPECT_EQ(result_batch->numColumns(), 3);
+    for (int j = 0; j < 3; j++) {
+        CAROM::Vector* result_single = dmd.predict(times[j]);
+        for (int i = 0; i < d_num_rows; i++) {
+            EXPECT_NEAR(result_batch->item(i, j), result_single->item(i), 1e-12);
+        }
+        delete result_single;
+    }
+    delete result_batch;
+}
+
+TEST(DMDTest, Test_OnlineDMD)
+{
+    int row_offset;
+    std::vector<std::vector<double>> local_samples = getLocalSamples(row_offset);
+    const int d_num_rows = local_samples[0].size();
+
+    // The online DMD does not retain the snapshots but reproduces the DMD
+    // of Test_DMD.
+    CAROM::OnlineDMD dmd(d_num_rows, 1.0, num_sample_rows);
+    dmd.takeSample(local_samples[0].data(), 0.0);
+    dmd.takeSample(local_samples[1].data(), 1.0);
+    EXPECT_EQ(dmd.getNumSamples(), 2);
+
+    dmd.train(1);
+    dmd.takeSample(local_samples[2].data(), 2.0);
+    EXPECT_EQ(dmd.getNumSamples(), 3);
+
+    dmd.train(2);
+    CAROM::Vector* result = dmd.predict(3.0);
+
+    for (int i = 0; i < d_num_rows; i++) {
+        EXPECT_NEAR(result->item(i), predicted_values[row_offset + i], 1e-3);
+    }
+}
+
+TEST(DMDTest, Test_DMDSVDMethods)
+{
+    int row_offset;
+    std::vector<std::vector<double>> local_samples = getLocalSamples(row_offset);
+    const int d_num_rows = local_samples[0].size();
+
+    // Keeping all the modes, every SVD method reproduces Test_DMD.
+    CAROM::DMD::SVDMethod svd_methods[2] = {CAROM::DMD::SVDMethod::randomized,
+                                            CAROM::DMD::SVDMethod::truncated
+                                           };
+    for (int m = 0; m < 2; m++) {
+        CAROM::DMD dmd(d_num_rows, 1.0);
+        dmd.setSVDMethod(svd_methods[m]);
+        dmd.takeSample(local_samples[0].data(), 0.0);
+        dmd.takeSample(local_samples[1].data(), 1.0);
+        dmd.takeSample(local_samples[2].data(), 2.0);
+
+        dmd.train(2);
+        CAROM::Vector* result = dmd.predict(3.0);
+
+        for (int i = 0; i < d_num_rows; i++) {
+            EXPECT_NEAR(result->item(i), predicted_values[row_offset + i],
+                        1e-3);
+        }
+        delete result;
+    }
+}
+
+TEST(DMDTest, Test_DMDProjectInitialConditions)
+{
+    int row_offset;
+    std::vector<std::vector<double>> local_samples = getLocalSamples(row_offset);
+    const int d_num_rows = local_samples[0].size();
+
+    CAROM::DMD dmd(d_num_rows, 1.0);
+    dmd.setSVDMethod(CAROM::DMD::SVDMethod::truncated);
+    for (int j = 0; j < 3; j++) {
+        dmd.takeSample(local_samples[j].data(), j);
+    }
+    dmd.train(2);
+
+    // Project all the samples at once.
+    CAROM::Matrix inits(d_num_rows, 3, true);
+    for (int i = 0; i < d_num_rows; i++) {
+        for (int j = 0; j < 3; j++) {
+            inits.item(i, j) = local_samples[j][i];
+        }
+    }
+    CAROM::Matrix* projected_real = NULL;
+    CAROM::Matrix* projected_imaginary = NULL;
+    dmd.projectInitialConditions(inits, projected_real, projected_imaginary);
+    CAROM::Matrix* results = dmd.predict(3.0, *projected_real,
+                                         *projected_imaginary);
+
+    // The first sample is the initial condition of the training.
+    for (int i = 0; i < d_num_rows; i++) {
+        EXPECT_NEAR(results->item(i, 0),
+                    predicted_values[row_offset + i], 1e-3);
+    }
+
+    // Each column matches the projection of its initial condition alone.
+    for (int j = 0; j < 3; j++) {
+        CAROM::Vector init(local_samples[j].data(), d_num_rows, true);
+        dmd.projectInitialCondition(&init);
+        CAROM::Vector* result = dmd.predict(3.0);
+        for (int i = 0; i < d_num_rows; i++) {
+            EXPECT_NEAR(results->item(i, j), result->item(i), 1e-12);
+        }
+        delete result;
+    }
+
+    delete projected_real;
+    delete projected_imaginary;
+    delete results;
+}
+
+TEST(DMDTest, Test_DMDRankDeficient)
+{
+    int d_rank, d_num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &d_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
+    const int num_total_rows = 5;
+    int d_num_rows = num_total_rows / d_num_procs;
+    int remainder = num_total_rows % d_num_procs;
+    int row_offset = d_rank * d_num_rows + std::min(d_rank, remainder);
+    if (d_rank < remainder) {
+        d_num_rows++;
+    }
+
+    // A rotation in the plane of a and b, so that the 6 snapshots have rank
+    // 2. Keeping all the energy, the DMD from the Gram matrix uses the 2
+    // nonzero singular values only and predicts the rotation exactly.
+    const double a[num_total_rows] = {1.0, 2.0, 0.0, -1.0, 0.5};
+    const double b[num_total_rows] = {0.0, 1.0, 1.0, 0.5, -2.0};
+    CAROM::DMD dmd(d_num_rows, 1.0);
+    dmd.setSVDMethod(CAROM::DMD::SVDMethod::truncated);
+    std::vector<double> sample(d_num_rows);
+    for (int j = 0; j < 6; j++) {
+        for (int i = 0; i < d_num_rows; i++) {
+            sample[i] = std::cos(0.5 * j) * a[row_offset + i] +
+                        std::sin(0.5 * j) * b[row_offset + i];
+        }
+        dmd.takeSample(sample.data(), j);
+    }
+    dmd.train(1.0);
+
+    CAROM::Vector* result = dmd.predict(7.0);
+    for (int i = 0; i < d_num_rows; i++) {
+        EXPECT_NEAR(result->item(i), std::cos(3.5) * a[row_offset + i] +
+                    std::sin(3.5) * b[row_offset + i], 1e-8);
+    }
+    delete result;
+}
+
+TEST(DMDTest, Test_WindowedDMD)
+{
+    int d_rank, d_num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &d_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
+    const int num_total_rows = 6;
+    int d_num_rows = num_total_rows / d_num_procs;
+    int remainder = num_total_rows % d_num_procs;
+    int row_offset = d_rank * d_num_rows + std::min(d_rank, remainder);
+    if (d_rank < remainder) {
+        d_num_rows++;
+    }
+
+    // 13 samples in windows of 4 samples overlapping by 1: the samples
+    // 0-5, 4-9 and 8-12. The window starting at sample 12 is not trained.
+    int num_samples = 13;
+    std::vector<std::vector<double>> samples(num_samples,
+                                             std::vector<double>(d_num_rows));
+    for (int j = 0; j < num_samples; j++) {
+        for (int i = 0; i < d_num_rows; i++) {
+            int row = row_offset + i;
+            samples[j][i] = std::cos(0.3 * (row + 1) * j) + 0.1 * row * j;
+        }
+    }
+
+    CAROM::WindowedDMD windowed_dmd(d_num_rows, 1.0, 4, 1);
+    for (int j = 0; j < num_samples; j++) {
+        windowed_dmd.takeSample(samples[j].data(), j);
+    }
+    EXPECT_EQ(windowed_dmd.getNumWindows(), 4);
+    windowed_dmd.train(3);
+    EXPECT_EQ(windowed_dmd.getWindowIndex(0.0), 0);
+    EXPECT_EQ(windowed_dmd.getWindowIndex(5.0), 1);
+    EXPECT_EQ(windowed_dmd.getWindowIndex(8.0), 2);
+    EXPECT_EQ(windowed_dmd.getWindowIndex(12.0), 2);
+
+    // Each window matches a DMD trained on its own samples.
+    int window_bounds[3][2] = {{0, 5}, {4, 9}, {8, 12}};
+    for (int w = 0; w < 3; w++) {
+        CAROM::DMD dmd(d_num_rows, 1.0);
+        dmd.setSVDMethod(CAROM::DMD::SVDMethod::truncated);
+        for (int j = window_bounds[w][0]; j <= window_bounds[w][1]; j++) {
+            dmd.takeSample(samples[j].data(), j);
+        }
+        dmd.train(3);
+
+        for (int j = window_bounds[w][0]; j <= window_bounds[w][1]; j++) {
+            CAROM::Vector* result = dmd.predict(j);
+            CAROM::Vector* result_windowed = windowed_dmd.getWindow(w)->predict(j);
+            for (int i = 0; i < d_num_rows; i++) {
+                EXPECT_NEAR(result_windowed->item(i), result->item(i), 1e-8);
+            }
+            delete result;
+            delete result_windowed;
+        }
+    }
+
+    CAROM::Vector* result = windowed_dmd.predict(6.5);
+    CAROM::Vector* result_window = windowed_dmd.getWindow(1)->predict(6.5);
+    for (int i = 0; i < d_num_rows; i++) {
+        EXPECT_NEAR(result->item(i), result_window->item(i), 1e-12);
+    }
+    delete result;
+    delete result_window;
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -16,7 +16,9 @@
 #ifdef CAROM_HAS_GTEST
 #include<gtest/gtest.h>
 #include <mpi.h>
+#include "linalg/BasisGenerator.h"
 #include "linalg/svd/IncrementalSVD.h"
+#include <cmath>
 
 /**
  * Simple smoke test to make sure Google Test is properly linked
@@ -138,10 +140,44 @@ TEST(IncrementalSVDSerialTest, Test_getSingularValues)
     }
 }
 
+TEST(IncrementalSVDSerialTest, Test_NewTimeIntervals)
+{
+    // Every second sample starts a new time interval, whose first sample
+    // replaces the basis of the interval before it.
+    CAROM::Options incremental_svd_options = CAROM::Options(3,
+            2).setMaxBasisDimension(3)
+            .setIncrementalSVD(1e-1, 1.0, 1e-1, 1.0);
+    CAROM::BasisGenerator generator(incremental_svd_options, true);
+
+    const int num_samples = 5;
+    double sample[3];
+    for (int s = 0; s < num_samples; s++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            sample[i] = std::sin(0.7 * (i + 1) * (s + 1)) + 0.1 * s;
+        }
+        EXPECT_TRUE(generator.takeSample(sample, s, 1.0));
+    }
+    EXPECT_EQ(generator.getNumBasisTimeIntervals(), 3);
+
+    const CAROM::Matrix* B = generator.getSpatialBasis();
+    ASSERT_EQ(B->numColumns(), 1);
+    const double norm = std::sqrt(sample[0] * sample[0] + sample[1] * sample[1]
+                                  + sample[2] * sample[2]);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_NEAR(B->item(i, 0), sample[i] / norm, 1e-12);
+    }
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
 }
 #else // #ifndef CAROM_HAS_GTEST
 int main()
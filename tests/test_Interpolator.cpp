@@ -0,0 +1,203 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::VectorInterpolator and
+// CAROM::MatrixInterpolator classes.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "algo/manifold_interp/MatrixInterpolator.h"
+#include "algo/manifold_interp/VectorInterpolator.h"
+#include "linalg/Matrix.h"
+#include "linalg/Vector.h"
+#include <cmath>
+#include <vector>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+const int num_points = 6;
+const double closest_rbf_val = 0.5;
+
+/**
+ * Unevenly spaced points on a line, with identity rotations, so that the
+ * rotated data are the data.
+ */
+void createPoints(std::vector<CAROM::Vector*>& points,
+                  std::vector<CAROM::Matrix*>& rotations)
+{
+    for (int i = 0; i < num_points; i++)
+    {
+        CAROM::Vector* point = new CAROM::Vector(1, false);
+        point->item(0) = i + 0.2 * std::sin(1.7 * i);
+        points.push_back(point);
+
+        CAROM::Matrix* rotation = new CAROM::Matrix(2, 2, false);
+        rotation->item(0, 0) = 1.0;
+        rotation->item(1, 1) = 1.0;
+        rotations.push_back(rotation);
+    }
+}
+
+/**
+ * Query points at a parameter point, between two parameter points and just
+ * outside the range of the parameter points, all within the support of the
+ * compactly supported RBF of some parameter point.
+ */
+std::vector<double> createQueries(const std::vector<CAROM::Vector*>& points)
+{
+    std::vector<double> queries;
+    queries.push_back(points[2]->item(0));
+    queries.push_back(0.5 * (points[3]->item(0) + points[4]->item(0)));
+    queries.push_back(points[num_points - 1]->item(0) + 0.1);
+    return queries;
+}
+
+/**
+ * The IDW weights of the parameter points at query, computed with the RBFs
+ * of all the parameter points.
+ */
+std::vector<double> computeWeights(std::vector<CAROM::Vector*>& points,
+                                   double query)
+{
+    double epsilon = CAROM::convertClosestRBFToEpsilon(points, "W",
+                     closest_rbf_val);
+    CAROM::Vector point(1, false);
+    point.item(0) = query;
+    std::vector<double> weights = CAROM::obtainRBFToTrainingPoints(points,
+                                  "IDW", "W", epsilon, &point);
+    double sum = CAROM::rbfWeightedSum(weights);
+    for (int i = 0; i < num_points; i++)
+    {
+        weights[i] /= sum;
+    }
+    return weights;
+}
+
+TEST(InterpolatorSerialTest, Test_VectorInterpolatorCompactIDW)
+{
+    std::vector<CAROM::Vector*> points;
+    std::vector<CAROM::Matrix*> rotations;
+    createPoints(points, rotations);
+    std::vector<CAROM::Vector*> vectors;
+    for (int i = 0; i < num_points; i++)
+    {
+        CAROM::Vector* v = new CAROM::Vector(2, false);
+        v->item(0) = std::sin(points[i]->item(0));
+        v->item(1) = points[i]->item(0) * points[i]->item(0);
+        vectors.push_back(v);
+    }
+
+    // Only the parameter points within the support of the RBF are used, and
+    // the result is the weighted average of the data.
+    CAROM::VectorInterpolator interpolator(points, rotations, vectors, 0, "W",
+                                           "IDW", closest_rbf_val);
+    std::vector<double> queries = createQueries(points);
+    for (size_t q = 0; q < queries.size(); q++)
+    {
+        std::vector<double> weights = computeWeights(points, queries[q]);
+        CAROM::Vector point(1, false);
+        point.item(0) = queries[q];
+        CAROM::Vector* result = interpolator.interpolate(&point);
+        for (int j = 0; j < 2; j++)
+        {
+            double expected = 0.0;
+            for (int i = 0; i < num_points; i++)
+            {
+                expected += weights[i] * vectors[i]->item(j);
+            }
+            EXPECT_TRUE(std::isfinite(result->item(j)));
+            EXPECT_NEAR(result->item(j), expected, 1.0e-12);
+        }
+        delete result;
+    }
+
+    for (int i = 0; i < num_points; i++)
+    {
+        delete points[i];
+        delete rotations[i];
+        delete vectors[i];
+    }
+}
+
+TEST(InterpolatorSerialTest, Test_MatrixInterpolatorCompactIDW)
+{
+    std::vector<CAROM::Vector*> points;
+    std::vector<CAROM::Matrix*> rotations;
+    createPoints(points, rotations);
+    std::vector<CAROM::Matrix*> matrices;
+    for (int i = 0; i < num_points; i++)
+    {
+        double x = points[i]->item(0);
+        CAROM::Matrix* m = new CAROM::Matrix(2, 2, false);
+        m->item(0, 0) = x;
+        m->item(0, 1) = 1.0;
+        m->item(1, 0) = std::cos(x);
+        m->item(1, 1) = x * x;
+        matrices.push_back(m);
+    }
+
+    CAROM::MatrixInterpolator interpolator(points, rotations, matrices, 0, "R",
+                                           "W", "IDW", closest_rbf_val);
+    std::vector<double> queries = createQueries(points);
+    for (size_t q = 0; q < queries.size(); q++)
+    {
+        std::vector<double> weights = computeWeights(points, queries[q]);
+        CAROM::Vector point(1, false);
+        point.item(0) = queries[q];
+        CAROM::Matrix* result = interpolator.interpolate(&point);
+        for (int r = 0; r < 2; r++)
+        {
+            for (int c = 0; c < 2; c++)
+            {
+                double expected = 0.0;
+                for (int i = 0; i < num_points; i++)
+                {
+                    expected += weights[i] * matrices[i]->item(r, c);
+                }
+                EXPECT_TRUE(std::isfinite(result->item(r, c)));
+                EXPECT_NEAR(result->item(r, c), expected, 1.0e-12);
+            }
+        }
+        delete result;
+    }
+
+    for (int i = 0; i < num_points; i++)
+    {
+        delete points[i];
+        delete rotations[i];
+        delete matrices[i];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
@@ -0,0 +1,177 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::KDTree class and the compactly
+// supported RBF interpolation that uses it.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "algo/manifold_interp/KDTree.h"
+#include "algo/manifold_interp/VectorInterpolator.h"
+#include "linalg/Matrix.h"
+#include "linalg/Vector.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+const int num_points = 100;
+
+/**
+ * Points on a perturbed 2D grid, which is deterministic and has no ties.
+ */
+std::vector<CAROM::Vector*> createPoints()
+{
+    std::vector<CAROM::Vector*> points;
+    for (int i = 0; i < num_points; i++)
+    {
+        CAROM::Vector* point = new CAROM::Vector(2, false);
+        point->item(0) = (i % 10) + 0.3 * std::sin(1.7 * i);
+        point->item(1) = (i / 10) + 0.3 * std::cos(2.3 * i);
+        points.push_back(point);
+    }
+    return points;
+}
+
+double distance(const CAROM::Vector* a, const CAROM::Vector* b)
+{
+    double dx = a->item(0) - b->item(0);
+    double dy = a->item(1) - b->item(1);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+TEST(KDTreeSerialTest, Test_radiusSearch)
+{
+    std::vector<CAROM::Vector*> points = createPoints();
+    CAROM::KDTree tree(points);
+    EXPECT_EQ(tree.numPoints(), num_points);
+
+    CAROM::Vector query(2, false);
+    std::vector<int> indices;
+    for (int q = 0; q < 20; q++)
+    {
+        query.item(0) = 0.47 * q - 0.5;
+        query.item(1) = 0.53 * q - 0.5;
+        double radius = 0.5 + 0.1 * q;
+        tree.radiusSearch(&query, radius, indices);
+        std::sort(indices.begin(), indices.end());
+
+        std::vector<int> expected;
+        for (int i = 0; i < num_points; i++)
+        {
+            if (distance(&query, points[i]) < radius)
+            {
+                expected.push_back(i);
+            }
+        }
+        EXPECT_EQ(indices, expected);
+    }
+
+    for (int i = 0; i < num_points; i++)
+    {
+        delete points[i];
+    }
+}
+
+TEST(KDTreeSerialTest, Test_nearestNeighbor)
+{
+    std::vector<CAROM::Vector*> points = createPoints();
+    CAROM::KDTree tree(points);
+
+    for (int i = 0; i < num_points; i++)
+    {
+        int expected = -1;
+        double expected_distance = 0.0;
+        for (int j = 0; j < num_points; j++)
+        {
+            double dist = distance(points[i], points[j]);
+            if (j != i && (expected == -1 || dist < expected_distance))
+            {
+                expected = j;
+                expected_distance = dist;
+            }
+        }
+        EXPECT_EQ(tree.nearestNeighbor(points[i]), i);
+        EXPECT_EQ(tree.nearestNeighbor(points[i], i), expected);
+    }
+
+    for (int i = 0; i < num_points; i++)
+    {
+        delete points[i];
+    }
+}
+
+TEST(KDTreeSerialTest, Test_compactRBFInterpolation)
+{
+    // An LS interpolant with the compactly supported RBF reproduces the data
+    // at the parameter points and only sees the nearby points elsewhere.
+    std::vector<CAROM::Vector*> points = createPoints();
+    std::vector<CAROM::Vector*> data;
+    for (int i = 0; i < num_points; i++)
+    {
+        CAROM::Vector* f = new CAROM::Vector(2, false);
+        f->item(0) = std::sin(points[i]->item(0)) * std::cos(points[i]->item(1));
+        f->item(1) = points[i]->item(0) * points[i]->item(1);
+        data.push_back(f);
+    }
+
+    double epsilon = CAROM::convertClosestRBFToEpsilon(points, "W", 0.5);
+    CAROM::Matrix* f_T = CAROM::solveLinearSystem(points, data, "LS", "W",
+                         epsilon);
+    CAROM::KDTree tree(points);
+
+    for (int i = 0; i < num_points; i++)
+    {
+        std::vector<double> rbf = CAROM::obtainRBFToTrainingPoints(points, "LS",
+                                  "W", epsilon, points[i], &tree);
+        std::vector<double> rbf_all = CAROM::obtainRBFToTrainingPoints(points,
+                                      "LS", "W", epsilon, points[i]);
+        EXPECT_EQ(rbf, rbf_all);
+
+        CAROM::Vector* f = CAROM::obtainInterpolatedVector(data, f_T, "LS", rbf);
+        EXPECT_NEAR(f->item(0), data[i]->item(0), 1.0e-10);
+        EXPECT_NEAR(f->item(1), data[i]->item(1), 1.0e-10);
+        delete f;
+    }
+
+    delete f_T;
+    for (int i = 0; i < num_points; i++)
+    {
+        delete points[i];
+        delete data[i];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
@@ -0,0 +1,314 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::NNLSSolver class.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "linalg/Matrix.h"
+#include "linalg/NNLS.h"
+#include "linalg/Vector.h"
+#include <cmath>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+const int num_local_cols = 6;
+const double halfgap = 1.0e-6;
+
+/**
+ * A nonnegative least-squares problem with num_constraints constraints and
+ * num_local_cols columns on each process. The transpose of the matrix is
+ * distributed by rows, and the bounds, which are identical on all processes,
+ * are those of a nonnegative combination of every stride-th column.
+ */
+void createProblem(int num_constraints, int myid, int num_procs,
+                   CAROM::Matrix& matTrans, CAROM::Vector& rhs_lb,
+                   CAROM::Vector& rhs_ub, int stride = 3)
+{
+    matTrans.setSize(num_local_cols, num_constraints);
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        const int col = myid * num_local_cols + j;
+        for (int i = 0; i < num_constraints; i++)
+        {
+            matTrans(j, i) = 1.0 + 0.5 * std::sin(1.3 * (col + 1) * (i + 1));
+        }
+    }
+
+    // Every stride-th column, over all processes, has a nonzero weight.
+    const int num_cols = num_procs * num_local_cols;
+    rhs_lb.setSize(num_constraints);
+    rhs_ub.setSize(num_constraints);
+    for (int i = 0; i < num_constraints; i++)
+    {
+        double b = 0.0;
+        for (int col = 0; col < num_cols; col += stride)
+        {
+            b += (1.0 + 0.1 * col) * (1.0 + 0.5 * std::sin(1.3 * (col + 1) *
+                                      (i + 1)));
+        }
+        rhs_lb(i) = b - halfgap;
+        rhs_ub(i) = b + halfgap;
+    }
+}
+
+/**
+ * Checks that soln is nonnegative and satisfies the bounds.
+ */
+void checkSolution(const CAROM::Matrix& matTrans, const CAROM::Vector& rhs_lb,
+                   const CAROM::Vector& rhs_ub, const CAROM::Vector& soln)
+{
+    const int num_constraints = matTrans.numColumns();
+    CAROM::Vector res(num_constraints, false);
+    res = 0.0;
+    for (int j = 0; j < matTrans.numRows(); j++)
+    {
+        EXPECT_GE(soln(j), 0.0);
+        for (int i = 0; i < num_constraints; i++)
+        {
+            res(i) += matTrans(j, i) * soln(j);
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, res.getData(), num_constraints, MPI_DOUBLE,
+                  MPI_SUM, MPI_COMM_WORLD);
+    for (int i = 0; i < num_constraints; i++)
+    {
+        EXPECT_GE(res(i), rhs_lb(i) - 1.0e-10);
+        EXPECT_LE(res(i), rhs_ub(i) + 1.0e-10);
+    }
+}
+
+/**
+ * Checks that warm_soln is the solution cold_soln of a cold solve. Columns
+ * outside the support of one may have values at the level of rounding errors
+ * in the other.
+ */
+void checkWarmSolution(const CAROM::Vector& warm_soln,
+                       const CAROM::Vector& cold_soln)
+{
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        EXPECT_NEAR(warm_soln(j), cold_soln(j), 1.0e-10);
+    }
+}
+
+TEST(NNLSTest, Test_WarmStart)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    const int num_constraints = 40;
+    CAROM::Matrix matTrans(num_local_cols, num_constraints, true);
+    CAROM::Vector rhs_lb, rhs_ub;
+    createProblem(num_constraints, myid, num_procs, matTrans, rhs_lb, rhs_ub);
+
+    // The solver keeps its BLACS grid and its buffers across the solves.
+    CAROM::NNLSSolver solver;
+    CAROM::Vector cold_soln(num_local_cols, true);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, cold_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+    checkSolution(matTrans, rhs_lb, rhs_ub, cold_soln);
+
+    CAROM::Vector second_soln(num_local_cols, true);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, second_soln);
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        EXPECT_EQ(second_soln(j), cold_soln(j));
+    }
+
+    // Warm started from the cold solution, the solver returns it after a
+    // single least-squares solve on its support.
+    solver.set_warm_start(true);
+    CAROM::Vector warm_soln(cold_soln);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, warm_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+    EXPECT_EQ(solver.getNumOuterIterations(), 1);
+    EXPECT_EQ(solver.getNumInnerIterations(), 1);
+    checkSolution(matTrans, rhs_lb, rhs_ub, warm_soln);
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        EXPECT_NEAR(warm_soln(j), cold_soln(j), 1.0e-10);
+        EXPECT_EQ(warm_soln(j) == 0.0, cold_soln(j) == 0.0);
+    }
+}
+
+TEST(NNLSTest, Test_WarmStartFromRelatedProblem)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    const int num_constraints = 40;
+    CAROM::Matrix matTrans(num_local_cols, num_constraints, true);
+    CAROM::Vector rhs_lb, rhs_ub;
+    createProblem(num_constraints, myid, num_procs, matTrans, rhs_lb, rhs_ub);
+
+    CAROM::NNLSSolver cold_solver;
+    CAROM::Vector cold_soln(num_local_cols, true);
+    cold_solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub,
+            cold_soln);
+
+    // The solution of a problem with different weights is supported on every
+    // other column, so that columns both leave and enter the support of the
+    // warm start.
+    CAROM::Matrix relatedMatTrans(num_local_cols, num_constraints, true);
+    CAROM::Vector related_lb, related_ub;
+    createProblem(num_constraints, myid, num_procs, relatedMatTrans,
+                  related_lb, related_ub, 2);
+    CAROM::NNLSSolver solver;
+    CAROM::Vector warm_soln(num_local_cols, true);
+    solver.solve_parallel_with_scalapack(relatedMatTrans, related_lb,
+                                         related_ub, warm_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+
+    solver.set_warm_start(true);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, warm_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+    EXPECT_GT(solver.getNumInnerIterations(), solver.getNumOuterIterations());
+    checkSolution(matTrans, rhs_lb, rhs_ub, warm_soln);
+    checkWarmSolution(warm_soln, cold_soln);
+}
+
+TEST(NNLSTest, Test_WarmStartFromWrongSupport)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    const int num_constraints = 40;
+    CAROM::Matrix matTrans(num_local_cols, num_constraints, true);
+    CAROM::Vector rhs_lb, rhs_ub;
+    createProblem(num_constraints, myid, num_procs, matTrans, rhs_lb, rhs_ub);
+
+    CAROM::NNLSSolver solver;
+    CAROM::Vector cold_soln(num_local_cols, true);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, cold_soln);
+    solver.set_warm_start(true);
+
+    // From a superset of the support, the extra columns leave it in the
+    // first outer iteration.
+    CAROM::Vector superset_soln(cold_soln);
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        if (superset_soln(j) == 0.0)
+        {
+            superset_soln(j) = 0.5;
+        }
+    }
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub,
+                                         superset_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+    EXPECT_EQ(solver.getNumOuterIterations(), 1);
+    EXPECT_GT(solver.getNumInnerIterations(), 1);
+    checkSolution(matTrans, rhs_lb, rhs_ub, superset_soln);
+    checkWarmSolution(superset_soln, cold_soln);
+
+    // From a subset of the support, the missing columns enter it in later
+    // outer iterations, one at a time as in a cold solve.
+    CAROM::Vector subset_soln(cold_soln);
+    subset_soln(0) = 0.0;
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, subset_soln);
+    EXPECT_EQ(solver.getExitFlag(), 0);
+    EXPECT_GT(solver.getNumOuterIterations(), 1);
+    checkSolution(matTrans, rhs_lb, rhs_ub, subset_soln);
+    checkWarmSolution(subset_soln, cold_soln);
+}
+
+TEST(NNLSTest, Test_WarmStartSquareFallback)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // A warm start supported on at least as many columns as constraints is
+    // replaced by a cold solve.
+    const int num_constraints = 4;
+    CAROM::Matrix matTrans(num_local_cols, num_constraints, true);
+    CAROM::Vector rhs_lb, rhs_ub;
+    createProblem(num_constraints, myid, num_procs, matTrans, rhs_lb, rhs_ub);
+
+    CAROM::NNLSSolver solver;
+    CAROM::Vector cold_soln(num_local_cols, true);
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, cold_soln);
+    const int cold_exit_flag = solver.getExitFlag();
+    const int cold_outer_iter = solver.getNumOuterIterations();
+    const int cold_inner_iter = solver.getNumInnerIterations();
+
+    solver.set_warm_start(true);
+    CAROM::Vector warm_soln(num_local_cols, true);
+    warm_soln = 1.0;
+    solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, warm_soln);
+    EXPECT_EQ(solver.getExitFlag(), cold_exit_flag);
+    EXPECT_EQ(solver.getNumOuterIterations(), cold_outer_iter);
+    EXPECT_EQ(solver.getNumInnerIterations(), cold_inner_iter);
+    for (int j = 0; j < num_local_cols; j++)
+    {
+        EXPECT_EQ(warm_soln(j), cold_soln(j));
+    }
+}
+
+TEST(NNLSTest, Test_ReuseSolver)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // A solver that first solves a smaller problem grows its buffers for a
+    // larger one and gets the solution of a new solver.
+    CAROM::NNLSSolver solver;
+    const int num_constraints[2] = {20, 40};
+    for (int p = 0; p < 2; p++)
+    {
+        CAROM::Matrix matTrans(num_local_cols, num_constraints[p], true);
+        CAROM::Vector rhs_lb, rhs_ub;
+        createProblem(num_constraints[p], myid, num_procs, matTrans, rhs_lb,
+                      rhs_ub);
+
+        CAROM::Vector soln(num_local_cols, true);
+        solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub, soln);
+        checkSolution(matTrans, rhs_lb, rhs_ub, soln);
+
+        CAROM::NNLSSolver new_solver;
+        CAROM::Vector new_soln(num_local_cols, true);
+        new_solver.solve_parallel_with_scalapack(matTrans, rhs_lb, rhs_ub,
+                new_soln);
+        for (int j = 0; j < num_local_cols; j++)
+        {
+            EXPECT_EQ(soln(j), new_soln(j));
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
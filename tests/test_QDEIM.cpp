@@ -18,6 +18,7 @@
 #include <mpi.h>
 #include "hyperreduction/QDEIM.h"
 #include "linalg/Matrix.h"
+#include <vector>
 #define _USE_MATH_DEFINES
 #include <cmath>
 
@@ -145,11 +146,123 @@ TEST(QDEIMSerialTest, Test_QDEIM_gpode_oversampling)
     EXPECT_TRUE(l2_norm_diff < 1e-5);
 }
 
+TEST(QDEIMParallelTest, Test_qrcp_pivots_transpose_distributed)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // A few rows dominate in well-separated, nearly orthogonal directions,
+    // so the pivots chosen by the tournament of the processes are those of
+    // the serial QRCP, whatever the distribution of the rows.
+    const int num_rows = 24;
+    const int num_cols = 4;
+    const int dominant_rows[num_cols] = {17, 3, 22, 10};
+    CAROM::Matrix basis(num_rows, num_cols, false);
+    for (int i = 0; i < num_rows; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            basis(i, j) = 0.01 * std::sin(1.3 * i + 0.7 * j);
+        }
+    }
+    for (int k = 0; k < num_cols; k++) {
+        basis(dominant_rows[k], k) += 8.0 - 2.0 * k;
+    }
+
+    std::vector<int> serial_pivot(num_cols), serial_owner(num_cols);
+    basis.qrcp_pivots_transpose(serial_pivot.data(), serial_owner.data(),
+                                num_cols);
+    for (int k = 0; k < num_cols; k++) {
+        EXPECT_EQ(serial_pivot[k], dominant_rows[k]);
+    }
+
+    std::vector<int> row_offset(num_procs + 1, 0);
+    for (int p = 0; p < num_procs; p++) {
+        row_offset[p + 1] = row_offset[p] + num_rows / num_procs
+                            + (p < num_rows % num_procs ? 1 : 0);
+    }
+    const int num_local_rows = row_offset[myid + 1] - row_offset[myid];
+    CAROM::Matrix local_basis(num_local_rows, num_cols, true);
+    for (int i = 0; i < num_local_rows; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            local_basis(i, j) = basis(row_offset[myid] + i, j);
+        }
+    }
+
+    std::vector<int> pivot(num_cols), owner(num_cols);
+    local_basis.qrcp_pivots_transpose(pivot.data(), owner.data(), num_cols);
+    if (myid == 0) {
+        for (int k = 0; k < num_cols; k++) {
+            EXPECT_EQ(pivot[k], serial_pivot[k]);
+            EXPECT_TRUE(row_offset[owner[k]] <= pivot[k]
+                        && pivot[k] < row_offset[owner[k] + 1]);
+        }
+    }
+}
+
+TEST(QDEIMParallelTest, Test_QDEIM_distributed)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // The orthonormal input matrix of Test_QDEIM, distributed by rows.
+    const double orthonormal_mat[50] = {
+        -0.1067,   -0.4723,   -0.4552,    0.1104,   -0.2337,
+        0.1462,    0.6922,   -0.2716,    0.1663,    0.3569,
+        0.4087,   -0.3437,    0.4952,   -0.3356,    0.3246,
+        0.2817,   -0.0067,   -0.0582,   -0.0034,    0.0674,
+        0.5147,    0.1552,   -0.1635,   -0.3440,   -0.3045,
+        -0.4628,    0.0141,   -0.1988,   -0.5766,    0.0150,
+        -0.2203,    0.3283,    0.2876,   -0.4597,   -0.1284,
+        -0.0275,    0.1202,   -0.0924,   -0.2290,   -0.3808,
+        0.4387,   -0.0199,   -0.3338,   -0.1711,   -0.2220,
+        0.0101,    0.1807,    0.4488,    0.3219,   -0.6359
+    };
+    const int num_cols = 5;
+    const int num_rows = 10;
+    std::vector<int> row_offset(num_procs + 1, 0);
+    for (int p = 0; p < num_procs; p++) {
+        row_offset[p + 1] = row_offset[p] + num_rows / num_procs
+                            + (p < num_rows % num_procs ? 1 : 0);
+    }
+    const int num_local_rows = row_offset[myid + 1] - row_offset[myid];
+    CAROM::Matrix u(num_local_rows, num_cols, true);
+    for (int i = 0; i < num_local_rows; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            u(i, j) = orthonormal_mat[(row_offset[myid] + i) * num_cols + j];
+        }
+    }
+
+    // The rows sampled by Test_QDEIM and Test_QDEIM_gpode_oversampling.
+    const std::vector<std::vector<int>> serial_rows{{1, 2, 4, 6, 9},
+        {0, 1, 2, 4, 5, 6, 8, 9}};
+    for (const std::vector<int>& expected_rows : serial_rows) {
+        const int num_samples = expected_rows.size();
+        std::vector<int> f_sampled_row(num_samples, 0);
+        std::vector<int> f_sampled_rows_per_proc(num_procs, 0);
+        CAROM::Matrix f_basis_sampled_inv(num_samples, num_cols, false);
+        CAROM::QDEIM(&u, num_cols, f_sampled_row, f_sampled_rows_per_proc,
+                     f_basis_sampled_inv, myid, num_procs, num_samples);
+
+        // The sampled rows are ordered by process and then by local row, so
+        // in global order.
+        int k = 0;
+        for (int p = 0; p < num_procs; p++) {
+            for (int i = 0; i < f_sampled_rows_per_proc[p]; i++, k++) {
+                EXPECT_EQ(row_offset[p] + f_sampled_row[k], expected_rows[k]);
+            }
+        }
+        EXPECT_EQ(k, num_samples);
+    }
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
     MPI_Init(&argc, &argv);
-    return RUN_ALL_TESTS();
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
 }
 #else // #ifndef CAROM_HAS_GTEST
 int main()
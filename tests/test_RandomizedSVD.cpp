@@ -21,6 +21,7 @@
 #include "linalg/BasisGenerator.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstdio>
 
 /**
  * Simple smoke test to make sure Google Test is properly linked
@@ -445,6 +446,78 @@ TEST(RandomizedSVDTest, Test_RandomizedSVDTransposedSmallerSubspace)
     }
 }
 
+TEST(RandomizedSVDTest, Test_RandomizedSVDRestoreState)
+{
+    // Get the rank of this process, and the number of processors.
+    int mpi_init, d_rank, d_num_procs;
+    MPI_Initialized(&mpi_init);
+    if (mpi_init == 0) {
+        MPI_Init(nullptr, nullptr);
+    }
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &d_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &d_num_procs);
+
+    int num_total_rows = 5;
+    int d_num_rows = num_total_rows / d_num_procs;
+    if (num_total_rows % d_num_procs > d_rank) {
+        d_num_rows++;
+    }
+    int *row_offset = new int[d_num_procs + 1];
+    row_offset[d_num_procs] = num_total_rows;
+    row_offset[d_rank] = d_num_rows;
+
+    MPI_Allgather(MPI_IN_PLACE,
+                  1,
+                  MPI_INT,
+                  row_offset,
+                  1,
+                  MPI_INT,
+                  MPI_COMM_WORLD);
+
+    for (int i = d_num_procs - 1; i >= 0; i--) {
+        row_offset[i] = row_offset[i + 1] - row_offset[i];
+    }
+
+    double* sample1 = new double[5] {0.5377, 1.8339, -2.2588, 0.8622, 0.3188};
+    double* sample2 = new double[5] {-1.3077, -0.4336, 0.3426, 3.5784, 2.7694};
+    double* sample3 = new double[5] {-1.3499, 3.0349, 0.7254, -0.0631, 0.7147};
+
+    double* sv_true_ans = new double[3] {
+        4.74592085430968513293e+00,      3.25364999902110074714e+00,      2.14185949946548248590e+00
+    };
+
+    CAROM::Options randomized_svd_options = CAROM::Options(d_num_rows, 3, 1);
+    randomized_svd_options.setMaxBasisDimension(num_total_rows);
+    randomized_svd_options.setDebugMode(true);
+    randomized_svd_options.setRandomizedSVD(true);
+
+    // Checkpoint after two samples, then resume from the checkpoint.
+    {
+        CAROM::BasisGenerator sampler(randomized_svd_options, false,
+                                      "randomized_svd_state");
+        sampler.takeSample(&sample1[row_offset[d_rank]], 0, 0);
+        sampler.takeSample(&sample2[row_offset[d_rank]], 0, 0);
+        sampler.saveState();
+    }
+
+    randomized_svd_options.setStateIO(false, true);
+    CAROM::BasisGenerator sampler(randomized_svd_options, false,
+                                  "randomized_svd_state");
+    EXPECT_EQ(sampler.getNumBasisTimeIntervals(), 1);
+    sampler.takeSample(&sample3[row_offset[d_rank]], 0, 0);
+
+    const CAROM::Vector* sv = sampler.getSingularValues();
+    EXPECT_EQ(sv->dim(), 3);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(sv->item(i), sv_true_ans[i], 1e-7);
+    }
+
+    char state_file_name[100];
+    sprintf(state_file_name, "randomized_svd_state.state.%06d", d_rank);
+    std::remove(state_file_name);
+}
+
 int main(int argc, char* argv[])
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,133 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::SpaceTimeSampling algorithm.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "linalg/Matrix.h"
+#include <vector>
+#include "hyperreduction/STSampling.h"
+#include <cmath>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+TEST(STSamplingTest, Test_SpaceTimeSampling)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    const int num_rows = 200;
+    const int num_times = 50;
+    const int num_cols = 6;
+    const int num_t_samples = 8;
+    const int num_s_samples = 12;
+
+    // The spatial basis is distributed evenly over the processes and the
+    // temporal basis is stored on every process.
+    const int row_offset = myid * num_rows / num_procs;
+    const int num_local_rows = (myid + 1) * num_rows / num_procs - row_offset;
+    CAROM::Matrix s_basis(num_local_rows, num_cols, true);
+    CAROM::Matrix t_basis(num_times, num_cols, false);
+    for (int i = 0; i < num_local_rows; i++) {
+        const int row = row_offset + i;
+        for (int j = 0; j < num_cols; j++) {
+            s_basis.item(i, j) = sin(0.0123 * (row + 1) * (j + 1) + 0.3 * j) +
+                                 0.05 * cos(7.1 * row * j + row);
+        }
+    }
+    for (int i = 0; i < num_times; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            t_basis.item(i, j) = cos(0.031 * (i + 1) * (j + 2) + 0.2 * j) +
+                                 0.03 * sin(3.3 * i * j);
+        }
+    }
+
+    std::vector<int> t_samples(num_t_samples);
+    std::vector<int> f_sampled_row(num_s_samples);
+    std::vector<int> f_sampled_rows_per_proc(num_procs);
+    CAROM::Matrix s_basis_sampled(num_s_samples, num_cols, false);
+    CAROM::SpaceTimeSampling(&s_basis, &t_basis, num_cols, t_samples,
+                             f_sampled_row.data(), f_sampled_rows_per_proc.data(),
+                             s_basis_sampled, myid, num_procs, num_t_samples,
+                             num_s_samples, true);
+
+    // The samples do not depend on the number of processes.
+    std::vector<int> t_samples_true_ans{0, 15, 30, 32, 38, 45, 46, 48};
+    std::vector<int> s_samples_true_ans{11, 13, 52, 55, 126, 128, 129, 132,
+                                        157, 160, 193, 198};
+    EXPECT_EQ(t_samples, t_samples_true_ans);
+    std::vector<int> s_samples;
+    int idx = 0;
+    for (int p = 0; p < num_procs; p++) {
+        for (int i = 0; i < f_sampled_rows_per_proc[p]; i++, idx++) {
+            s_samples.push_back(p * num_rows / num_procs + f_sampled_row[idx]);
+        }
+    }
+    EXPECT_EQ(s_samples, s_samples_true_ans);
+
+    // The sampled spatial basis holds the sampled rows.
+    for (int i = 0; i < num_s_samples; i++) {
+        const int row = s_samples_true_ans[i];
+        for (int j = 0; j < num_cols; j++) {
+            EXPECT_NEAR(s_basis_sampled.item(i, j),
+                        sin(0.0123 * (row + 1) * (j + 1) + 0.3 * j) +
+                        0.05 * cos(7.1 * row * j + row), 1e-14);
+        }
+    }
+
+    // The transposed pseudo-inverse of the sampled space-time basis Phi
+    // satisfies Phi^T X = I.
+    CAROM::Matrix f_basis_sampled_inv(num_t_samples * num_s_samples, num_cols,
+                                      false);
+    CAROM::GetSampledSpaceTimeBasis(t_samples, &t_basis, s_basis_sampled,
+                                    f_basis_sampled_inv);
+    for (int j = 0; j < num_cols; j++) {
+        for (int l = 0; l < num_cols; l++) {
+            double product = 0.0;
+            for (int si = 0; si < num_s_samples; si++) {
+                for (int ti = 0; ti < num_t_samples; ti++) {
+                    const int row = ti + si * num_t_samples;
+                    product += s_basis_sampled.item(si, j) *
+                               t_basis.item(t_samples[ti], j) *
+                               f_basis_sampled_inv.item(row, l);
+                }
+            }
+            EXPECT_NEAR(product, j == l ? 1.0 : 0.0, 1e-8);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST
@@ -0,0 +1,216 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2013-2022, Lawrence Livermore National Security, LLC
+ * and other libROM project developers. See the top-level COPYRIGHT
+ * file for details.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR MIT)
+ *
+ *****************************************************************************/
+
+// Description: This source file is a test runner that uses the Google Test
+// Framework to run unit tests on the CAROM::SampleCache class.
+
+#include <iostream>
+
+#ifdef CAROM_HAS_GTEST
+#include<gtest/gtest.h>
+#include <mpi.h>
+#include "hyperreduction/DEIM.h"
+#include "hyperreduction/SampleCache.h"
+#include "linalg/Matrix.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Simple smoke test to make sure Google Test is properly linked
+ */
+TEST(GoogleTestFramework, GoogleTestFrameworkFound) {
+    SUCCEED();
+}
+
+/**
+ * A distributed basis with 10 rows per process and deterministic entries.
+ */
+CAROM::Matrix* createBasis(int num_cols, int myid)
+{
+    const int num_local_rows = 10;
+    CAROM::Matrix* basis = new CAROM::Matrix(num_local_rows, num_cols, true);
+    for (int i = 0; i < num_local_rows; i++)
+    {
+        int row = myid * num_local_rows + i;
+        for (int j = 0; j < num_cols; j++)
+        {
+            basis->item(i, j) = std::sin(1.3 * row * (j + 1) + 0.7 * j);
+        }
+    }
+    return basis;
+}
+
+TEST(SampleCacheTest, Test_SaveLoad)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    const std::string file_name = "test_SampleCache_samples";
+    const int num_cols = 4;
+    CAROM::Matrix* basis = createBasis(num_cols, myid);
+
+    CAROM::SampleCache cache(file_name, "DEIM", basis, num_cols,
+                             std::vector<int>(), myid, num_procs);
+    std::vector<int> f_sampled_row(num_cols);
+    std::vector<int> f_sampled_rows_per_proc(num_procs);
+    CAROM::Matrix f_basis_sampled_inv(num_cols, num_cols, false);
+    if (myid == 0)
+    {
+        std::remove(file_name.c_str());
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    EXPECT_FALSE(cache.load(f_sampled_row, f_sampled_rows_per_proc,
+                            f_basis_sampled_inv));
+
+    CAROM::DEIM(basis, num_cols, f_sampled_row, f_sampled_rows_per_proc,
+                f_basis_sampled_inv, myid, num_procs);
+    cache.save(f_sampled_row, f_sampled_rows_per_proc, f_basis_sampled_inv);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // A cache built from the same inputs loads the samples on every process.
+    CAROM::SampleCache same_cache(file_name, "DEIM", basis, num_cols,
+                                  std::vector<int>(), myid, num_procs);
+    EXPECT_EQ(same_cache.getFingerprint(), cache.getFingerprint());
+    std::vector<int> cached_row;
+    std::vector<int> cached_rows_per_proc;
+    CAROM::Matrix cached_inv(1, 1, false);
+    EXPECT_TRUE(same_cache.load(cached_row, cached_rows_per_proc, cached_inv));
+    EXPECT_EQ(cached_row, f_sampled_row);
+    EXPECT_EQ(cached_rows_per_proc, f_sampled_rows_per_proc);
+    EXPECT_EQ(cached_inv.numRows(), num_cols);
+    EXPECT_EQ(cached_inv.numColumns(), num_cols);
+    for (int i = 0; i < num_cols; i++)
+    {
+        for (int j = 0; j < num_cols; j++)
+        {
+            EXPECT_EQ(cached_inv.item(i, j), f_basis_sampled_inv.item(i, j));
+        }
+    }
+
+    // Other parameters, another algorithm, fewer basis vectors or a change
+    // of the basis on a single process all miss.
+    std::vector<int> parameters(1, num_cols + 1);
+    CAROM::SampleCache parameter_cache(file_name, "DEIM", basis, num_cols,
+                                       parameters, myid, num_procs);
+    EXPECT_FALSE(parameter_cache.load(cached_row, cached_rows_per_proc,
+                                      cached_inv));
+    CAROM::SampleCache algorithm_cache(file_name, "QDEIM", basis, num_cols,
+                                       std::vector<int>(), myid, num_procs);
+    EXPECT_FALSE(algorithm_cache.load(cached_row, cached_rows_per_proc,
+                                      cached_inv));
+    CAROM::SampleCache column_cache(file_name, "DEIM", basis, num_cols - 1,
+                                    std::vector<int>(), myid, num_procs);
+    EXPECT_FALSE(column_cache.load(cached_row, cached_rows_per_proc,
+                                   cached_inv));
+
+    if (myid == num_procs - 1)
+    {
+        basis->item(3, 2) += 1.0e-12;
+    }
+    CAROM::SampleCache basis_cache(file_name, "DEIM", basis, num_cols,
+                                   std::vector<int>(), myid, num_procs);
+    EXPECT_FALSE(basis_cache.load(cached_row, cached_rows_per_proc,
+                                  cached_inv));
+
+    // The misses leave the outputs untouched.
+    EXPECT_EQ(cached_row, f_sampled_row);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (myid == 0)
+    {
+        std::remove(file_name.c_str());
+    }
+    delete basis;
+}
+
+TEST(SampleCacheTest, Test_TemporalSamples)
+{
+    int myid, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    const std::string file_name = "test_SampleCache_space_time_samples";
+    const int num_cols = 3;
+    CAROM::Matrix* s_basis = createBasis(num_cols, myid);
+    CAROM::Matrix t_basis(5, num_cols, false);
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 0; j < num_cols; j++)
+        {
+            t_basis.item(i, j) = std::cos(0.9 * i * (j + 1));
+        }
+    }
+
+    std::vector<int> f_sampled_row(num_cols);
+    std::vector<int> f_sampled_rows_per_proc(num_procs, 0);
+    f_sampled_rows_per_proc[0] = num_cols;
+    for (int i = 0; i < num_cols; i++)
+    {
+        f_sampled_row[i] = 2 * i + 1;
+    }
+    std::vector<int> t_samples(2);
+    t_samples[0] = 1;
+    t_samples[1] = 4;
+    CAROM::Matrix s_basis_sampled(num_cols, num_cols, false);
+    s_basis_sampled = 0.5;
+
+    CAROM::SampleCache cache(file_name, "SpaceTimeSampling", s_basis, num_cols,
+                             std::vector<int>(), myid, num_procs, &t_basis);
+    cache.save(f_sampled_row, f_sampled_rows_per_proc, s_basis_sampled,
+               &t_samples);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    std::vector<int> cached_row;
+    std::vector<int> cached_rows_per_proc;
+    std::vector<int> cached_t_samples;
+    CAROM::Matrix cached_s_basis_sampled(1, 1, false);
+    EXPECT_TRUE(cache.load(cached_row, cached_rows_per_proc,
+                           cached_s_basis_sampled, &cached_t_samples));
+    EXPECT_EQ(cached_row, f_sampled_row);
+    EXPECT_EQ(cached_rows_per_proc, f_sampled_rows_per_proc);
+    EXPECT_EQ(cached_t_samples, t_samples);
+    EXPECT_EQ(cached_s_basis_sampled.item(num_cols - 1, num_cols - 1), 0.5);
+
+    // Without temporal samples the entry does not match.
+    EXPECT_FALSE(cache.load(cached_row, cached_rows_per_proc,
+                            cached_s_basis_sampled));
+
+    // Neither does it with another temporal basis.
+    t_basis.item(4, 0) = 2.0;
+    CAROM::SampleCache t_basis_cache(file_name, "SpaceTimeSampling", s_basis,
+                                     num_cols, std::vector<int>(), myid,
+                                     num_procs, &t_basis);
+    EXPECT_FALSE(t_basis_cache.load(cached_row, cached_rows_per_proc,
+                                    cached_s_basis_sampled, &cached_t_samples));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (myid == 0)
+    {
+        std::remove(file_name.c_str());
+    }
+    delete s_basis;
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    int result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
+#else // #ifndef CAROM_HAS_GTEST
+int main()
+{
+    std::cout << "libROM was compiled without Google Test support, so unit "
+              << "tests have been disabled. To enable unit tests, compile "
+              << "libROM with Google Test support." << std::endl;
+}
+#endif // #endif CAROM_HAS_GTEST